@@ -0,0 +1,468 @@
+/*
+    Copyright © 2025 Mint teams
+    footprint.c
+    Footprint and wakeup benchmark for Kavin
+
+    Runs kavin against generated trees with each backend and samples
+    /proc while it idles or while files are edited: RSS/PSS over time,
+    CPU time, and voluntary context switches (each one is a sleep ->
+    wakeup, so their rate is the idle wakeup rate). Totals come from
+    wait4() rusage once kavin has exited.
+
+    Build: make bench
+    Usage: dist/kavin-bench [options]
+*/
+
+#define _GNU_SOURCE
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <errno.h>
+#include <fcntl.h>
+#include <dirent.h>
+#include <signal.h>
+#include <time.h>
+#include <unistd.h>
+#include <sys/resource.h>
+#include <sys/stat.h>
+#include <sys/time.h>
+#include <sys/wait.h>
+
+#define MAX_RUNS 32
+#define FILES_PER_DIR 100
+
+typedef struct {
+    const char *kavin;
+    const char *backends;
+    const char *sizes;
+    const char *workload;  // "idle" or "edit"
+    double duration_s;
+    double warmup_s;
+    double edit_hz;
+    int sample_ms;
+    const char *csv;
+} BenchOptions;
+
+typedef struct {
+    char backend[16];
+    int files;
+    int ok;
+    int fell_back;         // kavin couldn't use the backend and polled instead
+    long rss_kb_avg;
+    long rss_kb_max;
+    long pss_kb_avg;
+    double cpu_percent;
+    double vcsw_per_s;
+    double ivcsw_per_s;
+    long maxrss_kb;        // From rusage
+    double rusage_cpu_s;
+    long rusage_vcsw;
+    long rusage_ivcsw;
+} BenchResult;
+
+typedef struct {
+    long rss_kb;
+    long pss_kb;
+    long cpu_ticks;
+    long vcsw;
+    long ivcsw;
+} Sample;
+
+static double now_s(void) {
+    struct timespec ts;
+    clock_gettime(CLOCK_MONOTONIC, &ts);
+    return (double)ts.tv_sec + (double)ts.tv_nsec / 1e9;
+}
+
+static void sleep_s(double seconds) {
+    struct timespec ts;
+    ts.tv_sec = (time_t)seconds;
+    ts.tv_nsec = (long)((seconds - (double)ts.tv_sec) * 1e9);
+    while (nanosleep(&ts, &ts) != 0 && errno == EINTR) {
+    }
+}
+
+static long read_kb_field(const char *path, const char *field) {
+    FILE *f = fopen(path, "r");
+    if (!f) {
+        return -1;
+    }
+    char line[256];
+    size_t len = strlen(field);
+    long value = -1;
+    while (fgets(line, sizeof(line), f)) {
+        if (strncmp(line, field, len) == 0 && line[len] == ':') {
+            value = strtol(line + len + 1, NULL, 10);
+            break;
+        }
+    }
+    fclose(f);
+    return value;
+}
+
+// Sums the context switch counters of every thread of `pid`.
+static void read_ctxt_switches(pid_t pid, long *vcsw, long *ivcsw) {
+    char path[128];
+    snprintf(path, sizeof(path), "/proc/%d/task", (int)pid);
+    *vcsw = 0;
+    *ivcsw = 0;
+
+    DIR *d = opendir(path);
+    if (!d) {
+        return;
+    }
+    struct dirent *entry;
+    while ((entry = readdir(d)) != NULL) {
+        if (entry->d_name[0] == '.') {
+            continue;
+        }
+        char status[400];
+        snprintf(status, sizeof(status), "%s/%s/status", path, entry->d_name);
+        long v = read_kb_field(status, "voluntary_ctxt_switches");
+        long iv = read_kb_field(status, "nonvoluntary_ctxt_switches");
+        *vcsw += v > 0 ? v : 0;
+        *ivcsw += iv > 0 ? iv : 0;
+    }
+    closedir(d);
+}
+
+static long read_cpu_ticks(pid_t pid) {
+    char path[64];
+    snprintf(path, sizeof(path), "/proc/%d/stat", (int)pid);
+    FILE *f = fopen(path, "r");
+    if (!f) {
+        return -1;
+    }
+    char buf[1024];
+    size_t n = fread(buf, 1, sizeof(buf) - 1, f);
+    fclose(f);
+    buf[n] = '\0';
+
+    // Fields after the ")" that closes comm; utime and stime are 14 and 15.
+    char *p = strrchr(buf, ')');
+    if (!p) {
+        return -1;
+    }
+    long utime = 0, stime = 0;
+    if (sscanf(p + 2, "%*c %*d %*d %*d %*d %*d %*u %*u %*u %*u %*u %ld %ld", &utime, &stime) != 2) {
+        return -1;
+    }
+    return utime + stime;
+}
+
+static int take_sample(pid_t pid, Sample *s) {
+    char path[64];
+    snprintf(path, sizeof(path), "/proc/%d/smaps_rollup", (int)pid);
+    s->rss_kb = read_kb_field(path, "Rss");
+    s->pss_kb = read_kb_field(path, "Pss");
+    if (s->rss_kb < 0) {
+        snprintf(path, sizeof(path), "/proc/%d/status", (int)pid);
+        s->rss_kb = read_kb_field(path, "VmRSS");
+        s->pss_kb = -1;
+    }
+    s->cpu_ticks = read_cpu_ticks(pid);
+    read_ctxt_switches(pid, &s->vcsw, &s->ivcsw);
+    return s->rss_kb >= 0 && s->cpu_ticks >= 0;
+}
+
+static int make_tree(const char *root, int files, char ***dirs_out, int *dir_count_out) {
+    int dir_count = (files + FILES_PER_DIR - 1) / FILES_PER_DIR;
+    if (dir_count == 0) {
+        dir_count = 1;
+    }
+    char **dirs = calloc((size_t)dir_count, sizeof(char *));
+    if (!dirs) {
+        return -1;
+    }
+
+    for (int d = 0; d < dir_count; ++d) {
+        if (asprintf(&dirs[d], "%s/d%04d", root, d) < 0 || mkdir(dirs[d], 0755) != 0) {
+            return -1;
+        }
+    }
+    for (int i = 0; i < files; ++i) {
+        char path[512];
+        snprintf(path, sizeof(path), "%s/f%06d.js", dirs[i / FILES_PER_DIR], i);
+        int fd = open(path, O_WRONLY | O_CREAT | O_TRUNC, 0644);
+        if (fd < 0) {
+            return -1;
+        }
+        if (write(fd, "module.exports = 1;\n", 20) != 20) {
+            close(fd);
+            return -1;
+        }
+        close(fd);
+    }
+
+    *dirs_out = dirs;
+    *dir_count_out = dir_count;
+    return 0;
+}
+
+static void remove_tree(const char *root, char **dirs, int dir_count, int files) {
+    char log[512];
+    snprintf(log, sizeof(log), "%s/kavin.log", root);
+    unlink(log);
+    for (int i = 0; i < files; ++i) {
+        char path[512];
+        snprintf(path, sizeof(path), "%s/f%06d.js", dirs[i / FILES_PER_DIR], i);
+        unlink(path);
+    }
+    for (int d = 0; d < dir_count; ++d) {
+        rmdir(dirs[d]);
+        free(dirs[d]);
+    }
+    free(dirs);
+    rmdir(root);
+}
+
+static pid_t spawn_kavin(const BenchOptions *opts, const char *backend, const char *log,
+                         char **dirs, int dir_count) {
+    char **argv = calloc((size_t)dir_count + 6, sizeof(char *));
+    if (!argv) {
+        return -1;
+    }
+    int argc = 0;
+    argv[argc++] = (char *)opts->kavin;
+    argv[argc++] = "--backend";
+    argv[argc++] = (char *)backend;
+    argv[argc++] = "sleep 1000000";
+    for (int d = 0; d < dir_count; ++d) {
+        argv[argc++] = dirs[d];
+    }
+    argv[argc] = NULL;
+
+    pid_t pid = fork();
+    if (pid == 0) {
+        int log_fd = open(log, O_WRONLY | O_CREAT | O_TRUNC, 0644);
+        if (log_fd >= 0) {
+            dup2(log_fd, STDOUT_FILENO);
+            dup2(log_fd, STDERR_FILENO);
+        }
+        execv(opts->kavin, argv);
+        _exit(127);
+    }
+    free(argv);
+    return pid;
+}
+
+static void run_one(const BenchOptions *opts, const char *backend, int files, FILE *csv, BenchResult *result) {
+    memset(result, 0, sizeof(*result));
+    snprintf(result->backend, sizeof(result->backend), "%s", backend);
+    result->files = files;
+
+    char root[] = "/tmp/kavin-bench-XXXXXX";
+    if (!mkdtemp(root)) {
+        perror("mkdtemp");
+        return;
+    }
+    char **dirs = NULL;
+    int dir_count = 0;
+    if (make_tree(root, files, &dirs, &dir_count) != 0) {
+        perror("Failed to create benchmark tree");
+        return;
+    }
+
+    char log[512];
+    snprintf(log, sizeof(log), "%s/kavin.log", root);
+    pid_t pid = spawn_kavin(opts, backend, log, dirs, dir_count);
+    if (pid <= 0) {
+        perror("fork");
+        remove_tree(root, dirs, dir_count, files);
+        return;
+    }
+
+    sleep_s(opts->warmup_s); // Initial scan and first child spawn
+
+    Sample first, last, s;
+    if (!take_sample(pid, &first)) {
+        fprintf(stderr, "[Bench] kavin exited early (%s, %d files)\n", backend, files);
+        kill(pid, SIGKILL);
+        waitpid(pid, NULL, 0);
+        remove_tree(root, dirs, dir_count, files);
+        return;
+    }
+    last = first;
+
+    double start = now_s();
+    double next_edit = start;
+    long rss_sum = 0, pss_sum = 0, samples = 0;
+    unsigned int seed = 12345;
+    int edit = strcmp(opts->workload, "edit") == 0 && opts->edit_hz > 0;
+
+    while (now_s() - start < opts->duration_s) {
+        if (edit && now_s() >= next_edit) {
+            char path[512];
+            int i = (int)(rand_r(&seed) % (unsigned int)(files > 0 ? files : 1));
+            snprintf(path, sizeof(path), "%s/f%06d.js", dirs[i / FILES_PER_DIR], i);
+            struct timespec times[2] = { { 0, UTIME_NOW }, { time(NULL) + (time_t)samples + 1, 0 } };
+            utimensat(AT_FDCWD, path, times, 0);
+            next_edit += 1.0 / opts->edit_hz;
+        }
+
+        sleep_s(opts->sample_ms / 1000.0);
+        if (!take_sample(pid, &s)) {
+            break;
+        }
+        last = s;
+        rss_sum += s.rss_kb;
+        pss_sum += s.pss_kb > 0 ? s.pss_kb : 0;
+        samples++;
+        if (s.rss_kb > result->rss_kb_max) {
+            result->rss_kb_max = s.rss_kb;
+        }
+        if (csv) {
+            fprintf(csv, "%s,%d,%.3f,%ld,%ld,%ld,%ld,%ld\n", backend, files, now_s() - start,
+                    s.rss_kb, s.pss_kb, s.cpu_ticks, s.vcsw, s.ivcsw);
+        }
+    }
+    double elapsed = now_s() - start;
+
+    kill(pid, SIGTERM);
+    int status;
+    struct rusage usage;
+    if (wait4(pid, &status, 0, &usage) == pid) {
+        result->maxrss_kb = usage.ru_maxrss;
+        result->rusage_cpu_s = (double)usage.ru_utime.tv_sec + usage.ru_utime.tv_usec / 1e6 +
+                               (double)usage.ru_stime.tv_sec + usage.ru_stime.tv_usec / 1e6;
+        result->rusage_vcsw = usage.ru_nvcsw;
+        result->rusage_ivcsw = usage.ru_nivcsw;
+    }
+
+    if (samples > 0 && elapsed > 0) {
+        long ticks_per_s = sysconf(_SC_CLK_TCK);
+        result->ok = 1;
+        result->rss_kb_avg = rss_sum / samples;
+        result->pss_kb_avg = pss_sum / samples;
+        result->cpu_percent = 100.0 * (double)(last.cpu_ticks - first.cpu_ticks) / (double)ticks_per_s / elapsed;
+        result->vcsw_per_s = (double)(last.vcsw - first.vcsw) / elapsed;
+        result->ivcsw_per_s = (double)(last.ivcsw - first.ivcsw) / elapsed;
+    }
+
+    // An explicit --backend that can't be used falls back to polling with a warning.
+    FILE *f = fopen(log, "r");
+    if (f) {
+        char line[512];
+        while (fgets(line, sizeof(line), f)) {
+            result->fell_back |= strstr(line, "falling back to polling") != NULL;
+        }
+        fclose(f);
+    }
+
+    remove_tree(root, dirs, dir_count, files);
+}
+
+static void print_report(const BenchOptions *opts, const BenchResult *results, int count) {
+    struct stat st;
+    if (stat(opts->kavin, &st) == 0) {
+        printf("\nBinary: %s (%.1f KB)\n", opts->kavin, st.st_size / 1024.0);
+    }
+    printf("Workload: %s, %.0fs per run", opts->workload, opts->duration_s);
+    if (strcmp(opts->workload, "edit") == 0) {
+        printf(", %.1f edits/s", opts->edit_hz);
+    }
+    printf("\n\n");
+
+    printf("%-9s %7s %8s %8s %8s %7s %9s %9s %10s %8s\n", "backend", "files", "rss_kb", "rss_max",
+           "pss_kb", "cpu_%", "wakeup/s", "ivcsw/s", "maxrss_kb", "cpu_s");
+    for (int i = 0; i < count; ++i) {
+        const BenchResult *r = &results[i];
+        if (!r->ok) {
+            printf("%-9s %7d %s\n", r->backend, r->files, "(failed: backend unavailable or kavin exited)");
+            continue;
+        }
+        printf("%-9s %7d %8ld %8ld %8ld %7.3f %9.1f %9.1f %10ld %8.3f\n", r->backend, r->files,
+               r->rss_kb_avg, r->rss_kb_max, r->pss_kb_avg, r->cpu_percent, r->vcsw_per_s,
+               r->ivcsw_per_s, r->maxrss_kb, r->rusage_cpu_s);
+        if (r->fell_back) {
+            printf("%-9s %7s ^ %s unavailable here, these are polling numbers\n", "", "", r->backend);
+        }
+    }
+    printf("\nwakeup/s = voluntary context switches per second across kavin's threads.\n");
+    printf("maxrss_kb and cpu_s come from wait4() rusage and include shutdown.\n");
+}
+
+static void usage(const char *prog) {
+    fprintf(stderr,
+            "Usage: %s [options]\n"
+            "  --kavin <path>        kavin binary (default dist/kavin)\n"
+            "  --backends <list>     Comma separated (default poll,inotify,fanotify)\n"
+            "  --sizes <list>        Watch-set sizes in files (default 10,1000,10000)\n"
+            "  --workload <name>     idle or edit (default idle)\n"
+            "  --edit-hz <n>         Edits per second for the edit workload (default 1)\n"
+            "  --duration <s>        Measured seconds per run (default 10)\n"
+            "  --warmup <s>          Seconds before measuring (default 2)\n"
+            "  --sample-ms <ms>      /proc sampling period (default 250)\n"
+            "  --csv <file>          Write every sample as CSV\n",
+            prog);
+}
+
+int main(int argc, char *argv[]) {
+    BenchOptions opts = { "dist/kavin", "poll,inotify,fanotify", "10,1000,10000", "idle",
+                          10.0, 2.0, 1.0, 250, NULL };
+
+    for (int i = 1; i < argc; ++i) {
+        const char *arg = argv[i];
+        const char *value = i + 1 < argc ? argv[i + 1] : NULL;
+        if (!value) {
+            usage(argv[0]);
+            return 1;
+        }
+        if (strcmp(arg, "--kavin") == 0) opts.kavin = value;
+        else if (strcmp(arg, "--backends") == 0) opts.backends = value;
+        else if (strcmp(arg, "--sizes") == 0) opts.sizes = value;
+        else if (strcmp(arg, "--workload") == 0) opts.workload = value;
+        else if (strcmp(arg, "--edit-hz") == 0) opts.edit_hz = atof(value);
+        else if (strcmp(arg, "--duration") == 0) opts.duration_s = atof(value);
+        else if (strcmp(arg, "--warmup") == 0) opts.warmup_s = atof(value);
+        else if (strcmp(arg, "--sample-ms") == 0) opts.sample_ms = atoi(value);
+        else if (strcmp(arg, "--csv") == 0) opts.csv = value;
+        else {
+            usage(argv[0]);
+            return 1;
+        }
+        ++i;
+    }
+    if (opts.sample_ms <= 0 || opts.duration_s <= 0) {
+        usage(argv[0]);
+        return 1;
+    }
+    if (access(opts.kavin, X_OK) != 0) {
+        fprintf(stderr, "[Bench] kavin binary not found: %s (run make first)\n", opts.kavin);
+        return 1;
+    }
+
+    FILE *csv = NULL;
+    if (opts.csv) {
+        csv = fopen(opts.csv, "w");
+        if (!csv) {
+            perror(opts.csv);
+            return 1;
+        }
+        fprintf(csv, "backend,files,t_s,rss_kb,pss_kb,cpu_ticks,vcsw,ivcsw\n");
+    }
+
+    BenchResult results[MAX_RUNS];
+    int count = 0;
+
+    char *backends = strdup(opts.backends);
+    for (char *b_save = NULL, *backend = strtok_r(backends, ",", &b_save); backend;
+         backend = strtok_r(NULL, ",", &b_save)) {
+        char *sizes = strdup(opts.sizes);
+        for (char *s_save = NULL, *size = strtok_r(sizes, ",", &s_save); size && count < MAX_RUNS;
+             size = strtok_r(NULL, ",", &s_save)) {
+            int files = atoi(size);
+            fprintf(stderr, "[Bench] %s, %d files...\n", backend, files);
+            run_one(&opts, backend, files, csv, &results[count++]);
+        }
+        free(sizes);
+    }
+    free(backends);
+
+    if (csv) {
+        fclose(csv);
+    }
+    print_report(&opts, results, count);
+    return 0;
+}
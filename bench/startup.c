@@ -0,0 +1,256 @@
+/*
+    Copyright © 2025 Mint teams
+    startup.c
+    Startup and RSS comparison of the normal and freestanding builds
+
+    Each run starts a binary that watches one file and runs a command
+    which writes a byte to an inherited pipe. The time from fork() to
+    that byte is "time to child", which includes /bin/sh. Starting the
+    same command directly gives the sh baseline, and the difference is
+    what the supervisor itself costs. Once the child is up, RSS and peak
+    RSS are read from /proc/<pid>/status.
+
+    Build: make bench-min
+    Usage: dist/kavin-startup [options]
+*/
+
+#define _GNU_SOURCE
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <errno.h>
+#include <fcntl.h>
+#include <signal.h>
+#include <time.h>
+#include <unistd.h>
+#include <sys/wait.h>
+
+#define READY_FD 9
+
+typedef struct {
+    const char *label;
+    const char *path;        // NULL = run the command with no supervisor
+    double median_us;
+    double min_us;
+    long rss_kb;
+    long hwm_kb;
+    int ok;
+} StartupResult;
+
+static double now_us(void) {
+    struct timespec ts;
+    clock_gettime(CLOCK_MONOTONIC, &ts);
+    return (double)ts.tv_sec * 1e6 + (double)ts.tv_nsec / 1e3;
+}
+
+static long read_kb_field(pid_t pid, const char *field) {
+    char path[64];
+    snprintf(path, sizeof(path), "/proc/%d/status", (int)pid);
+    FILE *f = fopen(path, "r");
+    if (!f) {
+        return -1;
+    }
+    char line[256];
+    size_t len = strlen(field);
+    long value = -1;
+    while (fgets(line, sizeof(line), f)) {
+        if (strncmp(line, field, len) == 0 && line[len] == ':') {
+            value = strtol(line + len + 1, NULL, 10);
+            break;
+        }
+    }
+    fclose(f);
+    return value;
+}
+
+static int compare_doubles(const void *a, const void *b) {
+    double x = *(const double *)a;
+    double y = *(const double *)b;
+    return (x > y) - (x < y);
+}
+
+/*
+    Starts one run and waits for the ready byte. Returns the elapsed
+    microseconds, or a negative value on failure. The supervisor is
+    left running in *pid_out so the caller can sample it.
+*/
+static double start_one(const StartupResult *target, const char *watch_file, pid_t *pid_out) {
+    static const char command[] = "printf . >&9; exec sleep 1000";
+
+    int fds[2];
+    if (pipe2(fds, O_CLOEXEC) != 0) {
+        return -1;
+    }
+
+    double start = now_us();
+    pid_t pid = fork();
+    if (pid == 0) {
+        dup2(fds[1], READY_FD); // dup2 clears FD_CLOEXEC
+        int null_fd = open("/dev/null", O_WRONLY);
+        dup2(null_fd, STDOUT_FILENO);
+        dup2(null_fd, STDERR_FILENO);
+        setpgid(0, 0);
+        if (target->path) {
+            execl(target->path, target->path, command, watch_file, (char *)NULL);
+        } else {
+            execl("/bin/sh", "sh", "-c", command, (char *)NULL);
+        }
+        _exit(127);
+    }
+    close(fds[1]);
+    if (pid < 0) {
+        close(fds[0]);
+        return -1;
+    }
+
+    char byte;
+    ssize_t got;
+    while ((got = read(fds[0], &byte, 1)) < 0 && errno == EINTR) {
+    }
+    double elapsed = now_us() - start;
+    close(fds[0]);
+
+    *pid_out = pid;
+    return got == 1 ? elapsed : -1;
+}
+
+static void stop_one(pid_t pid) {
+    kill(pid, SIGTERM);
+    for (int i = 0; i < 300; ++i) {
+        if (waitpid(pid, NULL, WNOHANG) == pid) {
+            kill(-pid, SIGKILL); // The supervised sleep, if it outlived kavin
+            return;
+        }
+        usleep(10000);
+    }
+    kill(-pid, SIGKILL);
+    kill(pid, SIGKILL);
+    waitpid(pid, NULL, 0);
+}
+
+static void run_target(StartupResult *target, const char *watch_file, int runs, int settle_ms) {
+    double *samples = calloc((size_t)runs, sizeof(double));
+    int ok = 0;
+    target->rss_kb = -1;
+    target->hwm_kb = -1;
+
+    for (int i = 0; i < runs; ++i) {
+        pid_t pid = -1;
+        double elapsed = start_one(target, watch_file, &pid);
+        if (elapsed >= 0) {
+            samples[ok++] = elapsed;
+        }
+        if (pid > 0 && i == runs - 1 && target->path) {
+            usleep((useconds_t)settle_ms * 1000);
+            target->rss_kb = read_kb_field(pid, "VmRSS");
+            target->hwm_kb = read_kb_field(pid, "VmHWM");
+        }
+        if (pid > 0) {
+            stop_one(pid);
+        }
+    }
+
+    target->ok = ok > 0;
+    if (ok > 0) {
+        qsort(samples, (size_t)ok, sizeof(double), compare_doubles);
+        target->median_us = samples[ok / 2];
+        target->min_us = samples[0];
+    }
+    free(samples);
+}
+
+static void print_report(const StartupResult *results, int count, int runs) {
+    double baseline = results[0].ok ? results[0].median_us : 0;
+
+    printf("\nStartup: median of %d runs, fork() to first byte from the supervised command\n\n", runs);
+    printf("%-14s %12s %12s %14s %10s %10s\n", "binary", "median us", "min us", "over sh us", "rss kB", "peak kB");
+    for (int i = 0; i < count; ++i) {
+        const StartupResult *r = &results[i];
+        if (!r->ok) {
+            printf("%-14s %12s   (%s failed to start)\n", r->label, "-", r->path ? r->path : "sh");
+            continue;
+        }
+        char rss[24] = "-";
+        char hwm[24] = "-";
+        if (r->rss_kb >= 0) {
+            snprintf(rss, sizeof(rss), "%ld", r->rss_kb);
+            snprintf(hwm, sizeof(hwm), "%ld", r->hwm_kb);
+        }
+        printf("%-14s %12.0f %12.0f %14.0f %10s %10s\n", r->label, r->median_us, r->min_us,
+               r->median_us - baseline, rss, hwm);
+    }
+}
+
+static void usage(const char *prog) {
+    fprintf(stderr,
+            "Usage: %s [options]\n"
+            "  --kavin <path>        Normal build (default dist/kavin)\n"
+            "  --min <path>          Freestanding build (default dist/kavin-min)\n"
+            "  --runs <n>            Starts per binary (default 50)\n"
+            "  --settle-ms <ms>      Wait before sampling RSS (default 200)\n",
+            prog);
+}
+
+int main(int argc, char *argv[]) {
+    const char *kavin = "dist/kavin";
+    const char *kavin_min = "dist/kavin-min";
+    int runs = 50;
+    int settle_ms = 200;
+
+    for (int i = 1; i < argc; ++i) {
+        const char *arg = argv[i];
+        const char *value = i + 1 < argc ? argv[i + 1] : NULL;
+        if (!value) {
+            usage(argv[0]);
+            return 1;
+        }
+        if (strcmp(arg, "--kavin") == 0) kavin = value;
+        else if (strcmp(arg, "--min") == 0) kavin_min = value;
+        else if (strcmp(arg, "--runs") == 0) runs = atoi(value);
+        else if (strcmp(arg, "--settle-ms") == 0) settle_ms = atoi(value);
+        else {
+            usage(argv[0]);
+            return 1;
+        }
+        ++i;
+    }
+    if (runs <= 0 || settle_ms < 0) {
+        usage(argv[0]);
+        return 1;
+    }
+
+    char dir[] = "/tmp/kavin-startup-XXXXXX";
+    if (!mkdtemp(dir)) {
+        perror("mkdtemp");
+        return 1;
+    }
+    char watch_file[sizeof(dir) + 16];
+    snprintf(watch_file, sizeof(watch_file), "%s/app.js", dir);
+    FILE *f = fopen(watch_file, "w");
+    if (f) {
+        fputs("// watched\n", f);
+        fclose(f);
+    }
+
+    StartupResult results[] = {
+        { "sh (baseline)", NULL, 0, 0, -1, -1, 0 },
+        { "kavin", kavin, 0, 0, -1, -1, 0 },
+        { "kavin-min", kavin_min, 0, 0, -1, -1, 0 },
+    };
+    int count = (int)(sizeof(results) / sizeof(results[0]));
+
+    for (int i = 0; i < count; ++i) {
+        if (results[i].path && access(results[i].path, X_OK) != 0) {
+            fprintf(stderr, "[Bench] binary not found: %s\n", results[i].path);
+            continue;
+        }
+        fprintf(stderr, "[Bench] %s...\n", results[i].label);
+        run_target(&results[i], watch_file, runs, settle_ms);
+    }
+
+    unlink(watch_file);
+    rmdir(dir);
+    print_report(results, count, runs);
+    return 0;
+}
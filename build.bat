@@ -16,6 +16,9 @@ REM # Directories
 set "SRC_DIR=src"
 set "OBJ_DIR=obj"
 set "DIST_DIR=dist"
+REM # Freestanding build (Linux x86-64 only), kept out of kavin.exe like MIN_DIR in the Makefile
+set "MIN_DIR=freestanding\"
+REM # (the loops below compare the first 13 characters, the length of MIN_DIR)
 
 REM # Flags
 set "AFLAGS=-f win64"
@@ -43,27 +46,31 @@ set "OBJ_FILES="
 REM # Compile C source files
 echo Compiling C files...
 for /r "%SRC_DIR%" %%F in (*.c) do (
-    echo   CC  %%F
     set "FULL_PATH=%%F"
     set "REL_PATH=!FULL_PATH:%CURRENT_DIR%\%SRC_DIR%\=!"
-    set "OBJ_SUBDIR=%OBJ_DIR%\!REL_PATH!\.."
-    set "OBJ_PATH=%OBJ_DIR%\!REL_PATH:.c=.o!"
-    if not exist "!OBJ_SUBDIR!" mkdir "!OBJ_SUBDIR!"
-    %CC% %CFLAGS% -c -o "!OBJ_PATH!" "%%F"
-    set "OBJ_FILES=!OBJ_FILES! "!OBJ_PATH!""
+    if /i not "!REL_PATH:~0,13!"=="%MIN_DIR%" (
+        echo   CC  %%F
+        set "OBJ_SUBDIR=%OBJ_DIR%\!REL_PATH!\.."
+        set "OBJ_PATH=%OBJ_DIR%\!REL_PATH:.c=.o!"
+        if not exist "!OBJ_SUBDIR!" mkdir "!OBJ_SUBDIR!"
+        %CC% %CFLAGS% -c -o "!OBJ_PATH!" "%%F"
+        set "OBJ_FILES=!OBJ_FILES! "!OBJ_PATH!""
+    )
 )
 
 REM # Assemble ASM source files
 echo Assembling ASM files...
 for /r "%SRC_DIR%" %%F in (*.asm) do (
-    echo   ASM %%F
     set "FULL_PATH=%%F"
     set "REL_PATH=!FULL_PATH:%CURRENT_DIR%\%SRC_DIR%\=!"
-    set "OBJ_SUBDIR=%OBJ_DIR%\!REL_PATH!\.."
-    set "OBJ_PATH=%OBJ_DIR%\!REL_PATH:.asm=.o!"
-    if not exist "!OBJ_SUBDIR!" mkdir "!OBJ_SUBDIR!"
-    %ASM% %AFLAGS% %ASM_DEFINES% -o "!OBJ_PATH!" "%%F"
-    set "OBJ_FILES=!OBJ_FILES! "!OBJ_PATH!""
+    if /i not "!REL_PATH:~0,13!"=="%MIN_DIR%" (
+        echo   ASM %%F
+        set "OBJ_SUBDIR=%OBJ_DIR%\!REL_PATH!\.."
+        set "OBJ_PATH=%OBJ_DIR%\!REL_PATH:.asm=.o!"
+        if not exist "!OBJ_SUBDIR!" mkdir "!OBJ_SUBDIR!"
+        %ASM% %AFLAGS% %ASM_DEFINES% -o "!OBJ_PATH!" "%%F"
+        set "OBJ_FILES=!OBJ_FILES! "!OBJ_PATH!""
+    )
 )
 
 REM # Link object files
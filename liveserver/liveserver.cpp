@@ -21,6 +21,14 @@
 #include <csignal>
 #include <cstring>
 #include <cstdlib>
+#include <cctype>
+#include <coroutine>
+#include <utility>
+#include <map>
+#include <deque>
+#include <functional>
+#include <optional>
+#include <array>
 
 #ifdef _WIN32
     #include <winsock2.h>
@@ -37,7 +45,11 @@
     #include <sys/stat.h>
     #include <fcntl.h>
     #include <sys/inotify.h>
+    #include <sys/epoll.h>
+    #include <sys/eventfd.h>
+    #include <sys/sendfile.h>
     #include <poll.h>
+    #include <cerrno>
 #endif
 
 namespace fs = std::filesystem;
@@ -48,10 +60,13 @@ namespace Config {
     constexpr size_t MAX_FILE_SIZE = 512 * 1024; 
     constexpr size_t MAX_CACHE_SIZE = 4 * 1024 * 1024; 
     constexpr size_t MAX_CACHE_ENTRIES = 50;
-    constexpr uint32_t MAX_CONNECTIONS = 10;
+    constexpr uint32_t MAX_CONNECTIONS = 4096;
     constexpr uint32_t MAX_REQUESTS_PER_SECOND = 20;
     constexpr std::chrono::milliseconds POLL_INTERVAL{500};
     constexpr std::chrono::seconds HEALTH_CHECK_INTERVAL{30};
+    constexpr std::chrono::milliseconds IO_TIMEOUT{5000};
+    constexpr std::chrono::milliseconds KEEP_ALIVE_TIMEOUT{5000};
+    constexpr uint32_t MAX_REQUESTS_PER_CONNECTION = 1000;
 }
 
 class PathValidator {
@@ -100,7 +115,8 @@ public:
 };
 
 std::unordered_set<std::string> PathValidator::allowedExtensions = {
-    ".html", ".css", ".js", ".json", ".txt", ".ico", ".png", ".jpg", ".jpeg", ".svg", ".webp"
+    ".html", ".css", ".js", ".json", ".txt", ".ico", ".png", ".jpg", ".jpeg", ".svg", ".webp",
+    ".mp4", ".webm", ".wasm", ".map"
 };
 
 class SignalHandler {
@@ -197,15 +213,15 @@ public:
 class FileCache {
 private:
     struct CacheEntry {
-        std::string content;
+        std::shared_ptr<const std::string> content;
         fs::file_time_type lastModified;
         std::chrono::steady_clock::time_point lastAccessed;
         size_t size;
         
-        CacheEntry(std::string c, fs::file_time_type mod) 
+        CacheEntry(std::shared_ptr<const std::string> c, fs::file_time_type mod) 
             : content(std::move(c)), lastModified(mod), 
               lastAccessed(std::chrono::steady_clock::now()),
-              size(content.size()) {}
+              size(content->size()) {}
     };
     
     std::unordered_map<std::string, std::unique_ptr<CacheEntry>> cache;
@@ -227,58 +243,73 @@ private:
     }
     
 public:
-    std::string getFile(const std::string& filename) {
+    // Contents are immutable and shared: a hit hands out another reference, and
+    // an entry evicted or cleared stays alive until the last response using it
+    // is sent. Null when the file can't be served.
+    std::shared_ptr<const std::string> getFile(const std::string& filename) {
         if (!PathValidator::isValidPath(filename)) {
-            return "";
+            return nullptr;
         }
         
-        std::lock_guard<std::mutex> lock(mutex);
-        
         try {
+            // Stat and read without the lock: a cold read doesn't hold up hits on other threads
             if (!fs::exists(filename) || !fs::is_regular_file(filename)) {
-                return "";
+                return nullptr;
             }
             
             auto fileSize = fs::file_size(filename);
             if (fileSize > Config::MAX_FILE_SIZE) {
-                return "";
+                return nullptr;
             }
             
             auto lastWrite = fs::last_write_time(filename);
-            auto it = cache.find(filename);
-            
-            // Check if cached version is valid
-            if (it != cache.end() && it->second->lastModified == lastWrite) {
-                it->second->lastAccessed = std::chrono::steady_clock::now();
-                return it->second->content;
+            {
+                std::lock_guard<std::mutex> lock(mutex);
+                auto it = cache.find(filename);
+                
+                // Check if cached version is valid
+                if (it != cache.end() && it->second->lastModified == lastWrite) {
+                    it->second->lastAccessed = std::chrono::steady_clock::now();
+                    return it->second->content;
+                }
             }
             
             // Read file
             std::ifstream file(filename, std::ios::binary);
-            if (!file) return "";
+            if (!file) return nullptr;
             
             std::string content;
             content.resize(fileSize);
             
             if (!file.read(content.data(), fileSize)) {
-                return "";
+                return nullptr;
+            }
+            auto shared = std::make_shared<const std::string>(std::move(content));
+            
+            std::lock_guard<std::mutex> lock(mutex);
+            
+            // Another thread may have read it meanwhile
+            auto it = cache.find(filename);
+            if (it != cache.end()) {
+                totalSize -= it->second->size;
+                cache.erase(it);
             }
             
             // Ensure cache limits
-            while (totalSize + content.size() > Config::MAX_CACHE_SIZE || 
+            while (totalSize + shared->size() > Config::MAX_CACHE_SIZE || 
                    cache.size() >= Config::MAX_CACHE_ENTRIES) {
                 evictLRU();
             }
             
             // Add to cache
-            auto entry = std::make_unique<CacheEntry>(content, lastWrite);
+            auto entry = std::make_unique<CacheEntry>(shared, lastWrite);
             totalSize += entry->size;
             cache[filename] = std::move(entry);
             
-            return content;
+            return shared;
             
         } catch (const std::exception&) {
-            return "";
+            return nullptr;
         }
     }
     
@@ -373,6 +404,34 @@ public:
         return client;
     }
     
+#ifndef _WIN32
+    int native() const { return sock; }
+    
+    bool setNonBlocking() {
+        int flags = fcntl(sock, F_GETFL, 0);
+        return flags != -1 && fcntl(sock, F_SETFL, flags | O_NONBLOCK) == 0;
+    }
+    
+    // Invalid once the backlog is empty (EAGAIN)
+    Socket acceptNonBlocking() {
+        Socket client;
+        if (sock != INVALID_SOCK) {
+            client.sock = ::accept4(sock, nullptr, nullptr, SOCK_NONBLOCK | SOCK_CLOEXEC);
+        }
+        return client;
+    }
+    
+    // One non-blocking send; -1 with errno EAGAIN when the socket buffer is full
+    // `more`: the rest of the response follows, so the kernel may hold a short write back
+    ssize_t sendSome(std::string_view data, bool more = false) {
+        return ::send(sock, data.data(), data.size(), MSG_NOSIGNAL | (more ? MSG_MORE : 0));
+    }
+    
+    ssize_t sendFile(int fd, off_t* offset, size_t count) {
+        return ::sendfile(sock, fd, offset, count);
+    }
+#endif
+    
     int recv(char* buffer, int size) {
         if (sock == INVALID_SOCK) return -1;
         return ::recv(sock, buffer, size, 0);
@@ -406,6 +465,427 @@ public:
     bool isValid() const { return sock != INVALID_SOCK; }
 };
 
+#ifndef _WIN32
+class FileHandle {
+public:
+    FileHandle() = default;
+    explicit FileHandle(int f) : fd(f) {}
+    FileHandle(FileHandle&& other) noexcept : fd(std::exchange(other.fd, -1)) {}
+    FileHandle& operator=(FileHandle&& other) noexcept {
+        if (this != &other) {
+            close();
+            fd = std::exchange(other.fd, -1);
+        }
+        return *this;
+    }
+    ~FileHandle() { close(); }
+    
+    FileHandle(const FileHandle&) = delete;
+    FileHandle& operator=(const FileHandle&) = delete;
+    
+    int native() const { return fd; }
+    bool isValid() const { return fd != -1; }
+    
+    void close() {
+        if (fd != -1) {
+            ::close(fd);
+            fd = -1;
+        }
+    }
+    
+private:
+    int fd = -1;
+};
+
+#endif
+
+// A whole response in `data`, or its headers there followed by `body`:
+// slices of a shared cache entry (and the live reload tag between them)
+// sent as they are. On POSIX `length` bytes of `file` may follow instead,
+// sent with sendfile().
+struct Response {
+    std::string data;
+    std::shared_ptr<const std::string> shared; // Keeps `body` alive
+    std::array<std::string_view, 3> body{};
+#ifndef _WIN32
+    FileHandle file;
+    off_t length = 0;
+#endif
+};
+
+#ifndef _WIN32
+// Fire-and-forget coroutine: runs up to its first suspension right away and
+// frees itself when it returns. Frames still suspended when the reactor stops
+// are destroyed by it, which closes the sockets they own.
+class Task {
+public:
+    struct promise_type {
+        promise_type() { live.insert(frame()); }
+        ~promise_type() { live.erase(frame()); }
+        
+        void* frame() { return std::coroutine_handle<promise_type>::from_promise(*this).address(); }
+        
+        Task get_return_object() noexcept { return {}; }
+        std::suspend_never initial_suspend() noexcept { return {}; }
+        std::suspend_never final_suspend() noexcept { return {}; }
+        void return_void() noexcept {}
+        void unhandled_exception() noexcept { std::terminate(); }
+    };
+    
+    // Reactor thread only, like every task
+    static void destroyAll() {
+        std::vector<void*> frames(live.begin(), live.end());
+        for (void* frame : frames) {
+            std::coroutine_handle<promise_type>::from_address(frame).destroy();
+        }
+    }
+    
+private:
+    static inline thread_local std::unordered_set<void*> live;
+};
+
+// Lazy awaitable coroutine returning T: starts when awaited and resumes its
+// caller when done. Destroying it destroys the frame, suspended or not.
+template <typename T>
+class Async {
+public:
+    struct promise_type {
+        T value{};
+        std::coroutine_handle<> caller;
+        
+        Async get_return_object() noexcept {
+            return Async{std::coroutine_handle<promise_type>::from_promise(*this)};
+        }
+        std::suspend_always initial_suspend() noexcept { return {}; }
+        auto final_suspend() noexcept {
+            struct ResumeCaller {
+                bool await_ready() noexcept { return false; }
+                std::coroutine_handle<> await_suspend(std::coroutine_handle<promise_type> self) noexcept {
+                    return self.promise().caller;
+                }
+                void await_resume() noexcept {}
+            };
+            return ResumeCaller{};
+        }
+        void return_value(T v) noexcept { value = std::move(v); }
+        void unhandled_exception() noexcept { std::terminate(); }
+    };
+    
+    explicit Async(std::coroutine_handle<promise_type> h) : handle(h) {}
+    Async(Async&& other) noexcept : handle(std::exchange(other.handle, {})) {}
+    Async(const Async&) = delete;
+    Async& operator=(const Async&) = delete;
+    ~Async() { if (handle) handle.destroy(); }
+    
+    bool await_ready() const noexcept { return false; }
+    std::coroutine_handle<> await_suspend(std::coroutine_handle<> caller) noexcept {
+        handle.promise().caller = caller;
+        return handle;
+    }
+    T await_resume() { return std::move(handle.promise().value); }
+    
+private:
+    std::coroutine_handle<promise_type> handle;
+};
+
+// Single-threaded epoll loop. Coroutines co_await readable()/writable() on a
+// non-blocking fd and are resumed on this loop once it is ready, or with
+// false once the timeout passes. One waiter per fd at a time.
+class Reactor {
+public:
+    using Clock = std::chrono::steady_clock;
+    
+    class IoWait {
+    public:
+        IoWait(Reactor& r, int f, uint32_t e, std::chrono::milliseconds t)
+            : reactor(r), fd(f), events(e), timeout(t) {}
+        
+        bool await_ready() const noexcept { return false; }
+        bool await_suspend(std::coroutine_handle<> handle) {
+            return reactor.arm(fd, events, timeout, handle, &ready);
+        }
+        bool await_resume() const noexcept { return ready; }
+        
+    private:
+        Reactor& reactor;
+        int fd;
+        uint32_t events;
+        std::chrono::milliseconds timeout;
+        bool ready = false;
+    };
+    
+    Reactor()
+        : epollFd(epoll_create1(EPOLL_CLOEXEC))
+        , wakeFd(eventfd(0, EFD_NONBLOCK | EFD_CLOEXEC)) {
+        if (valid()) {
+            epoll_event ev{};
+            ev.events = EPOLLIN;
+            ev.data.fd = wakeFd;
+            epoll_ctl(epollFd, EPOLL_CTL_ADD, wakeFd, &ev);
+        }
+    }
+    
+    ~Reactor() {
+        if (wakeFd != -1) ::close(wakeFd);
+        if (epollFd != -1) ::close(epollFd);
+    }
+    
+    Reactor(const Reactor&) = delete;
+    Reactor& operator=(const Reactor&) = delete;
+    
+    bool valid() const { return epollFd != -1 && wakeFd != -1; }
+    
+    // A zero timeout waits forever
+    IoWait readable(int fd, std::chrono::milliseconds timeout = {}) {
+        return IoWait(*this, fd, EPOLLIN | EPOLLRDHUP, timeout);
+    }
+    
+    IoWait writable(int fd, std::chrono::milliseconds timeout = {}) {
+        return IoWait(*this, fd, EPOLLOUT, timeout);
+    }
+    
+    // Runs until stop(), then destroys the tasks still suspended
+    void run() {
+        epoll_event events[64];
+        std::vector<std::coroutine_handle<>> resumable;
+        
+        while (!stopping.load()) {
+            int timeout = -1;
+            if (!deadlines.empty()) {
+                auto wait = std::chrono::ceil<std::chrono::milliseconds>(deadlines.begin()->first - Clock::now());
+                timeout = static_cast<int>(std::max<std::chrono::milliseconds::rep>(wait.count(), 0));
+            }
+            
+            int count = epoll_wait(epollFd, events, 64, timeout);
+            if (count < 0 && errno != EINTR) break;
+            
+            for (int i = 0; i < count; ++i) {
+                int fd = events[i].data.fd;
+                if (fd == wakeFd) {
+                    uint64_t value;
+                    [[maybe_unused]] auto drained = ::read(wakeFd, &value, sizeof(value));
+                    std::lock_guard<std::mutex> lock(postedMutex);
+                    resumable.insert(resumable.end(), posted.begin(), posted.end());
+                    posted.clear();
+                    continue;
+                }
+                wake(fd, true, resumable);
+            }
+            
+            auto now = Clock::now();
+            while (!deadlines.empty() && deadlines.begin()->first <= now) {
+                if (!wake(deadlines.begin()->second, false, resumable)) {
+                    deadlines.erase(deadlines.begin());
+                }
+            }
+            
+            // Collected first: a resumed task may arm (or close) any fd
+            for (auto handle : resumable) {
+                handle.resume();
+            }
+            resumable.clear();
+        }
+        
+        waiters.clear();
+        deadlines.clear();
+        Task::destroyAll();
+    }
+    
+    // Any thread
+    void stop() {
+        stopping = true;
+        signal();
+    }
+    
+    // Any thread: resumes the coroutine on the loop. Dropped once the loop has stopped.
+    void post(std::coroutine_handle<> handle) {
+        {
+            std::lock_guard<std::mutex> lock(postedMutex);
+            posted.push_back(handle);
+        }
+        signal();
+    }
+    
+private:
+    using Deadlines = std::multimap<Clock::time_point, int>;
+    
+    struct Waiter {
+        std::coroutine_handle<> handle;
+        bool* ready;
+        Deadlines::iterator deadline;
+        bool timed;
+    };
+    
+    // Returns false (ready stays false) when the fd can't be watched: the task resumes at once
+    bool arm(int fd, uint32_t events, std::chrono::milliseconds timeout,
+             std::coroutine_handle<> handle, bool* ready) {
+        epoll_event ev{};
+        ev.events = events | EPOLLONESHOT;
+        ev.data.fd = fd;
+        // A closed fd leaves the set by itself, so a reused number needs ADD again
+        if (epoll_ctl(epollFd, EPOLL_CTL_MOD, fd, &ev) != 0 &&
+            (errno != ENOENT || epoll_ctl(epollFd, EPOLL_CTL_ADD, fd, &ev) != 0)) {
+            return false;
+        }
+        
+        Waiter waiter{handle, ready, deadlines.end(), timeout.count() > 0};
+        if (waiter.timed) {
+            waiter.deadline = deadlines.emplace(Clock::now() + timeout, fd);
+        }
+        waiters[fd] = waiter;
+        return true;
+    }
+    
+    void signal() {
+        uint64_t one = 1;
+        [[maybe_unused]] auto written = ::write(wakeFd, &one, sizeof(one));
+    }
+    
+    bool wake(int fd, bool ready, std::vector<std::coroutine_handle<>>& resumable) {
+        auto it = waiters.find(fd);
+        if (it == waiters.end()) return false;
+        
+        *it->second.ready = ready;
+        if (it->second.timed) {
+            deadlines.erase(it->second.deadline);
+        }
+        resumable.push_back(it->second.handle);
+        waiters.erase(it);
+        return true;
+    }
+    
+    int epollFd;
+    int wakeFd;
+    std::atomic<bool> stopping{false};
+    std::unordered_map<int, Waiter> waiters;
+    Deadlines deadlines;
+    std::mutex postedMutex;
+    std::vector<std::coroutine_handle<>> posted;
+};
+
+// Work-stealing pool for blocking and CPU-heavy jobs, one worker per core.
+// A worker takes the newest job from its own deque and, when that is empty,
+// steals the oldest from the others; jobs submitted from outside the pool
+// are dealt round-robin. Jobs still queued at shutdown are dropped.
+class WorkPool {
+public:
+    explicit WorkPool(unsigned threads = std::max(1u, std::thread::hardware_concurrency()))
+        : queues(std::make_unique<WorkQueue[]>(threads)), queueCount(threads) {
+        for (unsigned i = 0; i < threads; ++i) {
+            workers.emplace_back([this, i] { work(i); });
+        }
+    }
+    
+    ~WorkPool() { shutdown(); }
+    
+    WorkPool(const WorkPool&) = delete;
+    WorkPool& operator=(const WorkPool&) = delete;
+    
+    void submit(std::function<void()> job) {
+        size_t index = owner == this ? workerIndex : next++ % queueCount;
+        pending++; // Before the push, so the count never goes below the jobs queued
+        {
+            std::lock_guard<std::mutex> lock(queues[index].mutex);
+            queues[index].jobs.push_back(std::move(job));
+        }
+        { std::lock_guard<std::mutex> lock(idleMutex); }
+        idle.notify_one();
+    }
+    
+    void shutdown() {
+        {
+            std::lock_guard<std::mutex> lock(idleMutex);
+            stopping = true;
+        }
+        idle.notify_all();
+        for (auto& worker : workers) {
+            if (worker.joinable()) worker.join();
+        }
+        workers.clear();
+    }
+    
+private:
+    struct WorkQueue {
+        std::mutex mutex;
+        std::deque<std::function<void()>> jobs;
+    };
+    
+    bool take(size_t index, std::function<void()>& job) {
+        {
+            std::lock_guard<std::mutex> lock(queues[index].mutex);
+            if (!queues[index].jobs.empty()) {
+                job = std::move(queues[index].jobs.back());
+                queues[index].jobs.pop_back();
+                return true;
+            }
+        }
+        for (size_t k = 1; k < queueCount; ++k) {
+            auto& victim = queues[(index + k) % queueCount];
+            std::lock_guard<std::mutex> lock(victim.mutex);
+            if (!victim.jobs.empty()) {
+                job = std::move(victim.jobs.front());
+                victim.jobs.pop_front();
+                return true;
+            }
+        }
+        return false;
+    }
+    
+    void work(size_t index) {
+        owner = this;
+        workerIndex = index;
+        for (;;) {
+            std::function<void()> job;
+            if (take(index, job)) {
+                pending--;
+                job();
+                continue;
+            }
+            std::unique_lock<std::mutex> lock(idleMutex);
+            idle.wait(lock, [this] { return stopping || pending.load() > 0; });
+            if (stopping) return;
+        }
+    }
+    
+    std::unique_ptr<WorkQueue[]> queues;
+    size_t queueCount;
+    std::vector<std::thread> workers;
+    std::atomic<size_t> next{0};
+    std::atomic<size_t> pending{0};
+    std::mutex idleMutex;
+    std::condition_variable idle;
+    bool stopping = false;
+    
+    static inline thread_local WorkPool* owner = nullptr;
+    static inline thread_local size_t workerIndex = 0;
+};
+
+// co_await Offload<T>(reactor, pool, job): runs job() on the pool and resumes
+// the awaiting coroutine with its result on the reactor thread.
+template <typename T>
+class Offload {
+public:
+    Offload(Reactor& r, WorkPool& p, std::function<T()> j)
+        : reactor(r), pool(p), job(std::move(j)), result(std::make_shared<T>()) {}
+    
+    bool await_ready() const noexcept { return false; }
+    void await_suspend(std::coroutine_handle<> handle) {
+        // The result lives outside the frame: the reactor may destroy it at shutdown mid-job
+        pool.submit([&reactor = reactor, job = std::move(job), result = result, handle] {
+            *result = job();
+            reactor.post(handle);
+        });
+    }
+    T await_resume() { return std::move(*result); }
+    
+private:
+    Reactor& reactor;
+    WorkPool& pool;
+    std::function<T()> job;
+    std::shared_ptr<T> result;
+};
+#endif
+
 // Event-driven file watcher
 class FileWatcher {
 private:
@@ -453,7 +933,7 @@ public:
     }
     
     bool checkChanges() {
-        if (inotifyFd == -1) return pollChanges();
+        if (inotifyFd == -1) return false;
         
         char buffer[1024];
         ssize_t length = read(inotifyFd, buffer, sizeof(buffer));
@@ -468,20 +948,11 @@ public:
             }
             i += sizeof(inotify_event) + event->len;
         }
-        
-        // Remove entries for files that no longer exist
-        auto it = fileStates.begin();
-        while (it != fileStates.end()) {
-            if (!fs::exists(it->first)) {
-                it = fileStates.erase(it);
-            } else {
-                ++it;
-            }
-        }
+        return false;
     }
     
     ~FileWatcher() {
-        if (watchFd != -1) close(watchFd);
+        // Drops the watch too; watchFd is a watch number, not a file descriptor to close
         if (inotifyFd != -1) close(inotifyFd);
     }
 #endif
@@ -498,6 +969,19 @@ class ResponseBuilder {
 private:
     static const std::unordered_map<std::string, std::string> mimeTypes;
     
+    static void appendHeaders(std::string& response, int code, std::string_view contentType,
+                              size_t contentLength, bool keepAlive) {
+        response += "HTTP/1.1 ";
+        response += std::to_string(code);
+        response += code == 200 ? " OK\r\n" : " Error\r\n";
+        response += "Content-Type: ";
+        response += contentType;
+        response += "\r\nContent-Length: ";
+        response += std::to_string(contentLength);
+        response += keepAlive ? "\r\nConnection: keep-alive\r\n" : "\r\nConnection: close\r\n";
+        response += "Cache-Control: no-cache\r\n\r\n";
+    }
+    
 public:
     static std::string getMimeType(std::string_view filename) {
         auto dotPos = filename.find_last_of('.');
@@ -508,25 +992,27 @@ public:
         return it != mimeTypes.end() ? it->second : "text/plain";
     }
     
-    static std::string buildResponse(int code, std::string_view contentType, std::string_view body) {
+    static std::string buildResponse(int code, std::string_view contentType, std::string_view body,
+                                     bool keepAlive = false) {
         std::string response;
         response.reserve(200 + body.size());
         
-        response += "HTTP/1.1 ";
-        response += std::to_string(code);
-        response += code == 200 ? " OK\r\n" : " Error\r\n";
-        response += "Content-Type: ";
-        response += contentType;
-        response += "\r\nContent-Length: ";
-        response += std::to_string(body.size());
-        response += "\r\nConnection: close\r\n";
-        response += "Cache-Control: no-cache\r\n\r\n";
+        appendHeaders(response, code, contentType, body.size(), keepAlive);
         response += body;
         
         return response;
     }
     
-    static std::string notFound() {
+    // Headers only, for a body sent separately
+    static std::string buildHeaders(int code, std::string_view contentType, size_t contentLength,
+                                    bool keepAlive = false) {
+        std::string response;
+        response.reserve(200);
+        appendHeaders(response, code, contentType, contentLength, keepAlive);
+        return response;
+    }
+    
+    static std::string notFound(bool keepAlive = false) {
         return buildResponse(404, "text/html", 
             "<!DOCTYPE html>\n"
             "<html lang=\"en\">\n"
@@ -827,12 +1313,13 @@ public:
             "        chatInput.focus();\n"
             "    </script>\n"
             "</body>\n"
-            "</html>"
+            "</html>",
+            keepAlive
         );
     }
     
-    static std::string rateLimited() {
-        return buildResponse(429, "application/json", "{\"error\":\"rate_limited\"}");
+    static std::string rateLimited(bool keepAlive = false) {
+        return buildResponse(429, "application/json", "{\"error\":\"rate_limited\"}", keepAlive);
     }
     
     static std::string serverError() {
@@ -843,7 +1330,9 @@ public:
 const std::unordered_map<std::string, std::string> ResponseBuilder::mimeTypes = {
     {".html", "text/html"}, {".css", "text/css"}, {".js", "application/javascript"},
     {".json", "application/json"}, {".png", "image/png"}, {".jpg", "image/jpeg"},
-    {".ico", "image/x-icon"}, {".svg", "image/svg+xml"}
+    {".ico", "image/x-icon"}, {".svg", "image/svg+xml"},
+    {".mp4", "video/mp4"}, {".webm", "video/webm"}, {".wasm", "application/wasm"},
+    {".map", "application/json"}
 };
 
 // Main server class
@@ -861,8 +1350,13 @@ private:
     
     std::thread serverThread;
     std::thread watcherThread;
+#ifndef _WIN32
+    std::unique_ptr<Reactor> reactor;
+    std::unique_ptr<WorkPool> workPool; // After the reactor: its jobs post to it
+#endif
     
     int port;
+    static constexpr std::string_view liveReloadTag = "<script src=\"/live-reload.js\"></script>";
     // Live reload script (minimal)
     static constexpr std::string_view liveReloadScript = R"(
 (function(){
@@ -887,7 +1381,7 @@ public:
         if (WSAStartup(MAKEWORD(2, 2), &wsa) != 0) return false;
 #endif
         
-        if (!serverSocket.create() || !serverSocket.bind(port) || !serverSocket.listen()) {
+        if (!serverSocket.create() || !serverSocket.bind(port) || !serverSocket.listen(SOMAXCONN)) {
             return false;
         }
         
@@ -895,6 +1389,7 @@ public:
             std::cerr << "Warning: File watching unavailable\n";
         }
         
+#ifdef _WIN32
         running = true;
         
         // Server thread
@@ -908,6 +1403,20 @@ public:
                 std::this_thread::sleep_for(std::chrono::milliseconds(1));
             }
         });
+#else
+        reactor = std::make_unique<Reactor>();
+        if (!reactor->valid() || !serverSocket.setNonBlocking()) {
+            return false;
+        }
+        workPool = std::make_unique<WorkPool>();
+        running = true;
+        
+        // Server thread: every connection is a coroutine on this one epoll loop
+        serverThread = std::thread([this]() {
+            acceptLoop();
+            reactor->run();
+        });
+#endif
         
         // File watcher thread
         watcherThread = std::thread([this]() {
@@ -925,10 +1434,18 @@ public:
     
     void stop() {
         running = false;
-        serverSocket.close();
+#ifdef _WIN32
+        serverSocket.close(); // Unblocks accept()
+#else
+        if (reactor) reactor->stop();
+#endif
         
         if (serverThread.joinable()) serverThread.join();
         if (watcherThread.joinable()) watcherThread.join();
+#ifndef _WIN32
+        if (workPool) workPool->shutdown();
+#endif
+        serverSocket.close();
         
 #ifdef _WIN32
         WSACleanup();
@@ -947,6 +1464,7 @@ public:
     }
     
 private:
+#ifdef _WIN32
     void handleClient(Socket client) {
         activeConnections--;  // Ensure decrement on exit
         
@@ -962,59 +1480,310 @@ private:
         }
         
         int bytesRead = client.recv(buffer.get(), Config::MAX_REQUEST_SIZE - 1);
-        if (bytesRead <= 0) return;
+        std::string response;
+        if (bytesRead > 0) {
+            response = respond(std::string_view(buffer.get(), bytesRead));
+        }
+        bufferPool->release(std::move(buffer));
         
-        buffer[bytesRead] = '\0';
-        std::string_view request(buffer.get(), bytesRead);
+        if (!response.empty()) {
+            client.send(response);
+        }
+    }
+#else
+    // Counts a connection for as long as its frame lives, destroyed at shutdown included
+    class ConnectionSlot {
+    public:
+        explicit ConnectionSlot(std::atomic<uint32_t>& c) : count(c) { count++; }
+        ~ConnectionSlot() { count--; }
+        ConnectionSlot(const ConnectionSlot&) = delete;
+        ConnectionSlot& operator=(const ConnectionSlot&) = delete;
         
-        // Parse request
+    private:
+        std::atomic<uint32_t>& count;
+    };
+    
+    Task acceptLoop() {
+        while (co_await reactor->readable(serverSocket.native())) {
+            for (;;) {
+                auto client = serverSocket.acceptNonBlocking();
+                if (!client.isValid()) break;
+                
+                if (activeConnections < Config::MAX_CONNECTIONS) {
+                    handleConnection(std::move(client));
+                }
+            }
+        }
+    }
+    
+    // A request buffer that goes back to the pool however the connection ends
+    class PooledBuffer {
+    public:
+        explicit PooledBuffer(BufferPool& p) : pool(p) {}
+        ~PooledBuffer() { release(); }
+        PooledBuffer(const PooledBuffer&) = delete;
+        PooledBuffer& operator=(const PooledBuffer&) = delete;
+        
+        bool acquire() { return data || (data = pool.acquire()) != nullptr; }
+        void release() { pool.release(std::move(data)); }
+        char* get() const { return data.get(); }
+        explicit operator bool() const { return data != nullptr; }
+        
+    private:
+        BufferPool& pool;
+        std::unique_ptr<char[]> data;
+    };
+    
+    // Serves requests in order until the client closes, goes idle past
+    // KEEP_ALIVE_TIMEOUT or reaches MAX_REQUESTS_PER_CONNECTION. Pipelined
+    // requests wait in the one read buffer behind the request being served.
+    Task handleConnection(Socket client) {
+        ConnectionSlot slot(activeConnections);
+        int fd = client.native();
+        PooledBuffer buffer(*bufferPool);
+        size_t filled = 0;
+        
+        for (uint32_t served = 0; served < Config::MAX_REQUESTS_PER_CONNECTION; ++served) {
+            size_t headEnd;
+            while ((headEnd = requestHeadEnd(std::string_view(buffer.get(), filled))) == 0) {
+                if (filled == Config::MAX_REQUEST_SIZE) co_return; // Head too large
+                
+                // Between requests the connection holds no buffer, just this frame
+                if (!buffer) {
+                    auto idle = served == 0 ? Config::IO_TIMEOUT : Config::KEEP_ALIVE_TIMEOUT;
+                    if (!co_await reactor->readable(fd, idle)) co_return;
+                    if (!buffer.acquire()) {
+                        co_await sendAll(client, ResponseBuilder::serverError());
+                        co_return;
+                    }
+                }
+                
+                ssize_t bytesRead = ::recv(fd, buffer.get() + filled, Config::MAX_REQUEST_SIZE - filled, 0);
+                if (bytesRead > 0) {
+                    filled += static_cast<size_t>(bytesRead);
+                } else if (bytesRead == 0 || errno != EAGAIN ||
+                           !co_await reactor->readable(fd, Config::IO_TIMEOUT)) {
+                    co_return;
+                }
+            }
+            
+            std::string_view head(buffer.get(), headEnd);
+            auto path = requestPath(head);
+            bool keepAlive = served + 1 < Config::MAX_REQUESTS_PER_CONNECTION && wantsKeepAlive(head);
+            
+            // Whatever follows is the next pipelined request
+            filled -= headEnd;
+            std::memmove(buffer.get(), buffer.get() + headEnd, filled);
+            if (filled == 0) buffer.release();
+            
+            if (!path) co_return;
+            
+            Response response;
+            if (!rateLimiter->allowRequest()) {
+                response.data = ResponseBuilder::rateLimited(keepAlive);
+            } else if (auto builtin = serveBuiltin(*path, keepAlive)) {
+                response.data = std::move(*builtin);
+            } else {
+                // Files go through the pool: a cold disk read never stalls the other connections.
+                // The job is built outside the co_await, which GCC 12 miscompiles with init-captures.
+                std::function<Response()> read = [this, file = fileFor(*path), keepAlive] {
+                    return serveFileOrStream(file, keepAlive);
+                };
+                response = co_await Offload<Response>(*reactor, *workPool, std::move(read));
+            }
+            
+            if (!co_await sendResponse(client, response) || !keepAlive) co_return;
+        }
+    }
+    
+    // Suspends while the socket buffer is full instead of blocking the reactor
+    Async<bool> sendAll(Socket& client, std::string_view data, bool more = false) {
+        size_t sent = 0;
+        while (sent < data.size()) {
+            ssize_t result = client.sendSome(data.substr(sent), more);
+            if (result > 0) {
+                sent += static_cast<size_t>(result);
+            } else if (result < 0 && errno == EAGAIN &&
+                       co_await reactor->writable(client.native(), Config::IO_TIMEOUT)) {
+                continue;
+            } else {
+                co_return false;
+            }
+        }
+        co_return true;
+    }
+    
+    // Every part but the last goes with MSG_MORE, so small ones share segments
+    Async<bool> sendResponse(Socket& client, const Response& response) {
+        bool streamed = response.file.isValid();
+        size_t parts = 0;
+        for (auto part : response.body) parts += !part.empty();
+        
+        if (!co_await sendAll(client, response.data, streamed || parts > 0)) co_return false;
+        for (auto part : response.body) {
+            if (part.empty()) continue;
+            if (!co_await sendAll(client, part, streamed || --parts > 0)) co_return false;
+        }
+        if (streamed) {
+            co_return co_await sendFile(client, response.file.native(), response.length);
+        }
+        co_return true;
+    }
+    
+    // Kernel-to-socket copy of `length` bytes. A file that shrank since it was
+    // opened fails the send: the Content-Length already went out.
+    Async<bool> sendFile(Socket& client, int fd, off_t length) {
+        off_t offset = 0;
+        while (offset < length) {
+            ssize_t result = client.sendFile(fd, &offset, static_cast<size_t>(length - offset));
+            if (result > 0) {
+                continue;
+            } else if (result < 0 && errno == EAGAIN &&
+                       co_await reactor->writable(client.native(), Config::IO_TIMEOUT)) {
+                continue;
+            } else {
+                co_return false;
+            }
+        }
+        co_return true;
+    }
+    
+    // Files over the cache limit are streamed from their descriptor, never read
+    // into memory (so large HTML goes out without the live reload script)
+    Response serveFileOrStream(const std::string& filename, bool keepAlive) {
+        Response response;
+        struct stat info;
+        if (PathValidator::isValidPath(filename) && ::stat(filename.c_str(), &info) == 0 &&
+            S_ISREG(info.st_mode) && static_cast<size_t>(info.st_size) > Config::MAX_FILE_SIZE) {
+            FileHandle file(::open(filename.c_str(), O_RDONLY | O_CLOEXEC));
+            if (file.isValid() && ::fstat(file.native(), &info) == 0) {
+                response.data = ResponseBuilder::buildHeaders(200, ResponseBuilder::getMimeType(filename),
+                                                              static_cast<size_t>(info.st_size), keepAlive);
+                response.file = std::move(file);
+                response.length = info.st_size;
+                return response;
+            }
+        }
+        
+        return serveFile(filename, keepAlive);
+    }
+#endif
+    
+    // The response to one request, or empty to just close the connection
+    std::string respond(std::string_view request) {
+        auto path = requestPath(request);
+        if (!path) return {};
+        
+        if (auto builtin = serveBuiltin(*path, false)) return *builtin;
+        
+        auto response = serveFile(fileFor(*path), false);
+        for (auto part : response.body) response.data += part;
+        return response.data;
+    }
+    
+    // Length of the request head including its blank line, 0 until it is all there
+    static size_t requestHeadEnd(std::string_view data) {
+        auto end = data.find("\r\n\r\n");
+        return end == std::string_view::npos ? 0 : end + 4;
+    }
+    
+    // HTTP/1.1 stays open unless the client asks to close, 1.0 only when it asks to stay
+    static bool wantsKeepAlive(std::string_view head) {
+        // A body is never read, so it would be parsed as the next request
+        if (headerValue(head, "content-length").value_or("0") != "0" || headerValue(head, "transfer-encoding")) {
+            return false;
+        }
+        
+        auto connection = headerValue(head, "connection");
+        if (connection && equalsIgnoreCase(*connection, "close")) return false;
+        if (connection && equalsIgnoreCase(*connection, "keep-alive")) return true;
+        
+        auto requestLine = head.substr(0, head.find("\r\n"));
+        return requestLine.ends_with("HTTP/1.1");
+    }
+    
+    static std::optional<std::string_view> headerValue(std::string_view head, std::string_view name) {
+        size_t lineStart = head.find("\r\n");
+        while (lineStart != std::string_view::npos) {
+            lineStart += 2;
+            size_t lineEnd = head.find("\r\n", lineStart);
+            auto line = head.substr(lineStart, lineEnd - lineStart);
+            auto colon = line.find(':');
+            if (colon != std::string_view::npos && equalsIgnoreCase(line.substr(0, colon), name)) {
+                auto value = line.substr(colon + 1);
+                while (!value.empty() && (value.front() == ' ' || value.front() == '\t')) value.remove_prefix(1);
+                while (!value.empty() && (value.back() == ' ' || value.back() == '\t')) value.remove_suffix(1);
+                return value;
+            }
+            lineStart = lineEnd;
+        }
+        return std::nullopt;
+    }
+    
+    static bool equalsIgnoreCase(std::string_view a, std::string_view b) {
+        return a.size() == b.size() && std::equal(a.begin(), a.end(), b.begin(), [](char x, char y) {
+            return std::tolower(static_cast<unsigned char>(x)) == std::tolower(static_cast<unsigned char>(y));
+        });
+    }
+    
+    // The path of a GET request; nothing for anything else
+    static std::optional<std::string> requestPath(std::string_view request) {
         auto firstSpace = request.find(' ');
         auto secondSpace = request.find(' ', firstSpace + 1);
         
         if (firstSpace == std::string_view::npos || secondSpace == std::string_view::npos) {
-            return;
+            return std::nullopt;
         }
         
         auto method = request.substr(0, firstSpace);
-        auto path = request.substr(firstSpace + 1, secondSpace - firstSpace - 1);
-        
-        if (method != "GET") return;
+        if (method != "GET") return std::nullopt;
         
-        // Route request
+        return std::string(request.substr(firstSpace + 1, secondSpace - firstSpace - 1));
+    }
+    
+    // Routes answered from memory; nothing when the path is a file
+    std::optional<std::string> serveBuiltin(std::string_view path, bool keepAlive) {
         if (path == "/reload") {
-            serveReload(client);
+            return serveReload(keepAlive);
         } else if (path == "/live-reload.js") {
-            client.send(ResponseBuilder::buildResponse(200, "application/javascript", liveReloadScript));
-        } else {
-            serveFile(client, path == "/" ? "index.html" : std::string(path.substr(1)));
+            return ResponseBuilder::buildResponse(200, "application/javascript", liveReloadScript, keepAlive);
         }
-        
-        bufferPool->release(std::move(buffer));
+        return std::nullopt;
+    }
+    
+    static std::string fileFor(std::string_view path) {
+        return path == "/" ? "index.html" : std::string(path.substr(1));
     }
     
-    void serveFile(Socket& client, const std::string& filename) {
+    // A hit costs one reference to the cached bytes; nothing is copied
+    Response serveFile(const std::string& filename, bool keepAlive) {
+        Response response;
         auto content = fileCache->getFile(filename);
-        if (content.empty()) {
-            client.send(ResponseBuilder::notFound());
-            return;
+        if (!content || content->empty()) {
+            response.data = ResponseBuilder::notFound(keepAlive);
+            return response;
         }
         
-        // Inject live reload for HTML
-        if (filename.ends_with(".html")) {
-            auto pos = content.find("</body>");
-            if (pos != std::string::npos) {
-                content.insert(pos, "<script src=\"/live-reload.js\"></script>");
-            }
+        // Inject live reload for HTML, between two slices of the shared bytes
+        std::string_view bytes = *content;
+        auto pos = filename.ends_with(".html") ? bytes.rfind("</body>") : std::string_view::npos;
+        if (pos != std::string_view::npos) {
+            response.body = {bytes.substr(0, pos), liveReloadTag, bytes.substr(pos)};
+        } else {
+            response.body = {bytes};
         }
         
-        auto mimeType = ResponseBuilder::getMimeType(filename);
-        client.send(ResponseBuilder::buildResponse(200, mimeType, content));
+        size_t length = 0;
+        for (auto part : response.body) length += part.size();
+        response.data = ResponseBuilder::buildHeaders(200, ResponseBuilder::getMimeType(filename), length, keepAlive);
+        response.shared = std::move(content);
+        return response;
     }
     
-    void serveReload(Socket& client) {
+    std::string serveReload(bool keepAlive) {
         bool reload = filesChanged.exchange(false);
         std::string json = reload ? "{\"reload\":true}" : "{\"reload\":false}";
-        client.send(ResponseBuilder::buildResponse(200, "application/json", json));
+        return ResponseBuilder::buildResponse(200, "application/json", json, keepAlive);
     }
 };
 
@@ -0,0 +1,57 @@
+/*
+    Copyright © 2025 Mint teams
+    fingerprint.c
+    The generic Node.js process watcher
+*/
+
+#include "fingerprint.h"
+
+typedef uint64_t (*FingerprintDiffFn)(const time_t *current, const time_t *last, size_t count, uint64_t *bitmap);
+
+static uint64_t fingerprint_diff_scalar(const time_t *current, const time_t *last, size_t count, uint64_t *bitmap) {
+    uint64_t any = 0;
+    for (size_t base = 0; base < count; base += 64) {
+        uint64_t word = 0;
+        size_t end = count - base < 64 ? count - base : 64;
+        for (size_t bit = 0; bit < end; ++bit) {
+            word |= (uint64_t)(current[base + bit] != last[base + bit]) << bit;
+        }
+        bitmap[base / 64] = word;
+        any |= word;
+    }
+    return any;
+}
+
+static FingerprintDiffFn g_diff = fingerprint_diff_scalar;
+static const char *g_kernel_name = "scalar";
+
+// The kernels use the System V calling convention and a 64-bit time_t.
+#if defined(__x86_64__) && !defined(_WIN32)
+extern int cpu_has_avx2_asm(void);
+extern uint64_t fingerprint_diff_avx2_asm(const time_t *current, const time_t *last, size_t count, uint64_t *bitmap);
+extern uint64_t fingerprint_diff_sse2_asm(const time_t *current, const time_t *last, size_t count, uint64_t *bitmap);
+
+_Static_assert(sizeof(time_t) == 8, "fingerprint kernels compare 64-bit lanes");
+
+void fingerprint_init(void) {
+    // SSE2 is part of the x86-64 baseline
+    if (cpu_has_avx2_asm()) {
+        g_diff = fingerprint_diff_avx2_asm;
+        g_kernel_name = "avx2";
+    } else {
+        g_diff = fingerprint_diff_sse2_asm;
+        g_kernel_name = "sse2";
+    }
+}
+#else
+void fingerprint_init(void) {
+}
+#endif
+
+uint64_t fingerprint_diff(const time_t *current, const time_t *last, size_t count, uint64_t *bitmap) {
+    return g_diff(current, last, count, bitmap);
+}
+
+const char *fingerprint_kernel_name(void) {
+    return g_kernel_name;
+}
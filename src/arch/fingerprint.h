@@ -0,0 +1,29 @@
+/*
+    Copyright © 2025 Mint teams
+    fingerprint.h
+    The generic Node.js process watcher
+*/
+
+#ifndef FINGERPRINT_H
+#define FINGERPRINT_H
+
+#include <stddef.h>
+#include <stdint.h>
+#include <time.h>
+
+// uint64_t words needed for a bitmap over `count` entries
+#define FINGERPRINT_BITMAP_WORDS(count) (((size_t)(count) + 63) / 64)
+
+// Picks the widest compare kernel the CPU supports. Call once at startup.
+void fingerprint_init(void);
+
+/*
+    Sets bit i of `bitmap` when current[i] != last[i], clears it otherwise.
+    Returns nonzero when any bit is set.
+*/
+uint64_t fingerprint_diff(const time_t *current, const time_t *last, size_t count, uint64_t *bitmap);
+
+// "avx2", "sse2" or "scalar"
+const char *fingerprint_kernel_name(void);
+
+#endif // FINGERPRINT_H
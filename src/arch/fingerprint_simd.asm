@@ -0,0 +1,170 @@
+; Copyright © 2025 Mint teams
+; fingerprint_simd.asm - vectorized compare of the mtime tables
+
+section .text
+    global cpu_has_avx2_asm
+    global fingerprint_diff_avx2_asm
+    global fingerprint_diff_sse2_asm
+
+; int cpu_has_avx2_asm(void)
+; Returns 1 when the CPU has AVX2 and the OS saves YMM state, else 0.
+cpu_has_avx2_asm:
+    push    rbp
+    mov     rbp, rsp
+    push    rbx                 ; cpuid clobbers RBX, which is callee-saved
+
+    xor     eax, eax            ; Leaf 0: highest supported leaf
+    cpuid
+    cmp     eax, 7
+    jb      .no
+
+    mov     eax, 1              ; Leaf 1: ECX bit 27 = OSXSAVE, bit 28 = AVX
+    xor     ecx, ecx
+    cpuid
+    and     ecx, (1 << 27) | (1 << 28)
+    cmp     ecx, (1 << 27) | (1 << 28)
+    jne     .no
+
+    xor     ecx, ecx            ; XCR0: bit 1 = XMM state, bit 2 = YMM state
+    xgetbv
+    and     eax, 6
+    cmp     eax, 6
+    jne     .no
+
+    mov     eax, 7              ; Leaf 7, subleaf 0: EBX bit 5 = AVX2
+    xor     ecx, ecx
+    cpuid
+    mov     eax, ebx
+    shr     eax, 5
+    and     eax, 1
+    jmp     .done
+
+.no:
+    xor     eax, eax
+
+.done:
+    pop     rbx
+    pop     rbp
+    ret
+
+; Both kernels share one contract:
+; uint64_t fingerprint_diff_*_asm(const time_t *current, const time_t *last,
+;                                 size_t count, uint64_t *bitmap)
+; Sets bit i of the bitmap when current[i] != last[i] and clears it otherwise,
+; writing all (count + 63) / 64 words. Returns the OR of those words, so
+; nonzero means at least one entry differs. Unaligned loads are fine.
+; C ABI: RDI = current, RSI = last, RDX = count, RCX = bitmap
+;
+; Registers: R8 = bitmap cursor, R9 = entry index, R10 = word being built,
+; CL = bit position in that word, R11 = scratch, RAX = OR of all words.
+
+; Four entries per compare.
+fingerprint_diff_avx2_asm:
+    push    rbp
+    mov     rbp, rsp
+    mov     r8, rcx             ; Free CL for the shifts
+    xor     eax, eax
+    xor     r9d, r9d
+
+.next_word:
+    cmp     r9, rdx
+    jae     .finish
+    xor     r10d, r10d
+    xor     ecx, ecx
+
+.vector:
+    lea     r11, [r9 + 4]
+    cmp     r11, rdx
+    ja      .scalar             ; Fewer than 4 entries left
+    vmovdqu ymm0, [rdi + r9 * 8]
+    vpcmpeqq ymm0, ymm0, [rsi + r9 * 8]
+    vmovmskpd r11d, ymm0        ; One bit per equal lane
+    xor     r11d, 0xF           ; ... flipped to one bit per changed lane
+    shl     r11, cl
+    or      r10, r11
+    add     r9, 4
+    add     ecx, 4
+    cmp     ecx, 64
+    jb      .vector
+    jmp     .store
+
+.scalar:
+    cmp     r9, rdx
+    jae     .store
+    mov     r11, [rdi + r9 * 8]
+    cmp     r11, [rsi + r9 * 8]
+    setne   r11b
+    movzx   r11d, r11b
+    shl     r11, cl
+    or      r10, r11
+    inc     r9
+    inc     ecx
+    jmp     .scalar
+
+.store:
+    mov     [r8], r10
+    add     r8, 8
+    or      rax, r10
+    jmp     .next_word
+
+.finish:
+    vzeroupper                  ; Avoid the SSE transition penalty in the caller
+    pop     rbp
+    ret
+
+; Two entries per compare. SSE2 has no 64-bit pcmpeq, so compare the
+; 32-bit halves and AND each half with its neighbour.
+fingerprint_diff_sse2_asm:
+    push    rbp
+    mov     rbp, rsp
+    mov     r8, rcx
+    xor     eax, eax
+    xor     r9d, r9d
+
+.next_word:
+    cmp     r9, rdx
+    jae     .finish
+    xor     r10d, r10d
+    xor     ecx, ecx
+
+.vector:
+    lea     r11, [r9 + 2]
+    cmp     r11, rdx
+    ja      .scalar
+    movdqu  xmm0, [rdi + r9 * 8]
+    movdqu  xmm1, [rsi + r9 * 8]
+    pcmpeqd xmm0, xmm1
+    pshufd  xmm1, xmm0, 0xB1    ; Swap the halves of each 64-bit lane
+    pand    xmm0, xmm1
+    movmskpd r11d, xmm0
+    xor     r11d, 0x3
+    shl     r11, cl
+    or      r10, r11
+    add     r9, 2
+    add     ecx, 2
+    cmp     ecx, 64
+    jb      .vector
+    jmp     .store
+
+.scalar:
+    cmp     r9, rdx
+    jae     .store
+    mov     r11, [rdi + r9 * 8]
+    cmp     r11, [rsi + r9 * 8]
+    setne   r11b
+    movzx   r11d, r11b
+    shl     r11, cl
+    or      r10, r11
+    inc     r9
+    inc     ecx
+    jmp     .scalar
+
+.store:
+    mov     [r8], r10
+    add     r8, 8
+    or      rax, r10
+    jmp     .next_word
+
+.finish:
+    pop     rbp
+    ret
@@ -1,9 +1,8 @@
 ; Copyright © 2025 Mint teams
 ; syscalls.asm - x86-64 syscall wrappers
 
-section .data
-    ; stat struct buffer, size is 144 bytes on x86-64 Linux
-    stat_buf: times 144 db 0
+; stat struct size is 144 bytes on x86-64 Linux
+%define STAT_BUF_SIZE 144
 
 section .text
     global get_mtime_asm
@@ -12,15 +11,18 @@ section .text
 ; time_t get_mtime_asm(const char *filepath)
 ; Returns the modification time of a file.
 ; On error or if file not found, returns 0.
+; The stat buffer lives on the stack, so poll workers can call this
+; from several threads at once.
 ; C ABI: RDI = filepath
 get_mtime_asm:
     push    rbp
     mov     rbp, rsp
+    sub     rsp, STAT_BUF_SIZE  ; 144 = 9 * 16 keeps RSP 16-byte aligned
 
     ; Syscall: stat(const char *pathname, struct stat *statbuf)
     mov     rax, STAT_SYSCALL   ; Syscall number for stat (4 on x86-64)
     ; RDI already contains the filepath (1st argument)
-    lea     rsi, [rel stat_buf] ; 2nd argument: pointer to stat_buf
+    mov     rsi, rsp            ; 2nd argument: pointer to the stack buffer
     syscall
 
     ; Check for error (syscall returns negative on error)
@@ -29,13 +31,14 @@ get_mtime_asm:
 
     ; Success: The modification time (st_mtime) is at offset 104 (0x68)
     ; in the stat struct for x86-64. It's a 64-bit value (timespec.tv_sec).
-    mov     rax, [rel stat_buf + 104]
+    mov     rax, [rsp + 104]
     jmp     .done
 
 .error:
     xor     rax, rax            ; Return 0 on error
 
 .done:
+    mov     rsp, rbp
     pop     rbp
     ret
 
@@ -55,4 +58,42 @@ process_stop_asm:
 
     ; No return value needed (void function)
     pop     rbp
-    ret
\ No newline at end of file
+    ret
+%ifdef KAVIN_LINUX
+; Raw Linux x86-64 wrappers for the freestanding build (src/freestanding).
+; They return the kernel's result unchanged: a negative errno on failure,
+; since there is no libc errno to set. The C ABI passes the 4th argument
+; in RCX, but the syscall instruction clobbers RCX, so the kernel takes it
+; in R10. Arguments 5 and 6 (R8, R9) line up already.
+%macro SYSCALL_WRAPPER 2
+    global %1
+%1:
+    mov     rax, %2
+    mov     r10, rcx
+    syscall
+    ret
+%endmacro
+
+SYSCALL_WRAPPER sys_read_asm, 0               ; (fd, buf, len)
+SYSCALL_WRAPPER sys_write_asm, 1              ; (fd, buf, len)
+SYSCALL_WRAPPER sys_close_asm, 3              ; (fd)
+SYSCALL_WRAPPER sys_nanosleep_asm, 35         ; (req, rem)
+SYSCALL_WRAPPER sys_fork_asm, 57              ; ()
+SYSCALL_WRAPPER sys_execve_asm, 59            ; (path, argv, envp)
+SYSCALL_WRAPPER sys_wait4_asm, 61             ; (pid, status, options, rusage)
+SYSCALL_WRAPPER sys_kill_asm, 62              ; (pid, sig)
+SYSCALL_WRAPPER sys_setpgid_asm, 109          ; (pid, pgid)
+SYSCALL_WRAPPER sys_rt_sigprocmask_asm, 14    ; (how, set, old, sigsetsize)
+SYSCALL_WRAPPER sys_signalfd4_asm, 289        ; (fd, mask, sigsetsize, flags)
+SYSCALL_WRAPPER sys_inotify_init1_asm, 294    ; (flags)
+SYSCALL_WRAPPER sys_inotify_add_watch_asm, 254 ; (fd, path, mask)
+SYSCALL_WRAPPER sys_epoll_create1_asm, 291    ; (flags)
+SYSCALL_WRAPPER sys_epoll_ctl_asm, 233        ; (epfd, op, fd, event)
+SYSCALL_WRAPPER sys_epoll_wait_asm, 232       ; (epfd, events, max, timeout_ms)
+SYSCALL_WRAPPER sys_clock_gettime_asm, 228    ; (clock, ts)
+SYSCALL_WRAPPER sys_exit_group_asm, 231       ; (status)
+
+; Also used by the regular Linux build: the initial directory scan reads
+; entries straight into a large buffer (src/watcher/watcher_scan.c).
+SYSCALL_WRAPPER sys_getdents64_asm, 217       ; (fd, dirp, count)
+%endif
@@ -12,4 +12,34 @@
 extern time_t get_mtime_asm(const char *filepath);
 extern int process_stop_asm(pid_t pid);
 
+#ifdef KAVIN_FREESTANDING
+/*
+    Linux x86-64 only, assembled when ASM_DEFINES has -DKAVIN_LINUX.
+    Used by the libc-free build; every call returns -errno on failure.
+*/
+extern long sys_read_asm(int fd, void *buf, unsigned long len);
+extern long sys_write_asm(int fd, const void *buf, unsigned long len);
+extern long sys_close_asm(int fd);
+extern long sys_nanosleep_asm(const struct timespec *req, struct timespec *rem);
+extern long sys_fork_asm(void);
+extern long sys_execve_asm(const char *path, char *const argv[], char *const envp[]);
+extern long sys_wait4_asm(int pid, int *status, int options, void *rusage);
+extern long sys_kill_asm(int pid, int sig);
+extern long sys_setpgid_asm(int pid, int pgid);
+extern long sys_rt_sigprocmask_asm(int how, const unsigned long *set, unsigned long *old, unsigned long sigsetsize);
+extern long sys_signalfd4_asm(int fd, const unsigned long *mask, unsigned long sigsetsize, int flags);
+extern long sys_inotify_init1_asm(int flags);
+extern long sys_inotify_add_watch_asm(int fd, const char *path, unsigned int mask);
+extern long sys_epoll_create1_asm(int flags);
+extern long sys_epoll_ctl_asm(int epfd, int op, int fd, void *event);
+extern long sys_epoll_wait_asm(int epfd, void *events, int max_events, int timeout_ms);
+extern long sys_clock_gettime_asm(int clock, struct timespec *ts);
+extern void sys_exit_group_asm(int status) __attribute__((noreturn));
+#endif
+
+#ifdef __linux__
+// Raw getdents64(2): fills `buf` with linux_dirent64 records, -errno on failure.
+extern long sys_getdents64_asm(int fd, void *buf, unsigned long len);
+#endif
+
 #endif // SYSCALLS_H
\ No newline at end of file
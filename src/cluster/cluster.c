@@ -0,0 +1,361 @@
+/*
+    Copyright © 2025 Mint teams
+    cluster.c
+    The generic Node.js process watcher
+*/
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <stdint.h>
+
+#include <cluster/cluster.h>
+#include <process/process.h>
+#include <process/warm_cache.h>
+#include <watcher/watcher_actions.h>
+#include <trace/trace.h>
+
+#ifdef _WIN32
+#include <windows.h>
+#else
+#include <fcntl.h>
+#include <unistd.h>
+#include <sys/socket.h>
+#include <sys/un.h>
+#include <sys/wait.h>
+#endif
+
+static const uint64_t CLUSTER_STOP_TIMEOUT_MS = 2000; // Same grace as the single-process restart
+static const uint64_t CLUSTER_RETRY_MS = 1000;        // Before starting a replica whose fork failed again
+
+typedef enum {
+    REPLICA_DOWN,       // Failed to start, retried after CLUSTER_RETRY_MS
+    REPLICA_STARTING,   // Waiting for READY=1 or the ready timeout
+    REPLICA_READY,
+    REPLICA_STOPPING,   // SIGTERM sent
+    REPLICA_KILLING     // SIGKILL sent
+} ReplicaState;
+
+static const char *const REPLICA_STATE_NAMES[] = { "down", "starting", "ready", "stopping", "killing" };
+
+typedef struct {
+    pid_t pid;
+    ReplicaState state;
+    unsigned long generation;   // Code generation this process was started on
+    uint64_t since_ms;          // When it entered `state`
+    uint64_t ready_after_ms;    // Start-to-ready time of the current process
+    unsigned long restarts;
+    unsigned long crashes;
+    int notify_fd;              // NOTIFY_SOCKET datagram socket, -1 without one
+    char notify_path[108];
+} Replica;
+
+struct Cluster {
+    Watcher *watcher;
+    Replica *replicas;
+    int count;
+    unsigned long generation;
+    char notify_dir[64];        // Private directory for the notify sockets, "" without
+};
+
+#ifndef _WIN32
+static void open_notify_socket(Cluster *cluster, Replica *replica, int index) {
+    replica->notify_fd = -1;
+    if (cluster->notify_dir[0] == '\0') {
+        return;
+    }
+
+    struct sockaddr_un addr;
+    memset(&addr, 0, sizeof(addr));
+    addr.sun_family = AF_UNIX;
+    snprintf(replica->notify_path, sizeof(replica->notify_path), "%s/replica-%d.sock", cluster->notify_dir, index);
+    snprintf(addr.sun_path, sizeof(addr.sun_path), "%s", replica->notify_path);
+
+    int fd = socket(AF_UNIX, SOCK_DGRAM, 0);
+    if (fd < 0) {
+        return;
+    }
+    fcntl(fd, F_SETFD, FD_CLOEXEC);
+    fcntl(fd, F_SETFL, fcntl(fd, F_GETFL) | O_NONBLOCK);
+    if (bind(fd, (struct sockaddr *)&addr, sizeof(addr)) != 0) {
+        close(fd);
+        return;
+    }
+    replica->notify_fd = fd;
+}
+
+// Drains the socket; returns 1 if any datagram carried READY=1.
+static int read_notifications(Replica *replica) {
+    if (replica->notify_fd < 0) {
+        return 0;
+    }
+    int ready = 0;
+    char message[1024];
+    ssize_t n;
+    while ((n = recv(replica->notify_fd, message, sizeof(message) - 1, 0)) > 0) {
+        message[n] = '\0';
+        char *save = NULL;
+        for (char *line = strtok_r(message, "\n", &save); line; line = strtok_r(NULL, "\n", &save)) {
+            ready |= strcmp(line, "READY=1") == 0;
+        }
+    }
+    return ready;
+}
+#else
+static void open_notify_socket(Cluster *cluster, Replica *replica, int index) {
+    (void)cluster; (void)index;
+    replica->notify_fd = -1; // Readiness falls back to --ready-timeout
+}
+
+static int read_notifications(Replica *replica) {
+    (void)replica;
+    return 0;
+}
+#endif
+
+static int serving(const Cluster *cluster) {
+    int count = 0;
+    for (int i = 0; i < cluster->count; ++i) {
+        count += cluster->replicas[i].state == REPLICA_READY;
+    }
+    return count;
+}
+
+static void set_state(Replica *replica, ReplicaState state) {
+    replica->state = state;
+    replica->since_ms = watcher_clock_ms();
+}
+
+static void spawn_replica(Cluster *cluster, int index) {
+    Watcher *watcher = cluster->watcher;
+    Replica *replica = &cluster->replicas[index];
+    read_notifications(replica); // Whatever the previous process sent is stale now
+
+    char replica_env[32];
+    char notify_env[sizeof(replica->notify_path) + 16];
+    const char *env[2 + WARM_CACHE_ENV_MAX + 1] = { replica_env };
+    int env_count = 1;
+    snprintf(replica_env, sizeof(replica_env), "KAVIN_REPLICA=%d", index);
+    if (replica->notify_fd >= 0) {
+        snprintf(notify_env, sizeof(notify_env), "NOTIFY_SOCKET=%s", replica->notify_path);
+        env[env_count++] = notify_env;
+    }
+    if (watcher->warm_cache) {
+        for (const char *const *entry = warm_cache_env(watcher->warm_cache); *entry; ++entry) {
+            env[env_count++] = *entry;
+        }
+    }
+
+    ProcessOptions process_options = { watcher->listen_fds, watcher->listen_fd_count, 0, 0, env,
+                                       watcher_child_priority(watcher) };
+    replica->pid = process_start_with(watcher->cmd, &process_options);
+    replica->generation = cluster->generation;
+    if (replica->pid <= 0) {
+        fprintf(stderr, "[Cluster] Failed to start replica %d/%d\n", index + 1, cluster->count);
+        replica->pid = 0;
+        set_state(replica, REPLICA_DOWN);
+        return;
+    }
+
+    set_state(replica, REPLICA_STARTING);
+    printf("[Cluster] Replica %d/%d starting [PID: %lld]\n", index + 1, cluster->count, (long long)replica->pid);
+    if (watcher->trace) {
+        char detail[64];
+        snprintf(detail, sizeof(detail), "replica %d, PID %lld", index + 1, (long long)replica->pid);
+        trace_instant(watcher->trace, TRACE_APP, "Replica started", detail);
+    }
+}
+
+static void restart_replica(Cluster *cluster, int index) {
+    cluster->replicas[index].restarts++;
+    cluster->watcher->restart_count++;
+    spawn_replica(cluster, index);
+}
+
+static void mark_ready(Cluster *cluster, int index, int notified) {
+    Replica *replica = &cluster->replicas[index];
+    replica->ready_after_ms = watcher_clock_ms() - replica->since_ms;
+    set_state(replica, REPLICA_READY);
+    printf("[Cluster] Replica %d/%d ready in %llu ms%s, %d/%d serving\n", index + 1, cluster->count,
+           (unsigned long long)replica->ready_after_ms, notified ? "" : " (no READY=1, timed out)",
+           serving(cluster), cluster->count);
+    if (cluster->watcher->trace) {
+        char detail[64];
+        snprintf(detail, sizeof(detail), "replica %d, %llu ms", index + 1, (unsigned long long)replica->ready_after_ms);
+        trace_instant(cluster->watcher->trace, TRACE_APP, "Replica ready", detail);
+    }
+}
+
+Cluster *cluster_open(Watcher *watcher) {
+    Cluster *cluster = calloc(1, sizeof(Cluster));
+    if (!cluster) {
+        return NULL;
+    }
+    cluster->watcher = watcher;
+    cluster->count = watcher->options->replicas;
+    cluster->replicas = calloc((size_t)cluster->count, sizeof(Replica));
+    if (!cluster->replicas) {
+        free(cluster);
+        return NULL;
+    }
+
+    #ifndef _WIN32
+    snprintf(cluster->notify_dir, sizeof(cluster->notify_dir), "/tmp/kavin-cluster-XXXXXX");
+    if (!mkdtemp(cluster->notify_dir)) {
+        perror("[Cluster] No notify sockets, replicas are ready after --ready-timeout");
+        cluster->notify_dir[0] = '\0';
+    }
+    #endif
+
+    printf("[Cluster] Running %d replicas, rolling restarts gated on READY=1 or %d ms\n",
+           cluster->count, watcher->options->ready_timeout_ms);
+    for (int i = 0; i < cluster->count; ++i) {
+        open_notify_socket(cluster, &cluster->replicas[i], i);
+        spawn_replica(cluster, i);
+    }
+    return cluster;
+}
+
+void cluster_close(Cluster *cluster) {
+    if (!cluster) {
+        return;
+    }
+    int status;
+    for (int i = 0; i < cluster->count; ++i) {
+        Replica *replica = &cluster->replicas[i];
+        if (replica->pid > 0 && replica->state != REPLICA_STOPPING && replica->state != REPLICA_KILLING) {
+            process_stop(replica->pid);
+            set_state(replica, REPLICA_STOPPING);
+        }
+    }
+
+    printf("[Cluster] Stopping %d replicas...\n", cluster->count);
+    uint64_t deadline = watcher_clock_ms() + CLUSTER_STOP_TIMEOUT_MS;
+    for (;;) {
+        int alive = 0;
+        for (int i = 0; i < cluster->count; ++i) {
+            Replica *replica = &cluster->replicas[i];
+            if (replica->pid > 0 && process_check_status(replica->pid, &status) == replica->pid) {
+                replica->pid = 0;
+            }
+            alive += replica->pid > 0;
+        }
+        if (alive == 0 || watcher_clock_ms() >= deadline) {
+            break;
+        }
+        #ifdef _WIN32
+        Sleep(20);
+        #else
+        usleep(20000);
+        #endif
+    }
+
+    for (int i = 0; i < cluster->count; ++i) {
+        Replica *replica = &cluster->replicas[i];
+        if (replica->pid > 0) {
+            process_kill(replica->pid);
+            #ifndef _WIN32
+            waitpid(replica->pid, NULL, 0);
+            #endif
+        }
+        #ifndef _WIN32
+        if (replica->notify_fd >= 0) {
+            close(replica->notify_fd);
+            unlink(replica->notify_path);
+        }
+        #endif
+    }
+    #ifndef _WIN32
+    if (cluster->notify_dir[0]) {
+        rmdir(cluster->notify_dir);
+    }
+    #endif
+    free(cluster->replicas);
+    free(cluster);
+}
+
+void cluster_on_change(Cluster *cluster) {
+    cluster->generation++;
+}
+
+void cluster_tick(Cluster *cluster) {
+    uint64_t now = watcher_clock_ms();
+    uint64_t ready_timeout = (uint64_t)cluster->watcher->options->ready_timeout_ms;
+
+    for (int i = 0; i < cluster->count; ++i) {
+        Replica *replica = &cluster->replicas[i];
+        int status;
+        int exited = replica->pid > 0 && process_check_status(replica->pid, &status) == replica->pid;
+        if (exited) {
+            replica->pid = 0;
+        }
+
+        switch (replica->state) {
+            case REPLICA_STARTING:
+            case REPLICA_READY:
+                if (exited) {
+                    printf("[Cluster] Replica %d/%d died unexpectedly\n", i + 1, cluster->count);
+                    replica->crashes++;
+                    restart_replica(cluster, i);
+                } else if (replica->state == REPLICA_STARTING) {
+                    int notified = read_notifications(replica);
+                    if (notified || now - replica->since_ms >= ready_timeout) {
+                        mark_ready(cluster, i, notified);
+                    }
+                } else {
+                    read_notifications(replica); // RELOADING=1, STATUS=... are not used
+                }
+                break;
+
+            case REPLICA_STOPPING:
+                if (exited) {
+                    restart_replica(cluster, i);
+                } else if (now - replica->since_ms >= CLUSTER_STOP_TIMEOUT_MS) {
+                    printf("[Cluster] Replica %d/%d did not respond to SIGTERM, sending SIGKILL...\n", i + 1, cluster->count);
+                    process_kill(replica->pid);
+                    set_state(replica, REPLICA_KILLING);
+                }
+                break;
+
+            case REPLICA_KILLING:
+                if (exited) {
+                    restart_replica(cluster, i);
+                }
+                break;
+
+            case REPLICA_DOWN:
+                if (now - replica->since_ms >= CLUSTER_RETRY_MS) {
+                    spawn_replica(cluster, i);
+                }
+                break;
+        }
+    }
+
+    // Roll one replica at a time, and only while every other one is serving
+    if (serving(cluster) < cluster->count) {
+        return;
+    }
+    for (int i = 0; i < cluster->count; ++i) {
+        Replica *replica = &cluster->replicas[i];
+        if (replica->generation != cluster->generation) {
+            printf("[Cluster] Rolling replica %d/%d [PID: %lld], %d/%d keep serving\n", i + 1, cluster->count,
+                   (long long)replica->pid, cluster->count - 1, cluster->count);
+            trace_instant(cluster->watcher->trace, TRACE_APP, "Replica stopping", NULL);
+            process_stop(replica->pid);
+            set_state(replica, REPLICA_STOPPING);
+            break;
+        }
+    }
+}
+
+void cluster_print_stats(const Cluster *cluster) {
+    printf("[Watcher stats] cluster: %d/%d replicas serving, code generation %lu\n",
+           serving(cluster), cluster->count, cluster->generation);
+    for (int i = 0; i < cluster->count; ++i) {
+        const Replica *replica = &cluster->replicas[i];
+        printf("[Watcher stats] replica %d: PID %lld, %s%s, %lu restarts (%lu crashes), last ready in %llu ms\n",
+               i + 1, (long long)replica->pid, REPLICA_STATE_NAMES[replica->state],
+               replica->generation != cluster->generation ? " (outdated)" : "",
+               replica->restarts, replica->crashes, (unsigned long long)replica->ready_after_ms);
+    }
+}
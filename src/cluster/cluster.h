@@ -0,0 +1,40 @@
+/*
+    Copyright © 2025 Mint teams
+    cluster.h
+    The generic Node.js process watcher
+*/
+
+#ifndef CLUSTER_H
+#define CLUSTER_H
+
+#include <watcher/watcher.h>
+
+/*
+    Cluster mode (--replicas N). Runs N copies of <command>, each in its
+    own process group with KAVIN_REPLICA=<index> set, all sharing the
+    --listen sockets if any (or binding with SO_REUSEPORT themselves).
+
+    A change starts a rolling restart: one replica at a time is stopped
+    and started again, and the next one only goes once the new process is
+    ready, so N-1 replicas keep serving throughout. A replica is ready
+    when it sends READY=1 to $NOTIFY_SOCKET (sd_notify), or after
+    --ready-timeout if it never does. Replicas that die on their own are
+    started again right away.
+*/
+typedef struct Cluster Cluster;
+
+// Starts every replica; NULL if none could be set up.
+Cluster *cluster_open(Watcher *watcher);
+
+// Stops all replicas (SIGTERM, then SIGKILL after 2s) and waits for them.
+void cluster_close(Cluster *cluster);
+
+// The code changed: every replica gets rolled onto it.
+void cluster_on_change(Cluster *cluster);
+
+// Reaps, checks readiness and advances the roll; call once per watcher tick.
+void cluster_tick(Cluster *cluster);
+
+void cluster_print_stats(const Cluster *cluster);
+
+#endif // CLUSTER_H
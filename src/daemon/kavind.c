@@ -0,0 +1,515 @@
+/*
+    Copyright © 2025 Mint teams
+    kavind.c
+    The generic Node.js process watcher
+*/
+
+#ifndef _GNU_SOURCE
+#define _GNU_SOURCE // accept4()
+#endif
+
+#include <errno.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+
+#include <daemon/kavind.h>
+
+#if defined(__linux__)
+#include <fcntl.h>
+#include <limits.h>
+#include <poll.h>
+#include <signal.h>
+#include <unistd.h>
+#include <sys/inotify.h>
+#include <sys/socket.h>
+#include <sys/stat.h>
+#include <sys/un.h>
+
+#include <watcher/watcher.h>
+
+// Same event set as the fanotify backend: saves end in a close, rename or attribute change.
+#define KAVIND_MASK (IN_CLOSE_WRITE | IN_ATTRIB | IN_CREATE | IN_DELETE | IN_MOVED_FROM | IN_MOVED_TO)
+
+// Events that arrive within this window go out as one batch.
+#define KAVIND_COALESCE_MS 20
+#define KAVIND_PENDING_MAX 4096
+#define KAVIND_MAX_CLIENTS 256
+
+typedef struct {
+    char *path;
+    int wd;
+    int refs;           // Client registrations; the watch goes at zero
+} DaemonDir;
+
+typedef struct {
+    long id;            // The client's id for the directory
+    int dir;            // Index into dirs
+} DaemonReg;
+
+typedef struct {
+    int fd;
+    char in[KAVIND_LINE_MAX];
+    size_t in_len;
+    DaemonReg *regs;
+    int reg_count;
+    int overflowed;     // A batch was dropped; owes the client an OVERFLOW
+    char out[KAVIND_LINE_MAX];
+    size_t out_len;     // Rest of a line the socket took only part of
+} DaemonClient;
+
+typedef struct {
+    int dir;
+    char name[NAME_MAX + 1];
+} PendingEvent;
+
+typedef struct {
+    int listen_fd;
+    int inotify_fd;
+    DaemonDir *dirs;
+    int dir_count;
+    DaemonClient clients[KAVIND_MAX_CLIENTS];
+    int client_count;
+    PendingEvent *pending;
+    int pending_count;
+    int pending_overflow;
+    uint64_t batch_deadline;   // 0 = nothing pending
+    unsigned long batches;
+    unsigned long wakeups;
+} Daemon;
+
+static volatile sig_atomic_t g_daemon_running = 1;
+
+static void daemon_signal_handler(int signum) {
+    (void)signum;
+    g_daemon_running = 0;
+}
+
+int kavind_socket_path(char *buffer, size_t size) {
+    const char *runtime = getenv("XDG_RUNTIME_DIR");
+    int n = runtime && *runtime ? snprintf(buffer, size, "%s/kavind.sock", runtime)
+                                : snprintf(buffer, size, "/tmp/kavind-%u.sock", (unsigned)getuid());
+    return n > 0 && (size_t)n < size ? 0 : -1;
+}
+
+int kavind_peer_is_self(int fd) {
+    struct ucred cred;
+    socklen_t len = sizeof(cred);
+    return getsockopt(fd, SOL_SOCKET, SO_PEERCRED, &cred, &len) == 0 && len == sizeof(cred) &&
+           cred.uid == getuid();
+}
+
+static int daemon_listen(const char *path) {
+    struct sockaddr_un addr;
+    memset(&addr, 0, sizeof(addr));
+    addr.sun_family = AF_UNIX;
+    if (strlen(path) >= sizeof(addr.sun_path)) {
+        errno = ENAMETOOLONG;
+        return -1;
+    }
+    strcpy(addr.sun_path, path);
+
+    int fd = socket(AF_UNIX, SOCK_STREAM | SOCK_CLOEXEC | SOCK_NONBLOCK, 0);
+    if (fd < 0) {
+        return -1;
+    }
+    mode_t old_umask = umask(077);
+    int rc = bind(fd, (struct sockaddr *)&addr, sizeof(addr));
+    if (rc != 0 && errno == EADDRINUSE) {
+        // A live daemon answers; a stale socket file from a crash doesn't.
+        int probe = socket(AF_UNIX, SOCK_STREAM | SOCK_CLOEXEC, 0);
+        int alive = probe >= 0 && connect(probe, (struct sockaddr *)&addr, sizeof(addr)) == 0;
+        int ours = alive && kavind_peer_is_self(probe);
+        if (probe >= 0) {
+            close(probe);
+        }
+        if (!alive) {
+            unlink(path);
+            rc = bind(fd, (struct sockaddr *)&addr, sizeof(addr));
+        } else {
+            errno = ours ? EADDRINUSE : EACCES;
+        }
+    }
+    umask(old_umask);
+    if (rc != 0 || listen(fd, SOMAXCONN) != 0) {
+        int saved = errno;
+        close(fd);
+        errno = saved;
+        return -1;
+    }
+    return fd;
+}
+
+static int acquire_dir(Daemon *d, const char *path) {
+    for (int i = 0; i < d->dir_count; ++i) {
+        if (d->dirs[i].refs > 0 && strcmp(d->dirs[i].path, path) == 0) {
+            d->dirs[i].refs++;
+            return i;
+        }
+    }
+
+    int wd = inotify_add_watch(d->inotify_fd, path, KAVIND_MASK | IN_ONLYDIR);
+    if (wd < 0) {
+        return -1;
+    }
+    // The kernel hands back the same wd for a path already watched
+    for (int i = 0; i < d->dir_count; ++i) {
+        if (d->dirs[i].refs > 0 && d->dirs[i].wd == wd) {
+            d->dirs[i].refs++;
+            return i;
+        }
+    }
+
+    int slot = -1;
+    for (int i = 0; i < d->dir_count && slot < 0; ++i) {
+        if (d->dirs[i].refs == 0) {
+            slot = i;
+        }
+    }
+    if (slot < 0) {
+        DaemonDir *dirs = realloc(d->dirs, sizeof(DaemonDir) * (d->dir_count + 1));
+        if (!dirs) {
+            inotify_rm_watch(d->inotify_fd, wd);
+            return -1;
+        }
+        d->dirs = dirs;
+        slot = d->dir_count++;
+    } else {
+        free(d->dirs[slot].path);
+    }
+    d->dirs[slot].path = strdup(path);
+    d->dirs[slot].wd = wd;
+    d->dirs[slot].refs = 1;
+    return slot;
+}
+
+static void release_dir(Daemon *d, int dir) {
+    if (--d->dirs[dir].refs == 0) {
+        inotify_rm_watch(d->inotify_fd, d->dirs[dir].wd);
+        d->dirs[dir].wd = -1;
+    }
+}
+
+static int active_dirs(const Daemon *d) {
+    int count = 0;
+    for (int i = 0; i < d->dir_count; ++i) {
+        count += d->dirs[i].refs > 0;
+    }
+    return count;
+}
+
+static int flush_out(DaemonClient *client) {
+    while (client->out_len > 0) {
+        ssize_t n = send(client->fd, client->out, client->out_len, MSG_NOSIGNAL | MSG_DONTWAIT);
+        if (n <= 0) {
+            return -1;
+        }
+        client->out_len -= (size_t)n;
+        memmove(client->out, client->out + n, client->out_len);
+    }
+    return 0;
+}
+
+/*
+    Best-effort write. A client that can't keep up loses the batch and
+    gets an OVERFLOW later, which makes it rescan; kavind never blocks
+    on a slow client. A line the socket took only part of is finished
+    first, so the stream stays whole lines and the OVERFLOW parses.
+*/
+static int client_send(DaemonClient *client, const char *data, size_t len) {
+    if (flush_out(client) != 0) {
+        client->overflowed = 1;
+        return -1;
+    }
+    ssize_t n = send(client->fd, data, len, MSG_NOSIGNAL | MSG_DONTWAIT);
+    if (n == (ssize_t)len) {
+        return 0;
+    }
+    if (n > 0) {
+        client->out_len = len - (size_t)n;
+        memcpy(client->out, data + n, client->out_len);
+    }
+    client->overflowed = 1;
+    return -1;
+}
+
+// The socket has room again: finish the cut line and send the OVERFLOW owed.
+static void client_catch_up(DaemonClient *client) {
+    if (client->overflowed && client_send(client, "OVERFLOW\n", 9) == 0) {
+        client->overflowed = 0;
+    }
+}
+
+static void drop_client(Daemon *d, int index) {
+    DaemonClient *client = &d->clients[index];
+    for (int i = 0; i < client->reg_count; ++i) {
+        release_dir(d, client->regs[i].dir);
+    }
+    free(client->regs);
+    close(client->fd);
+    d->clients[index] = d->clients[--d->client_count];
+    printf("[kavind] Client left, %d connected, %d directories watched\n", d->client_count, active_dirs(d));
+}
+
+static void handle_line(Daemon *d, DaemonClient *client, char *line) {
+    char reply[64];
+    if (strncmp(line, "WATCH ", 6) == 0) {
+        char *path;
+        long id = strtol(line + 6, &path, 10);
+        if (*path != ' ' || path[1] != '/') {
+            return;
+        }
+        path++;
+
+        DaemonReg *regs = realloc(client->regs, sizeof(DaemonReg) * (client->reg_count + 1));
+        int dir = regs ? acquire_dir(d, path) : -1;
+        if (regs) {
+            client->regs = regs;
+        }
+        if (dir < 0) {
+            int n = snprintf(reply, sizeof(reply), "ERR %ld\n", id);
+            client_send(client, reply, (size_t)n);
+            return;
+        }
+        client->regs[client->reg_count].id = id;
+        client->regs[client->reg_count].dir = dir;
+        client->reg_count++;
+    } else if (strcmp(line, "SYNC") == 0) {
+        int n = snprintf(reply, sizeof(reply), "SYNCED %d\n", client->reg_count);
+        client_send(client, reply, (size_t)n);
+        printf("[kavind] Client registered %d directories, %d connected, %d directories watched\n",
+               client->reg_count, d->client_count, active_dirs(d));
+    }
+}
+
+// Returns -1 when the client hung up.
+static int read_client(Daemon *d, DaemonClient *client) {
+    for (;;) {
+        ssize_t n = recv(client->fd, client->in + client->in_len, sizeof(client->in) - client->in_len - 1,
+                         MSG_DONTWAIT);
+        if (n == 0 || (n < 0 && errno != EAGAIN && errno != EINTR)) {
+            return -1;
+        }
+        if (n < 0) {
+            return 0;
+        }
+        client->in_len += (size_t)n;
+        client->in[client->in_len] = '\0';
+
+        char *start = client->in;
+        char *newline;
+        while ((newline = strchr(start, '\n')) != NULL) {
+            *newline = '\0';
+            handle_line(d, client, start);
+            start = newline + 1;
+        }
+        client->in_len -= (size_t)(start - client->in);
+        memmove(client->in, start, client->in_len);
+        if (client->in_len == sizeof(client->in) - 1) {
+            return -1; // Line too long: not a kavin client
+        }
+    }
+}
+
+static void queue_event(Daemon *d, int dir, const char *name) {
+    for (int i = 0; i < d->pending_count; ++i) {
+        if (d->pending[i].dir == dir && strcmp(d->pending[i].name, name) == 0) {
+            return; // Coalesced with an event already in this batch
+        }
+    }
+    if (d->pending_count == KAVIND_PENDING_MAX) {
+        d->pending_overflow = 1;
+        return;
+    }
+    d->pending[d->pending_count].dir = dir;
+    snprintf(d->pending[d->pending_count].name, sizeof(d->pending[0].name), "%s", name);
+    d->pending_count++;
+}
+
+static void read_inotify(Daemon *d) {
+    char buffer[16384] __attribute__((aligned(__alignof__(struct inotify_event))));
+    ssize_t len;
+    while ((len = read(d->inotify_fd, buffer, sizeof(buffer))) > 0) {
+        for (char *p = buffer; p < buffer + len;) {
+            struct inotify_event *event = (struct inotify_event *)p;
+            p += sizeof(struct inotify_event) + event->len;
+
+            if (event->mask & IN_Q_OVERFLOW) {
+                d->pending_overflow = 1;
+                continue;
+            }
+            if (event->len == 0) {
+                continue; // IN_IGNORED and events on the directory itself
+            }
+            for (int i = 0; i < d->dir_count; ++i) {
+                if (d->dirs[i].refs > 0 && d->dirs[i].wd == event->wd) {
+                    queue_event(d, i, event->name);
+                    break;
+                }
+            }
+        }
+    }
+    if (d->batch_deadline == 0 && (d->pending_count > 0 || d->pending_overflow)) {
+        d->batch_deadline = watcher_clock_ms() + KAVIND_COALESCE_MS;
+    }
+}
+
+static void flush_batch(Daemon *d) {
+    char line[KAVIND_LINE_MAX];
+    for (int c = 0; c < d->client_count; ++c) {
+        DaemonClient *client = &d->clients[c];
+        client_catch_up(client);
+        if (d->pending_overflow) {
+            client_send(client, "OVERFLOW\n", 9);
+            continue;
+        }
+        for (int e = 0; e < d->pending_count && !client->overflowed; ++e) {
+            for (int r = 0; r < client->reg_count && !client->overflowed; ++r) {
+                if (client->regs[r].dir == d->pending[e].dir) {
+                    int n = snprintf(line, sizeof(line), "EVENT %ld %s\n", client->regs[r].id, d->pending[e].name);
+                    client_send(client, line, (size_t)n);
+                }
+            }
+        }
+    }
+    d->pending_count = 0;
+    d->pending_overflow = 0;
+    d->batch_deadline = 0;
+    d->batches++;
+}
+
+int kavind_run(const KavinOptions *options) {
+    char path[PATH_MAX];
+    if (kavind_socket_path(path, sizeof(path)) != 0) {
+        fprintf(stderr, "[kavind] Socket path too long\n");
+        return 1;
+    }
+
+    Daemon d;
+    memset(&d, 0, sizeof(d));
+    d.listen_fd = daemon_listen(path);
+    if (d.listen_fd < 0) {
+        if (errno == EADDRINUSE) {
+            printf("[kavind] Already running on %s\n", path);
+            return 0;
+        }
+        if (errno == EACCES) {
+            fprintf(stderr, "[kavind] %s is served by another user, refusing to run\n", path);
+            return 1;
+        }
+        perror("[kavind] Cannot listen");
+        return 1;
+    }
+    d.inotify_fd = inotify_init1(IN_NONBLOCK | IN_CLOEXEC);
+    d.pending = malloc(sizeof(PendingEvent) * KAVIND_PENDING_MAX);
+    if (d.inotify_fd < 0 || !d.pending) {
+        perror("[kavind] inotify unavailable");
+        unlink(path);
+        return 1;
+    }
+
+    signal(SIGINT, daemon_signal_handler);
+    signal(SIGTERM, daemon_signal_handler);
+    signal(SIGPIPE, SIG_IGN);
+    printf("[kavind] Listening on %s, exits after %ds without clients\n", path, options->daemon_idle);
+    fflush(stdout);
+
+    uint64_t idle_since = watcher_clock_ms();
+    while (g_daemon_running) {
+        struct pollfd fds[KAVIND_MAX_CLIENTS + 2];
+        fds[0].fd = d.listen_fd;
+        fds[0].events = POLLIN;
+        fds[1].fd = d.inotify_fd;
+        fds[1].events = POLLIN;
+        for (int c = 0; c < d.client_count; ++c) {
+            fds[c + 2].fd = d.clients[c].fd;
+            fds[c + 2].events = POLLIN | (d.clients[c].overflowed ? POLLOUT : 0);
+        }
+
+        uint64_t now = watcher_clock_ms();
+        int timeout = -1;
+        if (d.batch_deadline) {
+            timeout = d.batch_deadline > now ? (int)(d.batch_deadline - now) : 0;
+        } else if (d.client_count == 0) {
+            uint64_t idle_end = idle_since + (uint64_t)options->daemon_idle * 1000;
+            timeout = idle_end > now ? (int)(idle_end - now) : 0;
+        }
+
+        int ready = poll(fds, (nfds_t)(d.client_count + 2), timeout);
+        if (ready < 0 && errno != EINTR) {
+            perror("[kavind] poll");
+            break;
+        }
+        d.wakeups++;
+
+        if (ready > 0 && (fds[1].revents & POLLIN)) {
+            read_inotify(&d);
+        }
+        // Back to front, so dropping a client doesn't skip one
+        for (int c = d.client_count - 1; ready > 0 && c >= 0; --c) {
+            if (fds[c + 2].revents & POLLOUT) {
+                client_catch_up(&d.clients[c]);
+            }
+            if (fds[c + 2].revents && read_client(&d, &d.clients[c]) != 0) {
+                drop_client(&d, c);
+                if (d.client_count == 0) {
+                    idle_since = watcher_clock_ms();
+                }
+            }
+        }
+        if (ready > 0 && (fds[0].revents & POLLIN)) {
+            int fd;
+            while ((fd = accept4(d.listen_fd, NULL, NULL, SOCK_CLOEXEC | SOCK_NONBLOCK)) >= 0) {
+                if (d.client_count == KAVIND_MAX_CLIENTS || !kavind_peer_is_self(fd)) {
+                    close(fd);
+                    continue;
+                }
+                memset(&d.clients[d.client_count], 0, sizeof(DaemonClient));
+                d.clients[d.client_count++].fd = fd;
+            }
+        }
+
+        now = watcher_clock_ms();
+        if (d.batch_deadline && now >= d.batch_deadline) {
+            flush_batch(&d);
+        }
+        if (d.client_count == 0 && now - idle_since >= (uint64_t)options->daemon_idle * 1000) {
+            printf("[kavind] Idle for %ds, exiting\n", options->daemon_idle);
+            break;
+        }
+        fflush(stdout);
+    }
+
+    printf("[kavind] %lu batches sent, %lu wakeups\n", d.batches, d.wakeups);
+    while (d.client_count > 0) {
+        drop_client(&d, d.client_count - 1);
+    }
+    for (int i = 0; i < d.dir_count; ++i) {
+        free(d.dirs[i].path);
+    }
+    free(d.dirs);
+    free(d.pending);
+    close(d.inotify_fd);
+    close(d.listen_fd);
+    unlink(path);
+    return 0;
+}
+
+#else // kavind needs inotify and Unix sockets
+
+int kavind_socket_path(char *buffer, size_t size) {
+    (void)buffer; (void)size;
+    return -1;
+}
+
+int kavind_peer_is_self(int fd) {
+    (void)fd;
+    return 0;
+}
+
+int kavind_run(const KavinOptions *options) {
+    (void)options;
+    fprintf(stderr, "[kavind] The shared daemon is only available on Linux\n");
+    return 1;
+}
+#endif
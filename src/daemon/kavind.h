@@ -0,0 +1,45 @@
+/*
+    Copyright © 2025 Mint teams
+    kavind.h
+    The generic Node.js process watcher
+*/
+
+#ifndef KAVIND_H
+#define KAVIND_H
+
+#include <stddef.h>
+
+#include <options/options.h>
+
+/*
+    Per-user watch daemon (kavin --daemon). It owns one inotify instance
+    and one reference-counted watch per unique directory. kavin clients
+    started with --backend shared register their directories over a Unix
+    socket and get coalesced events back, so watches and wakeups scale
+    with distinct directories instead of with instances. The daemon exits
+    once it has had no clients for --daemon-idle seconds.
+
+    Protocol, one line per message:
+      client -> kavind   WATCH <id> <absolute dir>   register a directory
+                         SYNC                        end of registrations
+      kavind -> client   ERR <id>                    that directory failed
+                         SYNCED <count>              registrations accepted
+                         EVENT <id> <name>           entry changed in dir <id>
+                         OVERFLOW                    events were lost, rescan
+*/
+#define KAVIND_LINE_MAX 4352
+
+// $XDG_RUNTIME_DIR/kavind.sock, or /tmp/kavind-<uid>.sock
+int kavind_socket_path(char *buffer, size_t size);
+
+/*
+    1 when the other end of a connected kavind socket runs as our own
+    user. The /tmp path is predictable: another user could bind it first
+    and read every watched path, or feed us events.
+*/
+int kavind_peer_is_self(int fd);
+
+// Runs the daemon in the foreground; returns the exit code.
+int kavind_run(const KavinOptions *options);
+
+#endif // KAVIND_H
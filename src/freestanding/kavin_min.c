@@ -0,0 +1,412 @@
+/*
+    Copyright © 2025 Mint teams
+    kavin_min.c
+    The generic Node.js process watcher
+*/
+
+/*
+    Libc-free build of the supervisor (make min -> dist/kavin-min).
+    Linux x86-64 only. It talks to the kernel through the wrappers in
+    arch/syscalls.asm and starts at _start in start.asm, so there is no
+    dynamic loader, stdio or malloc to pay for at startup.
+
+    Feature set is the core of kavin: restart <command> when a watched
+    file, or a file directly inside a watched directory, changes. It uses
+    inotify for change events, a signalfd for SIGCHLD, SIGINT and SIGTERM,
+    and one epoll loop for both. Options, other backends and the stats
+    signal are left to the full build.
+*/
+
+#include <stddef.h>
+#include <stdint.h>
+#include <time.h>
+#include <sys/types.h>
+
+#include <arch/syscalls.h>
+
+// Kernel ABI constants, spelled out to stay clear of libc headers
+#define KMIN_SIGINT 2
+#define KMIN_SIGKILL 9
+#define KMIN_SIGTERM 15
+#define KMIN_SIGCHLD 17
+#define KMIN_SIG_BLOCK 0
+#define KMIN_SIG_SETMASK 2
+#define KMIN_O_NONBLOCK 04000
+#define KMIN_O_CLOEXEC 02000000
+#define KMIN_WNOHANG 1
+#define KMIN_CLOCK_MONOTONIC 1
+#define KMIN_ENOTDIR 20
+#define KMIN_EINTR 4
+
+#define KMIN_IN_ATTRIB 0x00000004
+#define KMIN_IN_CLOSE_WRITE 0x00000008
+#define KMIN_IN_MOVED_FROM 0x00000040
+#define KMIN_IN_MOVED_TO 0x00000080
+#define KMIN_IN_DELETE 0x00000200
+#define KMIN_IN_Q_OVERFLOW 0x00004000
+#define KMIN_IN_ONLYDIR 0x01000000
+#define KMIN_IN_ISDIR 0x40000000
+#define KMIN_WATCH_MASK (KMIN_IN_ATTRIB | KMIN_IN_CLOSE_WRITE | KMIN_IN_MOVED_FROM | \
+                         KMIN_IN_MOVED_TO | KMIN_IN_DELETE)
+
+#define KMIN_EPOLLIN 0x001
+#define KMIN_EPOLL_CTL_ADD 1
+
+#define KMIN_MAX_WATCHES 256
+#define KMIN_PARENT_ARENA 16384
+#define KMIN_GRACE_MS 2000
+#define KMIN_RESPAWN_DELAY_MS 100
+
+typedef struct __attribute__((packed)) {
+    uint32_t events;
+    uint64_t data;
+} EpollEvent;
+
+typedef struct {
+    int32_t wd;
+    uint32_t mask;
+    uint32_t cookie;
+    uint32_t len;
+    char name[];
+} InotifyEvent;
+
+typedef struct {
+    int wd;
+    const char *dir;   // Watched directory, as given or derived from the file
+    const char *name;  // Basename of an explicit file, NULL for a directory
+    const char *path;  // The argument this watch came from
+} MinWatch;
+
+typedef enum {
+    MIN_RUNNING,
+    MIN_STOPPING,  // SIGTERM sent, waiting for the child to exit
+    MIN_KILLING    // SIGKILL sent
+} MinState;
+
+static MinWatch g_watches[KMIN_MAX_WATCHES];
+static int g_watch_count;
+static char g_parent_arena[KMIN_PARENT_ARENA];
+static size_t g_parent_used;
+
+// gcc may emit calls to these even with -ffreestanding
+void *memset(void *dst, int c, size_t n) {
+    unsigned char *d = dst;
+    while (n--) {
+        *d++ = (unsigned char)c;
+    }
+    return dst;
+}
+
+void *memcpy(void *dst, const void *src, size_t n) {
+    unsigned char *d = dst;
+    const unsigned char *s = src;
+    while (n--) {
+        *d++ = *s++;
+    }
+    return dst;
+}
+
+static size_t str_len(const char *s) {
+    size_t n = 0;
+    while (s[n]) {
+        n++;
+    }
+    return n;
+}
+
+static int str_eq(const char *a, const char *b) {
+    while (*a && *a == *b) {
+        a++;
+        b++;
+    }
+    return *a == *b;
+}
+
+static void out_fd(int fd, const char *s) {
+    sys_write_asm(fd, s, str_len(s));
+}
+
+static void out(const char *s) {
+    out_fd(1, s);
+}
+
+static void out_num(long value) {
+    char buf[24];
+    int i = sizeof(buf);
+    unsigned long v = value < 0 ? -(unsigned long)value : (unsigned long)value;
+    buf[--i] = '\0';
+    do {
+        buf[--i] = (char)('0' + v % 10);
+        v /= 10;
+    } while (v);
+    if (value < 0) {
+        buf[--i] = '-';
+    }
+    out(buf + i);
+}
+
+static uint64_t now_ms(void) {
+    struct timespec ts;
+    sys_clock_gettime_asm(KMIN_CLOCK_MONOTONIC, &ts);
+    return (uint64_t)ts.tv_sec * 1000 + (uint64_t)ts.tv_nsec / 1000000;
+}
+
+static void sleep_ms(long ms) {
+    struct timespec ts = { ms / 1000, (ms % 1000) * 1000000 };
+    while (sys_nanosleep_asm(&ts, &ts) == -KMIN_EINTR) {
+    }
+}
+
+// Splits `path` into a copied directory part ("." when there is none) and a basename.
+static const char *split_parent(const char *path, const char **name) {
+    size_t slash = str_len(path);
+    while (slash > 0 && path[slash - 1] != '/') {
+        slash--;
+    }
+    *name = path + slash;
+
+    const char *src = slash == 0 ? "." : path;
+    size_t dir_len = slash == 0 ? 1 : (slash == 1 ? 1 : slash - 1); // Keep "/" for files under root
+    if (g_parent_used + dir_len + 1 > KMIN_PARENT_ARENA) {
+        return NULL;
+    }
+    char *dir = g_parent_arena + g_parent_used;
+    memcpy(dir, src, dir_len);
+    dir[dir_len] = '\0';
+    g_parent_used += dir_len + 1;
+    return dir;
+}
+
+static int add_watch(int inotify_fd, const char *path) {
+    if (g_watch_count == KMIN_MAX_WATCHES) {
+        out_fd(2, "[Watcher warning] Too many paths, ignoring: ");
+        out_fd(2, path);
+        out_fd(2, "\n");
+        return -1;
+    }
+
+    MinWatch *watch = &g_watches[g_watch_count];
+    watch->path = path;
+    long wd = sys_inotify_add_watch_asm(inotify_fd, path, KMIN_WATCH_MASK | KMIN_IN_ONLYDIR);
+    if (wd >= 0) {
+        watch->dir = path;
+        watch->name = NULL;
+    } else if (wd == -KMIN_ENOTDIR) {
+        // Editors often save by renaming over the file, which drops a watch
+        // on the file itself, so watch the parent and match the name.
+        watch->dir = split_parent(path, &watch->name);
+        wd = watch->dir ? sys_inotify_add_watch_asm(inotify_fd, watch->dir, KMIN_WATCH_MASK) : -1;
+    }
+
+    if (wd < 0) {
+        out_fd(2, "[Watcher warning] Path not found and will be ignored: ");
+        out_fd(2, path);
+        out_fd(2, "\n");
+        return -1;
+    }
+    watch->wd = (int)wd;
+    g_watch_count++;
+    out(watch->name ? "[Watcher info] Watching: " : "[Watcher info] Watching directory: ");
+    out(path);
+    out("\n");
+    return 0;
+}
+
+/*
+    Drains the inotify queue. Returns 1 and prints the first hit when a
+    watched file changed; events are still read to the end so a save
+    burst doesn't trigger a second restart.
+*/
+static int drain_events(int inotify_fd, int report) {
+    char buffer[4096] __attribute__((aligned(__alignof__(InotifyEvent))));
+    int changed = 0;
+
+    for (;;) {
+        long len = sys_read_asm(inotify_fd, buffer, sizeof(buffer));
+        if (len <= 0) {
+            return changed; // -EAGAIN: queue drained
+        }
+
+        for (long offset = 0; offset < len;) {
+            InotifyEvent *event = (InotifyEvent *)(buffer + offset);
+            offset += (long)sizeof(InotifyEvent) + event->len;
+
+            if (event->mask & KMIN_IN_Q_OVERFLOW) {
+                changed = 1; // Lost events; assume the worst
+                continue;
+            }
+            if ((event->mask & KMIN_IN_ISDIR) || event->len == 0) {
+                continue;
+            }
+
+            for (int i = 0; i < g_watch_count && !changed; ++i) {
+                MinWatch *watch = &g_watches[i];
+                if (watch->wd != event->wd || (watch->name && !str_eq(watch->name, event->name))) {
+                    continue;
+                }
+                if (report) {
+                    out((event->mask & (KMIN_IN_DELETE | KMIN_IN_MOVED_FROM)) ?
+                        "[Watcher info] File deleted: " : "[Watcher info] Change detected in ");
+                    if (watch->name) {
+                        out(watch->path);
+                    } else {
+                        out(watch->dir);
+                        out("/");
+                        out(event->name);
+                    }
+                    out("! Restarting...\n");
+                }
+                changed = 1;
+            }
+        }
+    }
+}
+
+static long start_child(const char *command, char **envp, const unsigned long *child_mask) {
+    out("[Watcher info] Starting application\n");
+
+    long pid = sys_fork_asm();
+    if (pid == 0) {
+        char *argv[] = { "sh", "-c", (char *)command, NULL };
+        sys_setpgid_asm(0, 0);
+        sys_rt_sigprocmask_asm(KMIN_SIG_SETMASK, child_mask, NULL, sizeof(*child_mask));
+        sys_execve_asm("/bin/sh", argv, envp);
+        out_fd(2, "execve failed\n");
+        sys_exit_group_asm(127);
+    }
+    if (pid < 0) {
+        out_fd(2, "[Watcher error] Failed to start process\n");
+        return 0;
+    }
+
+    out("[Watcher info] Started [PID: ");
+    out_num(pid);
+    out("]\n");
+    return pid;
+}
+
+// Reaps every exited child; returns 1 when `pid` was among them.
+static int reap(long pid) {
+    int found = 0;
+    int status;
+    long done;
+    while ((done = sys_wait4_asm(-1, &status, KMIN_WNOHANG, NULL)) > 0) {
+        found |= done == pid;
+    }
+    return found;
+}
+
+int kavin_min_main(long *stack) {
+    int argc = (int)stack[0];
+    char **argv = (char **)(stack + 1);
+    char **envp = argv + argc + 1;
+
+    if (argc < 3) {
+        out_fd(2, "Usage: ");
+        out_fd(2, argv[0]);
+        out_fd(2, " <command> <file1> [file2] ...\n");
+        return 1;
+    }
+    const char *command = argv[1];
+
+    // Signals arrive on a signalfd instead of async handlers
+    unsigned long mask = (1UL << (KMIN_SIGINT - 1)) | (1UL << (KMIN_SIGTERM - 1)) | (1UL << (KMIN_SIGCHLD - 1));
+    unsigned long old_mask = 0;
+    sys_rt_sigprocmask_asm(KMIN_SIG_BLOCK, &mask, &old_mask, sizeof(mask));
+    int signal_fd = (int)sys_signalfd4_asm(-1, &mask, sizeof(mask), KMIN_O_NONBLOCK | KMIN_O_CLOEXEC);
+    int inotify_fd = (int)sys_inotify_init1_asm(KMIN_O_NONBLOCK | KMIN_O_CLOEXEC);
+    int epoll_fd = (int)sys_epoll_create1_asm(KMIN_O_CLOEXEC);
+    if (signal_fd < 0 || inotify_fd < 0 || epoll_fd < 0) {
+        out_fd(2, "[Watcher error] signalfd, inotify or epoll unavailable\n");
+        return 1;
+    }
+
+    out("\033[2J\033[H");
+    for (int i = 2; i < argc; ++i) {
+        add_watch(inotify_fd, argv[i]);
+    }
+    out("[Watcher info] Command: ");
+    out(command);
+    out("\n");
+
+    EpollEvent ev = { KMIN_EPOLLIN, 0 };
+    sys_epoll_ctl_asm(epoll_fd, KMIN_EPOLL_CTL_ADD, inotify_fd, &ev);
+    ev.data = 1;
+    sys_epoll_ctl_asm(epoll_fd, KMIN_EPOLL_CTL_ADD, signal_fd, &ev);
+
+    long pid = start_child(command, envp, &old_mask);
+    MinState state = MIN_RUNNING;
+    uint64_t deadline = 0;
+    unsigned long restarts = 0;
+    int running = 1;
+
+    while (running || pid > 0) {
+        int timeout = -1;
+        if (state == MIN_STOPPING) {
+            uint64_t now = now_ms();
+            timeout = now >= deadline ? 0 : (int)(deadline - now);
+        }
+
+        EpollEvent events[2];
+        long ready = sys_epoll_wait_asm(epoll_fd, events, 2, timeout);
+        int child_exited = 0;
+        int file_changed = 0;
+
+        for (long i = 0; i < ready; ++i) {
+            if (events[i].data == 0) {
+                file_changed |= drain_events(inotify_fd, state == MIN_RUNNING && running);
+                continue;
+            }
+            // 128 bytes per signalfd_siginfo; only the signal number matters
+            uint32_t info[32];
+            while (sys_read_asm(signal_fd, info, sizeof(info)) > 0) {
+                if (info[0] == KMIN_SIGCHLD) {
+                    child_exited |= reap(pid);
+                } else if (running) {
+                    running = 0;
+                    file_changed = 1; // Reuse the stop path below
+                }
+            }
+        }
+
+        if (child_exited) {
+            if (state == MIN_RUNNING && running) {
+                out("[Watcher info] Process died unexpectedly\n");
+                sleep_ms(KMIN_RESPAWN_DELAY_MS);
+            }
+            pid = 0;
+            state = MIN_RUNNING;
+            if (running) {
+                restarts++;
+                pid = start_child(command, envp, &old_mask);
+            }
+            continue;
+        }
+
+        if (state == MIN_RUNNING && file_changed) {
+            if (pid <= 0) {
+                if (running) {
+                    pid = start_child(command, envp, &old_mask); // The last fork failed
+                }
+                continue;
+            }
+            if (!running) {
+                out("\n[Watcher info] Shutting down process (PID: ");
+                out_num(pid);
+                out(")...\n");
+            }
+            process_stop_asm((pid_t)pid);
+            state = MIN_STOPPING;
+            deadline = now_ms() + KMIN_GRACE_MS;
+        } else if (state == MIN_STOPPING && now_ms() >= deadline) {
+            out("[Watcher info] Process did not respond to SIGTERM, sending SIGKILL...\n");
+            sys_kill_asm((int)-pid, KMIN_SIGKILL);
+            state = MIN_KILLING;
+        }
+    }
+
+    out("\n[Kavin] Watcher stopped. Total restarts: ");
+    out_num((long)restarts);
+    out("\n");
+    return 0;
+}
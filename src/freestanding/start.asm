@@ -0,0 +1,20 @@
+; Copyright © 2025 Mint teams
+; start.asm - process entry point for the freestanding build
+
+section .text
+    global _start
+    extern kavin_min_main
+
+; The kernel enters here with RSP -> argc, argv[], NULL, envp[], NULL.
+; There is no libc to set anything up, so hand that block to C as is.
+_start:
+    xor     ebp, ebp            ; Mark the outermost frame
+    mov     rdi, rsp            ; kavin_min_main(long *stack)
+    and     rsp, -16            ; The ABI wants 16-byte alignment at the call
+    call    kavin_min_main
+
+    mov     edi, eax            ; Exit code
+    mov     eax, 231            ; exit_group
+    syscall
+
+section .note.GNU-stack noalloc noexec nowrite progbits
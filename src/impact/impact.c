@@ -0,0 +1,496 @@
+/*
+    Copyright © 2025 Mint teams
+    impact.c
+    The generic Node.js process watcher
+*/
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+
+#include <impact/impact.h>
+#include <impact/impact_jobs.h>
+#include <arch/fingerprint.h>
+#include <process/warm_cache.h>
+
+// Sources bigger than this are not scanned for imports
+#define IMPACT_MAX_SOURCE (1024 * 1024)
+#define IMPACT_MAX_SPECIFIER 512
+
+struct TestImpact {
+    int use_imports;
+    int node_count;         // Table entries mirrored so far
+    int node_capacity;
+    char **norm;            // Normalized path per table entry
+    PathIndex norm_index;
+    unsigned char *is_test;
+    char **stem;            // Basename without extension or test markers
+    int **deps;             // imports: what each entry imports
+    int *dep_count;
+    int *rev_start;         // imports: reverse graph, rebuilt when dirty
+    int *rev_edges;
+    int reverse_dirty;
+    int test_count;
+    unsigned long next_set;
+    TestJobs *jobs;
+};
+
+// "./src/../lib/a.js" -> "lib/a.js". Backslashes count as separators.
+static char *normalize_path(const char *path) {
+    size_t len = strlen(path);
+    char *out = malloc(len + 2);
+    if (!out) {
+        return NULL;
+    }
+
+    size_t used = 0;
+    int absolute = path[0] == '/' || path[0] == '\\';
+    if (absolute) {
+        out[used++] = '/';
+    }
+    size_t root = used;
+
+    const char *seg = path;
+    while (*seg) {
+        while (*seg == '/' || *seg == '\\') {
+            seg++;
+        }
+        size_t seg_len = strcspn(seg, "/\\");
+        if (seg_len == 0 || (seg_len == 1 && seg[0] == '.')) {
+            seg += seg_len;
+            continue;
+        }
+        if (seg_len == 2 && seg[0] == '.' && seg[1] == '.') {
+            // Drop the previous segment unless there is none or it is ".." itself
+            size_t start = used;
+            while (start > root && out[start - 1] != '/') {
+                start--;
+            }
+            if (used > root && !(used - start == 2 && out[start] == '.' && out[start + 1] == '.')) {
+                used = start > root ? start - 1 : root;
+                seg += 2;
+                continue;
+            }
+            if (absolute) {
+                seg += 2;
+                continue; // "/.." is "/"
+            }
+        }
+        if (used > root) {
+            out[used++] = '/';
+        }
+        memcpy(out + used, seg, seg_len);
+        used += seg_len;
+        seg += seg_len;
+    }
+    out[used] = '\0';
+    return out;
+}
+
+static const char *base_name(const char *path) {
+    const char *slash = strrchr(path, '/');
+    return slash ? slash + 1 : path;
+}
+
+static int has_suffix(const char *s, size_t len, const char *suffix) {
+    size_t n = strlen(suffix);
+    return len >= n && memcmp(s + len - n, suffix, n) == 0;
+}
+
+static int is_test_path(const char *norm) {
+    const char *base = base_name(norm);
+    size_t stem_len = strcspn(base, ".");
+    return strstr(base, ".test.") || strstr(base, ".spec.") ||
+           has_suffix(base, stem_len, "_test") || has_suffix(base, stem_len, "_spec") ||
+           strncmp(base, "test_", 5) == 0 || strstr(norm, "__tests__/") != NULL;
+}
+
+// "user.test.js", "user_spec.rb", "test_user.py" and "user.js" all give "user".
+static char *test_stem(const char *norm) {
+    const char *base = base_name(norm);
+    size_t len = strcspn(base, ".");
+    if (has_suffix(base, len, "_test") || has_suffix(base, len, "_spec")) {
+        len -= 5;
+    } else if (strncmp(base, "test_", 5) == 0 && len > 5) {
+        base += 5;
+        len -= 5;
+    }
+    char *stem = malloc(len + 1);
+    if (stem) {
+        memcpy(stem, base, len);
+        stem[len] = '\0';
+    }
+    return stem;
+}
+
+static int grow_nodes(TestImpact *impact, int count) {
+    if (count <= impact->node_capacity) {
+        return 0;
+    }
+    int cap = impact->node_capacity ? impact->node_capacity : 64;
+    while (cap < count) {
+        cap *= 2;
+    }
+
+    char **norm = realloc(impact->norm, sizeof(char *) * cap);
+    if (norm) impact->norm = norm;
+    unsigned char *is_test = realloc(impact->is_test, cap);
+    if (is_test) impact->is_test = is_test;
+    char **stem = realloc(impact->stem, sizeof(char *) * cap);
+    if (stem) impact->stem = stem;
+    int **deps = realloc(impact->deps, sizeof(int *) * cap);
+    if (deps) impact->deps = deps;
+    int *dep_count = realloc(impact->dep_count, sizeof(int) * cap);
+    if (dep_count) impact->dep_count = dep_count;
+
+    if (!norm || !is_test || !stem || !deps || !dep_count) {
+        return -1;
+    }
+    impact->node_capacity = cap;
+    return 0;
+}
+
+static char *read_source(const char *path, size_t *len_out) {
+    FILE *f = fopen(path, "rb");
+    if (!f) {
+        return NULL;
+    }
+    char *buffer = malloc(IMPACT_MAX_SOURCE + 1);
+    size_t len = buffer ? fread(buffer, 1, IMPACT_MAX_SOURCE + 1, f) : 0;
+    fclose(f);
+    if (!buffer || len > IMPACT_MAX_SOURCE) {
+        free(buffer);
+        return NULL;
+    }
+    buffer[len] = '\0';
+    *len_out = len;
+    return buffer;
+}
+
+// Is the word ending right before `end` (after skipping blanks) equal to `word`?
+static int word_before(const char *buf, size_t end, const char *word) {
+    while (end > 0 && (buf[end - 1] == ' ' || buf[end - 1] == '\t' || buf[end - 1] == '\n' ||
+                       buf[end - 1] == '\r')) {
+        end--;
+    }
+    size_t n = strlen(word);
+    if (end < n || memcmp(buf + end - n, word, n) != 0) {
+        return 0;
+    }
+    char before = end > n ? buf[end - n - 1] : ' ';
+    return !(before == '_' || before == '$' || before == '.' ||
+             (before >= 'a' && before <= 'z') || (before >= 'A' && before <= 'Z') ||
+             (before >= '0' && before <= '9'));
+}
+
+// Is the string literal starting at `quote` a module specifier?
+static int is_specifier_context(const char *buf, size_t quote) {
+    size_t end = quote;
+    while (end > 0 && (buf[end - 1] == ' ' || buf[end - 1] == '\t')) {
+        end--;
+    }
+    if (end > 0 && buf[end - 1] == '(') {
+        return word_before(buf, end - 1, "require") || word_before(buf, end - 1, "import");
+    }
+    return word_before(buf, quote, "from") || word_before(buf, quote, "import");
+}
+
+static int resolve_specifier(TestImpact *impact, int node, const char *spec) {
+    static const char *const suffixes[] = {
+        "", ".js", ".mjs", ".cjs", ".jsx", ".ts", ".tsx", ".mts", ".cts",
+        "/index.js", "/index.ts", "/index.jsx", "/index.tsx", NULL
+    };
+
+    const char *from = impact->norm[node];
+    const char *slash = strrchr(from, '/');
+    size_t dir_len = slash ? (size_t)(slash - from) : 0;
+    size_t spec_len = strlen(spec);
+    char *joined = malloc(dir_len + spec_len + 16);
+    if (!joined) {
+        return -1;
+    }
+
+    int found = -1;
+    for (int s = 0; suffixes[s] && found < 0; ++s) {
+        snprintf(joined, dir_len + spec_len + 16, "%.*s%s%s%s", (int)dir_len, from, dir_len ? "/" : "",
+                 spec, suffixes[s]);
+        char *candidate = normalize_path(joined);
+        if (candidate) {
+            found = path_index_find(&impact->norm_index, impact->norm, candidate);
+            free(candidate);
+        }
+    }
+    // TypeScript ESM imports name the emitted ".js" file
+    if (found < 0 && has_suffix(spec, spec_len, ".js")) {
+        snprintf(joined, dir_len + spec_len + 16, "%.*s%s%.*s.ts", (int)dir_len, from, dir_len ? "/" : "",
+                 (int)(spec_len - 3), spec);
+        char *candidate = normalize_path(joined);
+        if (candidate) {
+            found = path_index_find(&impact->norm_index, impact->norm, candidate);
+            free(candidate);
+        }
+    }
+    free(joined);
+    return found;
+}
+
+static void add_dep(TestImpact *impact, int node, int dep, int *cap) {
+    for (int i = 0; i < impact->dep_count[node]; ++i) {
+        if (impact->deps[node][i] == dep) {
+            return;
+        }
+    }
+    if (impact->dep_count[node] == *cap) {
+        int grown_cap = *cap ? *cap * 2 : 8;
+        int *grown = realloc(impact->deps[node], sizeof(int) * grown_cap);
+        if (!grown) {
+            return;
+        }
+        impact->deps[node] = grown;
+        *cap = grown_cap;
+    }
+    impact->deps[node][impact->dep_count[node]++] = dep;
+}
+
+/*
+    Collects relative specifiers from require("..."), import("..."),
+    import ... from "...", export ... from "..." and import "...".
+    A lexer-free scan: strings in comments can add an edge too many,
+    which only means an extra test run.
+*/
+static void parse_imports(TestImpact *impact, int node, const char *path) {
+    free(impact->deps[node]);
+    impact->deps[node] = NULL;
+    impact->dep_count[node] = 0;
+    impact->reverse_dirty = 1;
+
+    size_t len;
+    char *buf = read_source(path, &len);
+    if (!buf) {
+        return;
+    }
+
+    int cap = 0;
+    for (size_t i = 0; i < len; ++i) {
+        char quote = buf[i];
+        if (quote != '\'' && quote != '"' && quote != '`') {
+            continue;
+        }
+        size_t close = i + 1;
+        while (close < len && buf[close] != quote && buf[close] != '\n' && close - i < IMPACT_MAX_SPECIFIER) {
+            close++;
+        }
+        if (close >= len || buf[close] != quote) {
+            continue;
+        }
+
+        if (buf[i + 1] == '.' && is_specifier_context(buf, i)) {
+            buf[close] = '\0';
+            int dep = resolve_specifier(impact, node, buf + i + 1);
+            buf[close] = quote;
+            if (dep >= 0 && dep != node) {
+                add_dep(impact, node, dep, &cap);
+            }
+        }
+        i = close; // Skip the literal's contents
+    }
+    free(buf);
+}
+
+// Mirrors table entries added since the last call.
+static void sync_nodes(TestImpact *impact, Watcher *watcher) {
+    int first = impact->node_count;
+    if (watcher->file_count <= first || grow_nodes(impact, watcher->file_count) != 0) {
+        return;
+    }
+
+    for (int i = first; i < watcher->file_count; ++i) {
+        impact->norm[i] = normalize_path(watcher->files_to_watch[i]);
+        if (!impact->norm[i]) {
+            impact->norm[i] = strdup("");
+        }
+        impact->is_test[i] = (unsigned char)is_test_path(impact->norm[i]);
+        impact->stem[i] = test_stem(impact->norm[i]);
+        impact->deps[i] = NULL;
+        impact->dep_count[i] = 0;
+        impact->test_count += impact->is_test[i];
+        path_index_insert(&impact->norm_index, impact->norm, i);
+    }
+    impact->node_count = watcher->file_count;
+
+    // Second pass, so imports between new files resolve
+    if (impact->use_imports) {
+        for (int i = first; i < watcher->file_count; ++i) {
+            parse_imports(impact, i, watcher->files_to_watch[i]);
+        }
+    }
+}
+
+static void rebuild_reverse(TestImpact *impact) {
+    int n = impact->node_count;
+    int edges = 0;
+    for (int i = 0; i < n; ++i) {
+        edges += impact->dep_count[i];
+    }
+
+    free(impact->rev_start);
+    free(impact->rev_edges);
+    impact->rev_start = calloc((size_t)n + 1, sizeof(int));
+    impact->rev_edges = malloc(sizeof(int) * (edges ? edges : 1));
+    if (!impact->rev_start || !impact->rev_edges) {
+        return;
+    }
+
+    for (int i = 0; i < n; ++i) {
+        for (int d = 0; d < impact->dep_count[i]; ++d) {
+            impact->rev_start[impact->deps[i][d] + 1]++;
+        }
+    }
+    for (int i = 0; i < n; ++i) {
+        impact->rev_start[i + 1] += impact->rev_start[i];
+    }
+    int *fill = malloc(sizeof(int) * (n ? n : 1));
+    if (!fill) {
+        return;
+    }
+    memcpy(fill, impact->rev_start, sizeof(int) * n);
+    for (int i = 0; i < n; ++i) {
+        for (int d = 0; d < impact->dep_count[i]; ++d) {
+            impact->rev_edges[fill[impact->deps[i][d]]++] = i;
+        }
+    }
+    free(fill);
+    impact->reverse_dirty = 0;
+}
+
+TestImpact *impact_open(Watcher *watcher) {
+    TestImpact *impact = calloc(1, sizeof(TestImpact));
+    if (!impact) {
+        return NULL;
+    }
+    impact->use_imports = strcmp(watcher->options->test_map, "imports") == 0;
+    impact->next_set = 1;
+    path_index_init(&impact->norm_index);
+    impact->jobs = test_jobs_create(watcher->cmd, watcher->options->test_jobs);
+    if (!impact->jobs) {
+        free(impact);
+        return NULL;
+    }
+
+    if (watcher->warm_cache) {
+        test_jobs_set_env(impact->jobs, warm_cache_env(watcher->warm_cache));
+    }
+
+    sync_nodes(impact, watcher);
+    printf("[Tests] %d test files among %d watched, mapping by %s, %d parallel jobs\n", impact->test_count,
+           watcher->file_count, impact->use_imports ? "imports" : "name", watcher->options->test_jobs);
+    return impact;
+}
+
+void impact_close(TestImpact *impact) {
+    if (!impact) {
+        return;
+    }
+    test_jobs_destroy(impact->jobs);
+    for (int i = 0; i < impact->node_count; ++i) {
+        free(impact->norm[i]);
+        free(impact->stem[i]);
+        free(impact->deps[i]);
+    }
+    free(impact->norm);
+    free(impact->is_test);
+    free(impact->stem);
+    free(impact->deps);
+    free(impact->dep_count);
+    free(impact->rev_start);
+    free(impact->rev_edges);
+    path_index_free(&impact->norm_index);
+    free(impact);
+}
+
+void impact_on_changes(TestImpact *impact, Watcher *watcher) {
+    int n = watcher->file_count;
+    sync_nodes(impact, watcher);
+
+    unsigned char *selected = calloc((size_t)n + 1, 1);
+    int *queue = malloc(sizeof(int) * ((size_t)n + 1));
+    char **tests = malloc(sizeof(char *) * ((size_t)n + 1));
+    if (!selected || !queue || !tests) {
+        free(selected);
+        free(queue);
+        free(tests);
+        return;
+    }
+
+    // Changed entries seed the walk; their own imports may have changed too.
+    int head = 0;
+    int tail = 0;
+    int changed = 0;
+    for (size_t w = 0; w < FINGERPRINT_BITMAP_WORDS(n); ++w) {
+        for (uint64_t bits = watcher->changed_bitmap[w]; bits; bits &= bits - 1) {
+            int i = (int)(w * 64) + __builtin_ctzll(bits);
+            if (impact->use_imports) {
+                parse_imports(impact, i, watcher->files_to_watch[i]);
+            }
+            selected[i] = 1;
+            queue[tail++] = i;
+            changed++;
+        }
+    }
+
+    int test_count = 0;
+    if (impact->use_imports) {
+        if (impact->reverse_dirty) {
+            rebuild_reverse(impact);
+        }
+        while (head < tail && impact->rev_start) {
+            int i = queue[head++];
+            if (impact->is_test[i]) {
+                tests[test_count++] = watcher->files_to_watch[i];
+            }
+            for (int e = impact->rev_start[i]; e < impact->rev_start[i + 1]; ++e) {
+                int importer = impact->rev_edges[e];
+                if (!selected[importer]) {
+                    selected[importer] = 1;
+                    queue[tail++] = importer;
+                }
+            }
+        }
+    } else {
+        for (int q = 0; q < tail; ++q) {
+            int i = queue[q];
+            if (impact->is_test[i]) {
+                tests[test_count++] = watcher->files_to_watch[i];
+                continue;
+            }
+            for (int t = 0; t < n; ++t) {
+                if (impact->is_test[t] && !selected[t] && impact->stem[i] && impact->stem[t] &&
+                    strcmp(impact->stem[i], impact->stem[t]) == 0) {
+                    selected[t] = 1;
+                    tests[test_count++] = watcher->files_to_watch[t];
+                }
+            }
+        }
+    }
+
+    unsigned long set_id = impact->next_set++;
+    if (test_count == 0) {
+        printf("[Tests] Change set #%lu: %d changed files, no affected tests\n", set_id, changed);
+    } else {
+        printf("[Tests] Change set #%lu: %d changed files, running %d affected test%s\n", set_id, changed,
+               test_count, test_count == 1 ? "" : "s");
+        test_jobs_submit(impact->jobs, set_id, tests, test_count);
+    }
+
+    free(selected);
+    free(queue);
+    free(tests);
+}
+
+void impact_set_priority(TestImpact *impact, ProcessPriority priority) {
+    test_jobs_set_priority(impact->jobs, priority);
+}
+
+void impact_tick(TestImpact *impact) {
+    test_jobs_tick(impact->jobs);
+}
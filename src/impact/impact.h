@@ -0,0 +1,40 @@
+/*
+    Copyright © 2025 Mint teams
+    impact.h
+    The generic Node.js process watcher
+*/
+
+#ifndef IMPACT_H
+#define IMPACT_H
+
+#include <watcher/watcher.h>
+#include <process/process.h>
+
+/*
+    Test-impact mode (--test-map name|imports). Instead of restarting
+    <command>, every change set runs only the tests it can affect, with
+    <command> as the per-test template.
+
+    name:    a changed source maps to tests with the same stem, so
+             src/user.js -> test/user.test.js, user.spec.ts, user_test.js
+    imports: relative require()/import specifiers of the watched files
+             form a graph; a change affects every test that reaches the
+             file through it.
+
+    A changed test file always reruns itself.
+*/
+typedef struct TestImpact TestImpact;
+
+TestImpact *impact_open(Watcher *watcher);
+void impact_close(TestImpact *impact);
+
+// Maps the entries flagged in watcher->changed_bitmap to tests and queues them.
+void impact_on_changes(TestImpact *impact, Watcher *watcher);
+
+// Scheduling for test runs started from now on
+void impact_set_priority(TestImpact *impact, ProcessPriority priority);
+
+// Drives the job pool; call once per watcher tick.
+void impact_tick(TestImpact *impact);
+
+#endif // IMPACT_H
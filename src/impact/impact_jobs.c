@@ -0,0 +1,334 @@
+/*
+    Copyright © 2025 Mint teams
+    impact_jobs.c
+    The generic Node.js process watcher
+*/
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <stdint.h>
+
+#include <impact/impact_jobs.h>
+#include <process/process.h>
+#include <watcher/watcher.h>
+
+#ifndef _WIN32
+#include <fcntl.h>
+#include <unistd.h>
+#include <sys/wait.h>
+#endif
+
+typedef enum {
+    JOB_QUEUED,
+    JOB_RUNNING,
+    JOB_CANCELLED   // Killed for a newer change set, not reaped yet
+} TestJobState;
+
+typedef struct {
+    char *test;
+    unsigned long set_id;
+    TestJobState state;
+    pid_t pid;
+    int output_fd;      // Captured stdout + stderr, -1 when inherited
+    uint64_t start_ms;
+} TestJob;
+
+typedef struct {
+    unsigned long id;
+    int total;
+    int passed;
+    int failed;
+    int superseded;
+    uint64_t start_ms;
+} ChangeSet;
+
+struct TestJobs {
+    char *command_template;
+    int max_jobs;
+    TestJob *jobs;      // In queue order
+    int job_count;
+    ChangeSet *sets;
+    int set_count;
+    const char *const *env;
+    ProcessPriority priority;
+};
+
+TestJobs *test_jobs_create(const char *command_template, int max_jobs) {
+    TestJobs *jobs = calloc(1, sizeof(TestJobs));
+    if (!jobs) {
+        return NULL;
+    }
+    jobs->command_template = strdup(command_template);
+    jobs->max_jobs = max_jobs > 0 ? max_jobs : 1;
+    if (!jobs->command_template) {
+        free(jobs);
+        return NULL;
+    }
+    return jobs;
+}
+
+void test_jobs_set_env(TestJobs *jobs, const char *const *env) {
+    jobs->env = env;
+}
+
+void test_jobs_set_priority(TestJobs *jobs, ProcessPriority priority) {
+    jobs->priority = priority;
+}
+
+static ChangeSet *find_set(TestJobs *jobs, unsigned long id) {
+    for (int i = 0; i < jobs->set_count; ++i) {
+        if (jobs->sets[i].id == id) {
+            return &jobs->sets[i];
+        }
+    }
+    return NULL;
+}
+
+static void remove_job(TestJobs *jobs, int i) {
+    free(jobs->jobs[i].test);
+    if (jobs->jobs[i].output_fd >= 0) {
+        #ifndef _WIN32
+        close(jobs->jobs[i].output_fd);
+        #endif
+    }
+    memmove(&jobs->jobs[i], &jobs->jobs[i + 1], sizeof(TestJob) * (jobs->job_count - i - 1));
+    jobs->job_count--;
+}
+
+void test_jobs_destroy(TestJobs *jobs) {
+    if (!jobs) {
+        return;
+    }
+    for (int i = 0; i < jobs->job_count; ++i) {
+        TestJob *job = &jobs->jobs[i];
+        // pid 0 (or -1) is a failed start: kill(-pid) would hit our own group, or everything
+        if (job->state != JOB_QUEUED && job->pid > 0) {
+            process_kill(job->pid);
+            #ifndef _WIN32
+            waitpid(job->pid, NULL, 0);
+            #endif
+        }
+    }
+    while (jobs->job_count > 0) {
+        remove_job(jobs, jobs->job_count - 1);
+    }
+    free(jobs->jobs);
+    free(jobs->sets);
+    free(jobs->command_template);
+    free(jobs);
+}
+
+// Appends `path` quoted for the shell that runs the command.
+static void append_quoted(char **out, size_t *len, size_t *cap, const char *path) {
+    size_t need = *len + strlen(path) * 4 + 3;
+    if (need > *cap) {
+        *cap = need * 2;
+        *out = realloc(*out, *cap);
+    }
+    char *p = *out + *len;
+    #ifdef _WIN32
+    *p++ = '"';
+    for (const char *c = path; *c; ++c) {
+        *p++ = *c;
+    }
+    *p++ = '"';
+    #else
+    *p++ = '\'';
+    for (const char *c = path; *c; ++c) {
+        if (*c == '\'') {
+            memcpy(p, "'\\''", 4); // Close, escaped quote, reopen
+            p += 4;
+        } else {
+            *p++ = *c;
+        }
+    }
+    *p++ = '\'';
+    #endif
+    *p = '\0';
+    *len = (size_t)(p - *out);
+}
+
+static char *expand_command(const char *command_template, const char *test) {
+    size_t cap = strlen(command_template) + strlen(test) * 4 + 8;
+    size_t len = 0;
+    char *out = malloc(cap);
+    int substituted = 0;
+
+    for (const char *c = command_template; out && *c;) {
+        if (c[0] == '{' && c[1] == '}') {
+            append_quoted(&out, &len, &cap, test);
+            substituted = 1;
+            c += 2;
+            continue;
+        }
+        if (len + 2 > cap) {
+            cap *= 2;
+            out = realloc(out, cap);
+            if (!out) {
+                break;
+            }
+        }
+        out[len++] = *c++;
+        out[len] = '\0';
+    }
+    if (out && !substituted) {
+        out[len++] = ' ';
+        out[len] = '\0';
+        append_quoted(&out, &len, &cap, test);
+    }
+    return out;
+}
+
+static void start_job(TestJobs *jobs, TestJob *job) {
+    char *command = expand_command(jobs->command_template, job->test);
+    ProcessOptions process_options = { NULL, 0, 0, 0, jobs->env, jobs->priority };
+
+    #ifndef _WIN32
+    // Parallel runs would interleave on the terminal; keep each one's output aside.
+    char capture[] = "/tmp/kavin-test-XXXXXX";
+    job->output_fd = mkstemp(capture);
+    if (job->output_fd >= 0) {
+        unlink(capture);
+        fcntl(job->output_fd, F_SETFD, FD_CLOEXEC);
+        process_options.output_fd = job->output_fd;
+    }
+    #endif
+
+    job->pid = command ? process_start_with(command, &process_options) : 0;
+    job->state = JOB_RUNNING;
+    job->start_ms = watcher_clock_ms();
+    free(command);
+}
+
+void test_jobs_submit(TestJobs *jobs, unsigned long set_id, char **tests, int count) {
+    ChangeSet *sets = realloc(jobs->sets, sizeof(ChangeSet) * (jobs->set_count + 1));
+    TestJob *grown = realloc(jobs->jobs, sizeof(TestJob) * (jobs->job_count + count));
+    if (sets) {
+        jobs->sets = sets;
+    }
+    if (grown) {
+        jobs->jobs = grown;
+    }
+    if (!sets || !grown) {
+        perror("Failed to queue tests");
+        return;
+    }
+
+    ChangeSet *set = &jobs->sets[jobs->set_count++];
+    memset(set, 0, sizeof(*set));
+    set->id = set_id;
+    set->start_ms = watcher_clock_ms();
+
+    for (int t = 0; t < count; ++t) {
+        // Supersede older runs of the same test
+        for (int i = jobs->job_count - 1; i >= 0; --i) {
+            TestJob *old = &jobs->jobs[i];
+            if (old->set_id == set_id || strcmp(old->test, tests[t]) != 0) {
+                continue;
+            }
+            if (old->state == JOB_QUEUED) {
+                find_set(jobs, old->set_id)->superseded++;
+                remove_job(jobs, i);
+            } else if (old->state == JOB_RUNNING) {
+                if (old->pid > 0) {
+                    process_kill(old->pid);
+                }
+                old->state = JOB_CANCELLED;
+            }
+        }
+
+        TestJob *job = &jobs->jobs[jobs->job_count];
+        job->test = strdup(tests[t]);
+        if (!job->test) {
+            continue;
+        }
+        job->set_id = set_id;
+        job->state = JOB_QUEUED;
+        job->pid = 0;
+        job->output_fd = -1;
+        job->start_ms = 0;
+        jobs->job_count++;
+        set->total++;
+    }
+}
+
+static int exit_ok(int status) {
+    #ifdef _WIN32
+    return status == 0;
+    #else
+    return WIFEXITED(status) && WEXITSTATUS(status) == 0;
+    #endif
+}
+
+static void dump_output(int fd) {
+    #ifndef _WIN32
+    char buffer[4096];
+    ssize_t n;
+    fflush(stdout);
+    lseek(fd, 0, SEEK_SET);
+    while ((n = read(fd, buffer, sizeof(buffer))) > 0) {
+        fwrite(buffer, 1, (size_t)n, stdout);
+    }
+    fflush(stdout);
+    #else
+    (void)fd;
+    #endif
+}
+
+void test_jobs_tick(TestJobs *jobs) {
+    int active = 0;
+
+    for (int i = 0; i < jobs->job_count; ++i) {
+        TestJob *job = &jobs->jobs[i];
+        if (job->state == JOB_QUEUED) {
+            continue;
+        }
+
+        int status = 0;
+        if (job->pid > 0 && process_check_status(job->pid, &status) != job->pid) {
+            active++;
+            continue;
+        }
+
+        ChangeSet *set = find_set(jobs, job->set_id);
+        if (job->state == JOB_CANCELLED) {
+            set->superseded++;
+        } else if (job->pid > 0 && exit_ok(status)) {
+            set->passed++;
+            printf("[Tests] PASS %s (%llu ms)\n", job->test,
+                   (unsigned long long)(watcher_clock_ms() - job->start_ms));
+        } else {
+            set->failed++;
+            printf("[Tests] FAIL %s (%llu ms)\n", job->test,
+                   (unsigned long long)(watcher_clock_ms() - job->start_ms));
+            if (job->output_fd >= 0) {
+                dump_output(job->output_fd);
+            }
+        }
+        remove_job(jobs, i--);
+    }
+
+    // Oldest change set first
+    for (int i = 0; i < jobs->job_count && active < jobs->max_jobs; ++i) {
+        if (jobs->jobs[i].state == JOB_QUEUED) {
+            start_job(jobs, &jobs->jobs[i]);
+            active++;
+        }
+    }
+
+    for (int i = 0; i < jobs->set_count; ++i) {
+        ChangeSet *set = &jobs->sets[i];
+        if (set->passed + set->failed + set->superseded < set->total) {
+            continue;
+        }
+        printf("[Tests] Change set #%lu: %d passed, %d failed", set->id, set->passed, set->failed);
+        if (set->superseded) {
+            printf(", %d superseded by newer changes", set->superseded);
+        }
+        printf(" (%.1fs)\n", (double)(watcher_clock_ms() - set->start_ms) / 1000.0);
+        memmove(set, set + 1, sizeof(ChangeSet) * (jobs->set_count - i - 1));
+        jobs->set_count--;
+        i--;
+    }
+}
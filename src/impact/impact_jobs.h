@@ -0,0 +1,37 @@
+/*
+    Copyright © 2025 Mint teams
+    impact_jobs.h
+    The generic Node.js process watcher
+*/
+
+#ifndef IMPACT_JOBS_H
+#define IMPACT_JOBS_H
+
+#include <process/process.h>
+
+/*
+    Bounded pool of test runs. Each run is one process group started
+    from the command template, with `{}` replaced by the test path (or
+    the path appended when there is no `{}`). Runs belong to the change
+    set that queued them, and a set prints one summary when its last run
+    ends. A newer set that wants the same test cancels the older run,
+    whether it is still queued or already in flight.
+*/
+typedef struct TestJobs TestJobs;
+
+TestJobs *test_jobs_create(const char *command_template, int max_jobs);
+void test_jobs_destroy(TestJobs *jobs); // Kills whatever is still running
+
+// Queues change set `set_id`. `tests` are copied.
+void test_jobs_submit(TestJobs *jobs, unsigned long set_id, char **tests, int count);
+
+// Extra environment for every run, as in ProcessOptions.env; not copied.
+void test_jobs_set_env(TestJobs *jobs, const char *const *env);
+
+// Scheduling for runs started from now on; those in flight keep theirs.
+void test_jobs_set_priority(TestJobs *jobs, ProcessPriority priority);
+
+// Reaps finished runs, starts queued ones and prints finished sets.
+void test_jobs_tick(TestJobs *jobs);
+
+#endif // IMPACT_JOBS_H
@@ -13,6 +13,8 @@
 #endif
 
 #include <watcher/watcher.h>
+#include <options/options.h>
+#include <daemon/kavind.h>
 
 // Global flag to control the main loop, accessible by the signal handler.
 static volatile sig_atomic_t g_running = 1;
@@ -22,23 +24,49 @@ static void signal_handler(int signum) {
     g_running = 0;
 }
 
+// Set on SIGUSR1; the watcher prints its stats on the next tick.
+static volatile sig_atomic_t g_stats_requested = 0;
+
+#ifndef _WIN32
+static void stats_handler(int signum) {
+    (void)signum;
+    g_stats_requested = 1;
+}
+
+// Does nothing but interrupt the watcher's sleep when the child exits.
+static void child_handler(int signum) {
+    (void)signum;
+}
+#endif
+
 int main(int argc, char *argv[]) {
     
-    if (argc < 3) {
-        fprintf(stderr, "Usage: %s <command> <file1> [file2] ...\n", argv[0]);
-        fprintf(stderr, "Example: %s \"npm start\" src/main.js src/utils.js\n", argv[0]);
+    KavinOptions options;
+    options_defaults(&options);
+    int first = options_parse(&options, argc, argv);
+
+    if (first >= 0 && options.daemon) {
+        return kavind_run(&options);
+    }
+    if (first < 0 || argc - first < 2) {
+        options_usage(argv[0]);
         return 1;
     }
 
     signal(SIGINT, signal_handler);
     signal(SIGTERM, signal_handler);
+#ifndef _WIN32
+    signal(SIGUSR1, stats_handler);
+    signal(SIGCHLD, child_handler);
+#endif
 
     // Clear the console screen while run
     printf("\033[2J\033[H");
 
     Watcher watcher;
     // Pass the command.
-    watcher_init(&watcher, argv[1], &argv[2], argc - 2);
+    watcher_init(&watcher, &options, argv[first], &argv[first + 1], argc - first - 1);
+    watcher.stats_flag = &g_stats_requested;
 
     /*
         The main logic is now encapsulated in watcher_run.
@@ -55,9 +83,9 @@ int main(int argc, char *argv[]) {
 /*
 
     To compile all components together:
-    gcc -O3 -march=native -flto -o kavin src/main.c src/watcher/watcher.c src/watcher/watcher_actions.c src/process/process.c -Isrc
+    gcc -O3 -march=native -flto -pthread -o kavin src/main.c src/options/options.c src/watcher/watcher.c src/watcher/watcher_actions.c src/watcher/watcher_poll.c src/process/process.c -Isrc
 
-    Usage: ./kavin <command> <file1> <file2> <file3> ...
+    Usage: ./kavin [options] <command> <file1> <file2> <file3> ...
     Example: ./kavin "npm start" src/main.js
     Or use many of file examole: ./kavin "npm start" src/main.js src/index.js ... rest of the file
 
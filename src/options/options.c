@@ -0,0 +1,231 @@
+/*
+    Copyright © 2025 Mint teams
+    options.c
+    The generic Node.js process watcher
+*/
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <stddef.h>
+
+#include <options/options.h>
+
+typedef enum {
+    OPT_INT,
+    OPT_STRING,
+    OPT_FLAG      // Takes no value, sets the int to 1
+} OptionType;
+
+typedef struct {
+    const char *name;
+    OptionType type;
+    size_t offset;
+    const char *arg;
+    const char *help;
+    const char *const *choices; // NULL-terminated, or NULL for free text
+} OptionSpec;
+
+static const char *const BACKEND_CHOICES[] = { "auto", "poll", "inotify", "fanotify", "shared", NULL };
+static const char *const TEST_MAP_CHOICES[] = { "off", "name", "imports", NULL };
+static const char *const GIT_CHOICES[] = { "auto", "off", NULL };
+static const char *const REPLAY_CLOCK_CHOICES[] = { "virtual", "real", NULL };
+static const char *const PSI_CHOICES[] = { "auto", "system", "cgroup", "off", NULL };
+static const char *const PSI_PRIORITY_CHOICES[] = { "off", "batch", "idle", NULL };
+static const char *const WATCH_THREAD_CHOICES[] = { "on", "off", NULL };
+static const char *const BUILD_SPECULATIVE_CHOICES[] = { "on", "off", NULL };
+
+static const OptionSpec OPTION_SPECS[] = {
+    { "backend", OPT_STRING, offsetof(KavinOptions, backend), "<name>",
+      "auto, poll, inotify, fanotify or shared (default auto)", BACKEND_CHOICES },
+    { "poll-interval", OPT_INT, offsetof(KavinOptions, poll_interval_ms), "<ms>",
+      "Delay between two checks, at least 1 (default 100)", NULL },
+    { "poll-workers", OPT_INT, offsetof(KavinOptions, poll_workers), "<n>",
+      "Stat threads per polling pass, 0 = auto (default 0)", NULL },
+    { "poll-budget", OPT_INT, offsetof(KavinOptions, poll_budget), "<n>",
+      "Max files stat'ed per pass, 0 = all (default 0)", NULL },
+    { "poll-max", OPT_INT, offsetof(KavinOptions, poll_max_ms), "<ms>",
+      "Quiet files back off up to this, 0 = poll all every tick (default 2000)", NULL },
+    { "watch-budget", OPT_INT, offsetof(KavinOptions, watch_budget), "<n>",
+      "Max inotify watches, rest is polled, 0 = kernel limit (default 0)", NULL },
+    { "scan-workers", OPT_INT, offsetof(KavinOptions, scan_workers), "<n>",
+      "Threads for the initial directory scan, 0 = auto, 1 = serial (default 0)", NULL },
+    { "listen", OPT_STRING, offsetof(KavinOptions, listen), "<addr,...>",
+      "Hold these sockets across restarts, pass as LISTEN_FDS", NULL },
+    { "test-map", OPT_STRING, offsetof(KavinOptions, test_map), "<mode>",
+      "Run affected tests instead of restarting: off, name or imports", TEST_MAP_CHOICES },
+    { "test-jobs", OPT_INT, offsetof(KavinOptions, test_jobs), "<n>",
+      "Parallel test runs with --test-map (default 4)", NULL },
+    { "daemon", OPT_FLAG, offsetof(KavinOptions, daemon), "",
+      "Run kavind, the shared watch daemon, in the foreground", NULL },
+    { "daemon-idle", OPT_INT, offsetof(KavinOptions, daemon_idle), "<s>",
+      "kavind exits after this long without clients (default 30)", NULL },
+    { "trace", OPT_STRING, offsetof(KavinOptions, trace), "<file>",
+      "Write the restart timeline as a Chrome trace (Perfetto)", NULL },
+    { "git", OPT_STRING, offsetof(KavinOptions, git), "<mode>",
+      "auto: hold changes while git rewrites the tree, off (default auto)", GIT_CHOICES },
+    { "soft-reload", OPT_INT, offsetof(KavinOptions, soft_reload_ms), "<ms>",
+      "Offer changes to the app over KAVIN_RELOAD_FD first, 0 = off (default 0)", NULL },
+    { "replicas", OPT_INT, offsetof(KavinOptions, replicas), "<n>",
+      "Run n copies, restarted one at a time (default 1)", NULL },
+    { "ready-timeout", OPT_INT, offsetof(KavinOptions, ready_timeout_ms), "<ms>",
+      "Replica counts as ready without READY=1 after this (default 3000)", NULL },
+    { "record", OPT_STRING, offsetof(KavinOptions, record), "<file>",
+      "Record the change events seen to a binary log for --replay", NULL },
+    { "replay", OPT_STRING, offsetof(KavinOptions, replay), "<file>",
+      "Replay a --record log instead of watching, then report latencies", NULL },
+    { "replay-clock", OPT_STRING, offsetof(KavinOptions, replay_clock), "<mode>",
+      "virtual: skip idle time, real: recorded speed (default virtual)", REPLAY_CLOCK_CHOICES },
+    { "psi", OPT_STRING, offsetof(KavinOptions, psi), "<source>",
+      "Pressure stall info: auto, system, cgroup or off (default auto)", PSI_CHOICES },
+    { "psi-threshold", OPT_INT, offsetof(KavinOptions, psi_threshold), "<pct>",
+      "Throttle at this CPU, memory or IO pressure (default 40)", NULL },
+    { "psi-debounce", OPT_INT, offsetof(KavinOptions, psi_debounce_ms), "<ms>",
+      "Hold restarts this long while throttled (default 2000)", NULL },
+    { "psi-priority", OPT_STRING, offsetof(KavinOptions, psi_priority), "<mode>",
+      "Children started while throttled: off, batch or idle (default off)", PSI_PRIORITY_CHOICES },
+    { "warm-cache", OPT_STRING, offsetof(KavinOptions, warm_cache), "<dir>",
+      "Compile cache kept across restarts, auto = per project", NULL },
+    { "warm-cache-max", OPT_INT, offsetof(KavinOptions, warm_cache_max_mb), "<MB>",
+      "Empty the warm cache past this size, 0 = never (default 512)", NULL },
+    { "watch-thread", OPT_STRING, offsetof(KavinOptions, watch_thread), "<mode>",
+      "on: watch on a thread of its own, off: between process checks (default on)", WATCH_THREAD_CHOICES },
+    { "build", OPT_STRING, offsetof(KavinOptions, build), "<command>",
+      "Run before every start; a failed build keeps the current app", NULL },
+    { "build-speculative", OPT_STRING, offsetof(KavinOptions, build_speculative), "<mode>",
+      "on: start the build on the first write of a save (default off)", BUILD_SPECULATIVE_CHOICES },
+};
+
+static const int OPTION_COUNT = sizeof(OPTION_SPECS) / sizeof(OPTION_SPECS[0]);
+
+void options_defaults(KavinOptions *opts) {
+    memset(opts, 0, sizeof(*opts));
+    opts->backend = "auto";
+    opts->poll_interval_ms = 100;
+    opts->poll_workers = 0;
+    opts->poll_budget = 0;
+    opts->poll_max_ms = 2000;
+    opts->watch_budget = 0;
+    opts->scan_workers = 0;
+    opts->listen = NULL;
+    opts->test_map = "off";
+    opts->test_jobs = 4;
+    opts->daemon = 0;
+    opts->daemon_idle = 30;
+    opts->trace = NULL;
+    opts->git = "auto";
+    opts->soft_reload_ms = 0;
+    opts->replicas = 1;
+    opts->ready_timeout_ms = 3000;
+    opts->record = NULL;
+    opts->replay = NULL;
+    opts->replay_clock = "virtual";
+    opts->psi = "auto";
+    opts->psi_threshold = 40;
+    opts->psi_debounce_ms = 2000;
+    opts->psi_priority = "off";
+    opts->warm_cache = NULL;
+    opts->warm_cache_max_mb = 512;
+    opts->watch_thread = "on";
+    opts->build = NULL;
+    opts->build_speculative = "off";
+}
+
+static const OptionSpec *find_option(const char *name, size_t len) {
+    for (int i = 0; i < OPTION_COUNT; ++i) {
+        if (strlen(OPTION_SPECS[i].name) == len && strncmp(OPTION_SPECS[i].name, name, len) == 0) {
+            return &OPTION_SPECS[i];
+        }
+    }
+    return NULL;
+}
+
+static int apply_option(KavinOptions *opts, const OptionSpec *spec, const char *value) {
+    char *field = (char *)opts + spec->offset;
+
+    switch (spec->type) {
+        case OPT_INT: {
+            char *end;
+            long parsed = strtol(value, &end, 10);
+            if (*value == '\0' || *end != '\0' || parsed < 0) {
+                fprintf(stderr, "[Kavin] Invalid value for --%s: %s\n", spec->name, value);
+                return -1;
+            }
+            // 0 would make every poll pass start right after the last: a busy loop
+            if (spec->offset == offsetof(KavinOptions, poll_interval_ms) && parsed < 1) {
+                fprintf(stderr, "[Kavin] --%s must be at least 1\n", spec->name);
+                return -1;
+            }
+            *(int *)field = (int)parsed;
+            break;
+        }
+        case OPT_FLAG:
+            *(int *)field = 1;
+            break;
+        case OPT_STRING: {
+            if (spec->choices) {
+                int found = 0;
+                for (const char *const *choice = spec->choices; *choice; ++choice) {
+                    found |= strcmp(*choice, value) == 0;
+                }
+                if (!found) {
+                    fprintf(stderr, "[Kavin] Invalid value for --%s: %s\n", spec->name, value);
+                    return -1;
+                }
+            }
+            *(const char **)field = value;
+            break;
+        }
+    }
+    return 0;
+}
+
+int options_parse(KavinOptions *opts, int argc, char **argv) {
+    int i = 1;
+    while (i < argc && strncmp(argv[i], "--", 2) == 0) {
+        const char *name = argv[i] + 2;
+        if (*name == '\0') { // "--" ends the option list
+            return i + 1;
+        }
+
+        const char *eq = strchr(name, '=');
+        size_t name_len = eq ? (size_t)(eq - name) : strlen(name);
+        const OptionSpec *spec = find_option(name, name_len);
+        if (!spec) {
+            fprintf(stderr, "[Kavin] Unknown option: %s\n", argv[i]);
+            return -1;
+        }
+
+        const char *value = eq ? eq + 1 : NULL;
+        if (spec->type == OPT_FLAG) {
+            if (value) {
+                fprintf(stderr, "[Kavin] --%s takes no value\n", spec->name);
+                return -1;
+            }
+            value = "";
+        } else if (!value) {
+            if (i + 1 >= argc) {
+                fprintf(stderr, "[Kavin] Missing value for --%s\n", spec->name);
+                return -1;
+            }
+            value = argv[++i];
+        }
+
+        if (apply_option(opts, spec, value) != 0) {
+            return -1;
+        }
+        ++i;
+    }
+    return i;
+}
+
+void options_usage(const char *prog) {
+    fprintf(stderr, "Usage: %s [options] <command> <file1> [file2] ...\n", prog);
+    fprintf(stderr, "Example: %s \"npm start\" src/main.js src/utils.js\n", prog);
+    fprintf(stderr, "\nOptions:\n");
+    for (int i = 0; i < OPTION_COUNT; ++i) {
+        char left[64];
+        snprintf(left, sizeof(left), "--%s %s", OPTION_SPECS[i].name, OPTION_SPECS[i].arg);
+        fprintf(stderr, "  %-28s %s\n", left, OPTION_SPECS[i].help);
+    }
+}
@@ -0,0 +1,51 @@
+/*
+    Copyright © 2025 Mint teams
+    options.h
+    The generic Node.js process watcher
+*/
+
+#ifndef OPTIONS_H
+#define OPTIONS_H
+
+typedef struct {
+    const char *backend;   // "auto", "poll", "inotify", "fanotify" or "shared"
+    int poll_interval_ms;  // Delay between two watcher ticks
+    int poll_workers;      // Stat threads per pass (0 = auto, 1 = serial)
+    int poll_budget;       // Max stat calls per pass (0 = whole table)
+    int poll_max_ms;       // Back-off ceiling for quiet files (0 = poll all every tick)
+    int watch_budget;      // Max inotify watches (0 = what the kernel allows)
+    int scan_workers;      // Threads for the initial directory scan (0 = auto, 1 = serial)
+    const char *listen;    // Sockets handed to the child as LISTEN_FDS, or NULL
+    const char *test_map;  // "off", "name" or "imports" (test-impact mode)
+    int test_jobs;         // Parallel test runs in test-impact mode
+    int daemon;            // Run kavind instead of watching
+    int daemon_idle;       // Seconds kavind waits for a client before exiting
+    const char *trace;     // Chrome trace file for the restart timeline, or NULL
+    const char *git;       // "auto" holds changes during git operations, "off"
+    int soft_reload_ms;    // Ack deadline for in-place reloads over KAVIN_RELOAD_FD (0 = off)
+    int replicas;          // Copies of <command> run in cluster mode (1 = no cluster)
+    int ready_timeout_ms;  // A replica without READY=1 counts as ready after this
+    const char *record;    // Binary log of the change events seen, or NULL
+    const char *replay;    // Feed a --record log to the watcher instead of the file system
+    const char *replay_clock; // "virtual" skips idle time, "real" replays at recorded speed
+    const char *psi;       // Pressure source: "auto", "system", "cgroup" or "off"
+    int psi_threshold;     // Throttle at this much CPU, memory or IO pressure (percent)
+    int psi_debounce_ms;   // Restarts are held this long while throttled
+    const char *psi_priority; // Children started while throttled: "off", "batch" or "idle"
+    const char *warm_cache; // Compile cache directory for the children, "auto", or NULL
+    int warm_cache_max_mb;  // The cache is emptied past this size (0 = never)
+    const char *watch_thread; // "on" watches on its own thread, "off" on the supervisor's ticks
+    const char *build;     // Runs before every start of the app, or NULL
+    const char *build_speculative; // "on" starts the build on the first write of a save, "off"
+} KavinOptions;
+
+void options_defaults(KavinOptions *opts);
+
+/*
+    Parses the leading "--name value" / "--name=value" options.
+    Returns the argv index of <command>, or -1 on a bad option.
+*/
+int options_parse(KavinOptions *opts, int argc, char **argv);
+void options_usage(const char *prog);
+
+#endif // OPTIONS_H
@@ -0,0 +1,182 @@
+/*
+    Copyright © 2025 Mint teams
+    build.c
+    The generic Node.js process watcher
+*/
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+
+#ifndef _WIN32
+#include <fcntl.h>
+#include <unistd.h>
+#include <sys/wait.h>
+#endif
+
+#include <process/build.h>
+#include <watcher/watcher.h>
+
+struct BuildStep {
+    char *command;
+    BuildState state;
+    pid_t pid;
+    int status;
+    int output_fd;              // Captured stdout + stderr, -1 when inherited
+    int speculative;
+    uint64_t generation;
+    uint64_t start_ms;
+    uint64_t end_ms;
+
+    unsigned long builds;
+    unsigned long speculative_builds;
+    unsigned long cancelled;
+    unsigned long failed;
+    unsigned long used_early;   // Results that were already running when needed
+    uint64_t head_start_ms;     // Build time hidden behind the saves, in total
+};
+
+BuildStep *build_step_create(const char *command) {
+    BuildStep *build = calloc(1, sizeof(BuildStep));
+    if (!build) {
+        return NULL;
+    }
+    build->command = strdup(command);
+    if (!build->command) {
+        free(build);
+        return NULL;
+    }
+    build->output_fd = -1;
+    return build;
+}
+
+static void close_output(BuildStep *build) {
+    #ifndef _WIN32
+    if (build->output_fd >= 0) {
+        close(build->output_fd);
+    }
+    #endif
+    build->output_fd = -1;
+}
+
+void build_step_destroy(BuildStep *build) {
+    if (!build) {
+        return;
+    }
+    build_step_cancel(build);
+    close_output(build);
+    free(build->command);
+    free(build);
+}
+
+int build_step_cancel(BuildStep *build) {
+    int running = build->state == BUILD_RUNNING;
+    if (running) {
+        process_kill(build->pid);
+        #ifdef _WIN32
+        WaitForSingleObject((HANDLE)build->pid, INFINITE);
+        CloseHandle((HANDLE)build->pid);
+        #else
+        waitpid(build->pid, NULL, 0);
+        #endif
+        build->cancelled++;
+    }
+    build->state = BUILD_IDLE;
+    return running;
+}
+
+void build_step_start(BuildStep *build, uint64_t generation, int speculative,
+                      const char *const *env, ProcessPriority priority) {
+    build_step_cancel(build);
+    close_output(build);
+
+    ProcessOptions process_options = { NULL, 0, 0, 0, env, priority };
+    #ifndef _WIN32
+    // A cancelled build would leave half its output on the terminal; only a failure is shown
+    char capture[] = "/tmp/kavin-build-XXXXXX";
+    build->output_fd = mkstemp(capture);
+    if (build->output_fd >= 0) {
+        unlink(capture);
+        fcntl(build->output_fd, F_SETFD, FD_CLOEXEC);
+        process_options.output_fd = build->output_fd;
+    }
+    #endif
+
+    build->pid = process_start_with(build->command, &process_options);
+    build->generation = generation;
+    build->speculative = speculative;
+    build->start_ms = watcher_clock_ms();
+    build->end_ms = 0;
+    build->builds++;
+    build->speculative_builds += speculative != 0;
+    if (build->pid > 0) {
+        build->state = BUILD_RUNNING;
+    } else {
+        build->state = BUILD_FAILED;
+        build->end_ms = build->start_ms;
+        build->failed++;
+    }
+}
+
+static int exit_ok(int status) {
+    #ifdef _WIN32
+    return status == 0;
+    #else
+    return WIFEXITED(status) && WEXITSTATUS(status) == 0;
+    #endif
+}
+
+BuildState build_step_poll(BuildStep *build) {
+    if (build->state != BUILD_RUNNING || process_check_status(build->pid, &build->status) != build->pid) {
+        return build->state;
+    }
+    build->end_ms = watcher_clock_ms();
+    build->state = exit_ok(build->status) ? BUILD_PASSED : BUILD_FAILED;
+    build->failed += build->state == BUILD_FAILED;
+    return build->state;
+}
+
+void build_step_done(BuildStep *build, uint64_t head_start_ms) {
+    if (head_start_ms > 0) {
+        build->used_early++;
+        build->head_start_ms += head_start_ms;
+    }
+    build->state = BUILD_IDLE;
+}
+
+uint64_t build_step_generation(const BuildStep *build) {
+    return build->generation;
+}
+
+uint64_t build_step_started_ms(const BuildStep *build) {
+    return build->start_ms;
+}
+
+uint64_t build_step_elapsed_ms(const BuildStep *build) {
+    return (build->end_ms ? build->end_ms : watcher_clock_ms()) - build->start_ms;
+}
+
+void build_step_print_output(const BuildStep *build) {
+    #ifndef _WIN32
+    if (build->output_fd < 0) {
+        return;
+    }
+    char buffer[4096];
+    ssize_t n;
+    fflush(stdout);
+    lseek(build->output_fd, 0, SEEK_SET);
+    while ((n = read(build->output_fd, buffer, sizeof(buffer))) > 0) {
+        fwrite(buffer, 1, (size_t)n, stdout);
+    }
+    fflush(stdout);
+    #else
+    (void)build;
+    #endif
+}
+
+void build_step_print_stats(const BuildStep *build) {
+    printf("[Watcher stats] build: %lu runs (%lu speculative), %lu cancelled by newer writes, %lu failed, "
+           "%lu already under way when needed, %.1fs hidden behind saves\n",
+           build->builds, build->speculative_builds, build->cancelled, build->failed,
+           build->used_early, build->head_start_ms / 1000.0);
+}
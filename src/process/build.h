@@ -0,0 +1,55 @@
+/*
+    Copyright © 2025 Mint teams
+    build.h
+    The generic Node.js process watcher
+*/
+
+#ifndef BUILD_H
+#define BUILD_H
+
+#include <stdint.h>
+
+#include <process/process.h>
+
+/*
+    The --build step: one process group running the build command, with
+    its output kept aside and shown only when it fails. A build is tagged
+    with the write generation it started at, so the caller can tell
+    whether the files changed again while it ran. Starting a build
+    cancels the one in flight.
+*/
+typedef struct BuildStep BuildStep;
+
+typedef enum {
+    BUILD_IDLE,
+    BUILD_RUNNING,
+    BUILD_PASSED,
+    BUILD_FAILED
+} BuildState;
+
+BuildStep *build_step_create(const char *command);
+void build_step_destroy(BuildStep *build); // Kills a build in flight
+
+// `speculative`: started before the save completed, only counted in the stats
+void build_step_start(BuildStep *build, uint64_t generation, int speculative,
+                      const char *const *env, ProcessPriority priority);
+
+// Kills a build in flight; its result is dropped either way. Returns 1 if one was running.
+int build_step_cancel(BuildStep *build);
+
+// Reaps a finished build. The result stays until the next start or build_step_done().
+BuildState build_step_poll(BuildStep *build);
+
+// The result was used: back to idle. `head_start_ms` is how long it ran before it was needed.
+void build_step_done(BuildStep *build, uint64_t head_start_ms);
+
+uint64_t build_step_generation(const BuildStep *build);
+uint64_t build_step_started_ms(const BuildStep *build);
+uint64_t build_step_elapsed_ms(const BuildStep *build); // Start to finish, or so far
+
+// Writes the failed build's output to stdout
+void build_step_print_output(const BuildStep *build);
+
+void build_step_print_stats(const BuildStep *build);
+
+#endif // BUILD_H
@@ -4,6 +4,10 @@
     The generic Node.js process watcher
 */
 
+#ifndef _GNU_SOURCE
+#define _GNU_SOURCE // SCHED_BATCH, SCHED_IDLE
+#endif
+
 #include "process.h"
 #include <arch/syscalls.h>
 #include <stdio.h>
@@ -11,8 +15,25 @@
 
 #ifdef _WIN32
 #include <windows.h>
+#include <string.h>
 
 pid_t process_start(const char *command) {
+    return process_start_with(command, NULL);
+}
+
+pid_t process_start_with(const char *command, const ProcessOptions *opts) {
+    // No LISTEN_FDS equivalent; sockets_listen() refuses on Windows.
+    // env goes into our own block, which the child inherits; the next start overwrites it.
+    if (opts && opts->env) {
+        for (const char *const *entry = opts->env; *entry; ++entry) {
+            const char *eq = strchr(*entry, '=');
+            if (eq) {
+                char name[128];
+                snprintf(name, sizeof(name), "%.*s", (int)(eq - *entry), *entry);
+                SetEnvironmentVariableA(name, eq + 1);
+            }
+        }
+    }
     char cmd_buffer[1024];
     snprintf(cmd_buffer, sizeof(cmd_buffer), "cmd.exe /C %s", command);
 
@@ -62,20 +83,156 @@ int process_check_status(pid_t pid, int *status) {
 #include <unistd.h>
 #include <sys/wait.h>
 #include <signal.h>
+#include <fcntl.h>
+#include <string.h>
+#include <sys/resource.h>
+#ifdef __linux__
+#include <sched.h>
+#include <sys/syscall.h>
+#endif
+
+#define LISTEN_FDS_START 3
+
+/*
+    Runs in the child only. Moves the inherited sockets to 3, 4, ... in
+    two steps, so a socket already sitting in the target range is never
+    overwritten before it has been copied.
+*/
+static void pass_listen_fds(const ProcessOptions *opts) {
+    int count = opts->listen_fd_count;
+    int moved[count];
+    for (int i = 0; i < count; ++i) {
+        moved[i] = fcntl(opts->listen_fds[i], F_DUPFD_CLOEXEC, LISTEN_FDS_START + count);
+        if (moved[i] < 0) {
+            perror("fcntl failed");
+            exit(127);
+        }
+    }
+    for (int i = 0; i < count; ++i) {
+        // dup2 clears FD_CLOEXEC on the new descriptor
+        if (dup2(moved[i], LISTEN_FDS_START + i) < 0) {
+            perror("dup2 failed");
+            exit(127);
+        }
+        close(moved[i]);
+    }
+
+    char value[32];
+    snprintf(value, sizeof(value), "%d", count);
+    setenv("LISTEN_FDS", value, 1);
+    snprintf(value, sizeof(value), "%ld", (long)getpid());
+    setenv("LISTEN_PID", value, 1);
+
+    // LISTEN_FDNAMES: one "kavin" per socket, colon separated
+    char names[count * 6 + 1];
+    names[0] = '\0';
+    for (int i = 0; i < count; ++i) {
+        strcat(names, i ? ":kavin" : "kavin");
+    }
+    setenv("LISTEN_FDNAMES", names, 1);
+}
+
+/*
+    Runs in the child only, before pass_listen_fds(): the copy lands
+    above the range the listen sockets are moved into, without
+    FD_CLOEXEC, so it survives exec.
+*/
+static void pass_reload_fd(const ProcessOptions *opts) {
+    int fd = fcntl(opts->reload_fd, F_DUPFD, LISTEN_FDS_START + opts->listen_fd_count);
+    if (fd < 0) {
+        perror("fcntl failed");
+        exit(127);
+    }
+    char value[32];
+    snprintf(value, sizeof(value), "%d", fd);
+    setenv("KAVIN_RELOAD_FD", value, 1);
+}
+
+// Runs in the child only.
+static void pass_env(const ProcessOptions *opts) {
+    for (const char *const *entry = opts->env; *entry; ++entry) {
+        const char *eq = strchr(*entry, '=');
+        if (!eq) {
+            continue;
+        }
+        char name[128];
+        snprintf(name, sizeof(name), "%.*s", (int)(eq - *entry), *entry);
+        setenv(name, eq + 1, 1);
+    }
+}
+
+/*
+    Runs in the child only. Both settings are inherited through exec and
+    by everything the app starts. Failures are ignored: a child at normal
+    priority is still better than none.
+*/
+static void apply_priority(ProcessPriority priority) {
+    #ifdef __linux__
+    // Not exposed by glibc: class in the top bits, level 0 (highest) to 7
+    enum { IOPRIO_CLASS_BE = 2, IOPRIO_CLASS_IDLE = 3, IOPRIO_CLASS_SHIFT = 13, IOPRIO_WHO_PROCESS = 1 };
+    struct sched_param param = { 0 };
+    if (priority == PROCESS_PRIORITY_IDLE) {
+        sched_setscheduler(0, SCHED_IDLE, &param);
+        syscall(SYS_ioprio_set, IOPRIO_WHO_PROCESS, 0, IOPRIO_CLASS_IDLE << IOPRIO_CLASS_SHIFT);
+    } else {
+        sched_setscheduler(0, SCHED_BATCH, &param);
+        setpriority(PRIO_PROCESS, 0, 10);
+        syscall(SYS_ioprio_set, IOPRIO_WHO_PROCESS, 0, (IOPRIO_CLASS_BE << IOPRIO_CLASS_SHIFT) | 7);
+    }
+    #else
+    setpriority(PRIO_PROCESS, 0, priority == PROCESS_PRIORITY_IDLE ? 19 : 10);
+    #endif
+}
 
 pid_t process_start(const char *command) {
+    return process_start_with(command, NULL);
+}
+
+pid_t process_start_with(const char *command, const ProcessOptions *opts) {
+    // Until exec the child runs our handlers, which would swallow a stop
+    // sent right after the fork. Hold signals until it has the defaults.
+    sigset_t all, old;
+    sigfillset(&all);
+    pthread_sigmask(SIG_SETMASK, &all, &old);
+
     pid_t pid = fork();
     if (pid == -1) {
+        pthread_sigmask(SIG_SETMASK, &old, NULL);
         perror("fork failed");
         return 0;
     } else if (pid == 0) {
         // Child process
+        static const int HANDLED_SIGNALS[] = { SIGINT, SIGTERM, SIGUSR1, SIGCHLD, SIGPIPE };
+        for (size_t i = 0; i < sizeof(HANDLED_SIGNALS) / sizeof(HANDLED_SIGNALS[0]); ++i) {
+            signal(HANDLED_SIGNALS[i], SIG_DFL);
+        }
+        sigprocmask(SIG_SETMASK, &old, NULL);
         setpgid(0, 0);
+        if (opts && opts->output_fd > 0) {
+            // Before the listen fds, which may be moved on top of it
+            dup2(opts->output_fd, STDOUT_FILENO);
+            dup2(opts->output_fd, STDERR_FILENO);
+        }
+        if (opts && opts->env) {
+            pass_env(opts);
+        }
+        if (opts && opts->priority != PROCESS_PRIORITY_NORMAL) {
+            apply_priority(opts->priority);
+        }
+        if (opts && opts->reload_fd > 0) {
+            pass_reload_fd(opts);
+        }
+        if (opts && opts->listen_fd_count > 0) {
+            pass_listen_fds(opts);
+        }
         execl("/bin/sh", "sh", "-c", command, (char *)NULL);
         perror("execl failed"); // execl only returns on error
         exit(127);
     }
-    // Parent process
+    // Parent process. Set the group from this side too, so a stop sent
+    // right after the fork can't miss a child that hasn't run yet.
+    setpgid(pid, pid);
+    pthread_sigmask(SIG_SETMASK, &old, NULL);
     return pid;
 }
 
@@ -9,7 +9,32 @@
 
 #include <sys/types.h>
 
+/*
+    Extra setup applied to the child between fork and exec.
+    listen_fds are inherited as fds 3, 4, ... with LISTEN_FDS and
+    LISTEN_PID set, the way systemd socket activation passes them.
+    output_fd, when above 0, replaces the child's stdout and stderr.
+    reload_fd, when above 0, is inherited and named in KAVIN_RELOAD_FD.
+    env, when set, is a NULL-terminated list of "NAME=value" to export.
+    priority lowers the child's CPU and IO scheduling (best effort).
+*/
+typedef enum {
+    PROCESS_PRIORITY_NORMAL,
+    PROCESS_PRIORITY_BATCH,     // SCHED_BATCH, nice 10, lowest best-effort IO
+    PROCESS_PRIORITY_IDLE       // SCHED_IDLE, idle IO class
+} ProcessPriority;
+
+typedef struct {
+    const int *listen_fds;
+    int listen_fd_count;
+    int output_fd;
+    int reload_fd;
+    const char *const *env;
+    ProcessPriority priority;
+} ProcessOptions;
+
 pid_t process_start(const char *command);
+pid_t process_start_with(const char *command, const ProcessOptions *opts);
 void process_stop(pid_t pid); // Sends SIGTERM to the process group
 void process_kill(pid_t pid); // Sends SIGKILL to the process group
 
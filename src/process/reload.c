@@ -0,0 +1,110 @@
+/*
+    Copyright © 2025 Mint teams
+    reload.c
+    The generic Node.js process watcher
+*/
+
+#include <stdio.h>
+#include <string.h>
+
+#include "reload.h"
+
+#ifdef _WIN32
+
+int reload_channel_open(int *child_fd) {
+    *child_fd = -1;
+    return -1; // No inheritable socket pair; --soft-reload is refused at startup
+}
+
+void reload_channel_close(int fd) {
+    (void)fd;
+}
+
+int reload_send(int fd, const char *batch, size_t len) {
+    (void)fd; (void)batch; (void)len;
+    return -1;
+}
+
+ReloadReply reload_wait_reply(int fd, int timeout_ms) {
+    (void)fd; (void)timeout_ms;
+    return RELOAD_REFUSED;
+}
+
+#else // POSIX implementation
+#include <errno.h>
+#include <fcntl.h>
+#include <poll.h>
+#include <unistd.h>
+#include <sys/socket.h>
+
+#ifndef MSG_NOSIGNAL
+#define MSG_NOSIGNAL 0 // macOS: SIGPIPE is ignored through SO_NOSIGPIPE below
+#endif
+
+int reload_channel_open(int *child_fd) {
+    int pair[2];
+    if (socketpair(AF_UNIX, SOCK_STREAM, 0, pair) != 0) {
+        return -1;
+    }
+    // Both ends close-on-exec: process_start_with hands the child's end over explicitly
+    fcntl(pair[0], F_SETFD, FD_CLOEXEC);
+    fcntl(pair[1], F_SETFD, FD_CLOEXEC);
+    fcntl(pair[0], F_SETFL, fcntl(pair[0], F_GETFL) | O_NONBLOCK);
+#ifdef SO_NOSIGPIPE
+    int on = 1;
+    setsockopt(pair[0], SOL_SOCKET, SO_NOSIGPIPE, &on, sizeof(on));
+#endif
+    *child_fd = pair[1];
+    return pair[0];
+}
+
+void reload_channel_close(int fd) {
+    if (fd >= 0) {
+        close(fd);
+    }
+}
+
+int reload_send(int fd, const char *batch, size_t len) {
+    while (len > 0) {
+        ssize_t n = send(fd, batch, len, MSG_NOSIGNAL);
+        if (n < 0 && errno == EINTR) {
+            continue;
+        }
+        if (n <= 0) {
+            return -1;
+        }
+        batch += n;
+        len -= (size_t)n;
+    }
+    return 0;
+}
+
+ReloadReply reload_wait_reply(int fd, int timeout_ms) {
+    struct pollfd pfd = { fd, POLLIN, 0 };
+    if (poll(&pfd, 1, timeout_ms) == 0) {
+        return RELOAD_PENDING;
+    }
+
+    char reply[64];
+    ssize_t n = recv(fd, reply, sizeof(reply) - 1, MSG_PEEK);
+    if (n < 0 && (errno == EAGAIN || errno == EWOULDBLOCK || errno == EINTR)) {
+        return RELOAD_PENDING;
+    }
+    if (n <= 0) {
+        return RELOAD_REFUSED;
+    }
+    reply[n] = '\0';
+    char *newline = strchr(reply, '\n');
+    if (!newline) {
+        return (size_t)n == sizeof(reply) - 1 ? RELOAD_REFUSED : RELOAD_PENDING;
+    }
+
+    // Consume exactly one line; anything after it belongs to the next batch
+    recv(fd, reply, (size_t)(newline - reply) + 1, 0);
+    *newline = '\0';
+    if (newline > reply && newline[-1] == '\r') {
+        newline[-1] = '\0';
+    }
+    return strcmp(reply, "handled") == 0 ? RELOAD_HANDLED : RELOAD_REFUSED;
+}
+#endif
@@ -0,0 +1,44 @@
+/*
+    Copyright © 2025 Mint teams
+    reload.h
+    The generic Node.js process watcher
+*/
+
+#ifndef RELOAD_H
+#define RELOAD_H
+
+#include <stddef.h>
+
+/*
+    Soft-reload channel (--soft-reload <ms>). Each child inherits one end
+    of a socket pair; its fd number is in KAVIN_RELOAD_FD. On a change,
+    kavin writes one batch, one line per entry:
+
+        changed <absolute path>
+        deleted <absolute path>
+        reload
+
+    and waits up to <ms> for the child to answer "handled" (swapped in
+    place, keep running) or "restart". No answer, or the child closing
+    its end, falls back to the usual SIGTERM and restart.
+*/
+typedef enum {
+    RELOAD_PENDING,   // Nothing (complete) read yet
+    RELOAD_HANDLED,
+    RELOAD_REFUSED    // "restart", EOF or a read error
+} ReloadReply;
+
+/*
+    Creates the pair. Returns kavin's end (non-blocking, close-on-exec)
+    and stores the child's end in `child_fd`, or returns -1.
+*/
+int reload_channel_open(int *child_fd);
+void reload_channel_close(int fd);
+
+// Writes the whole batch without blocking; -1 when the child's buffer is full.
+int reload_send(int fd, const char *batch, size_t len);
+
+// Waits up to `timeout_ms` for the child's answer line.
+ReloadReply reload_wait_reply(int fd, int timeout_ms);
+
+#endif // RELOAD_H
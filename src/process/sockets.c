@@ -0,0 +1,146 @@
+/*
+    Copyright © 2025 Mint teams
+    sockets.c
+    The generic Node.js process watcher
+*/
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+
+#include "sockets.h"
+
+#ifdef _WIN32
+
+int sockets_listen(const char *spec, int **fds_out) {
+    (void)spec;
+    *fds_out = NULL;
+    fprintf(stderr, "[Watcher error] --listen is not supported on Windows\n");
+    return -1;
+}
+
+void sockets_close(int *fds, int count) {
+    (void)fds; (void)count;
+}
+
+#else // POSIX implementation
+#include <errno.h>
+#include <netdb.h>
+#include <unistd.h>
+#include <sys/socket.h>
+#include <netinet/in.h>
+
+static int open_listener(const char *host, const char *port) {
+    struct addrinfo hints;
+    memset(&hints, 0, sizeof(hints));
+    hints.ai_family = AF_UNSPEC;
+    hints.ai_socktype = SOCK_STREAM;
+    hints.ai_flags = AI_PASSIVE;
+
+    struct addrinfo *list;
+    int rc = getaddrinfo(host, port, &hints, &list);
+    if (rc != 0) {
+        fprintf(stderr, "[Watcher error] --listen %s%s%s: %s\n", host ? host : "", host ? ":" : "",
+                port, gai_strerror(rc));
+        return -1;
+    }
+
+    // A bare port prefers one dual-stack IPv6 socket, then plain IPv4.
+    int fd = -1;
+    int saved = 0;
+    for (int pass = 0; pass < 2 && fd < 0; ++pass) {
+        for (struct addrinfo *ai = list; ai && fd < 0; ai = ai->ai_next) {
+            if (!host && (pass == 0) != (ai->ai_family == AF_INET6)) {
+                continue;
+            }
+            fd = socket(ai->ai_family, ai->ai_socktype | SOCK_CLOEXEC, ai->ai_protocol);
+            if (fd < 0) {
+                saved = errno;
+                continue;
+            }
+            int on = 1;
+            int off = 0;
+            setsockopt(fd, SOL_SOCKET, SO_REUSEADDR, &on, sizeof(on));
+            if (ai->ai_family == AF_INET6 && !host) {
+                setsockopt(fd, IPPROTO_IPV6, IPV6_V6ONLY, &off, sizeof(off));
+            }
+            if (bind(fd, ai->ai_addr, ai->ai_addrlen) != 0 || listen(fd, SOMAXCONN) != 0) {
+                saved = errno;
+                close(fd);
+                fd = -1;
+            }
+        }
+        if (host) {
+            break; // Explicit host: getaddrinfo's order is the user's choice
+        }
+    }
+    freeaddrinfo(list);
+
+    if (fd < 0) {
+        fprintf(stderr, "[Watcher error] --listen %s%s%s: %s\n", host ? host : "", host ? ":" : "",
+                port, strerror(saved));
+    }
+    return fd;
+}
+
+int sockets_listen(const char *spec, int **fds_out) {
+    char *copy = strdup(spec);
+    int *fds = NULL;
+    int count = 0;
+    *fds_out = NULL;
+    if (!copy) {
+        return -1;
+    }
+
+    char *save = NULL;
+    for (char *item = strtok_r(copy, ",", &save); item; item = strtok_r(NULL, ",", &save)) {
+        char *host = NULL;
+        char *port = item;
+        if (item[0] == '[') {
+            char *close_bracket = strchr(item, ']');
+            if (!close_bracket || close_bracket[1] != ':') {
+                fprintf(stderr, "[Watcher error] --listen: bad address %s\n", item);
+                goto fail;
+            }
+            *close_bracket = '\0';
+            host = item + 1;
+            port = close_bracket + 2;
+        } else {
+            char *colon = strrchr(item, ':');
+            if (colon) {
+                *colon = '\0';
+                host = item;
+                port = colon + 1;
+            }
+        }
+
+        int fd = open_listener(host, port);
+        if (fd < 0) {
+            goto fail;
+        }
+        int *grown = realloc(fds, sizeof(int) * (count + 1));
+        if (!grown) {
+            close(fd);
+            goto fail;
+        }
+        fds = grown;
+        fds[count++] = fd;
+    }
+
+    free(copy);
+    *fds_out = fds;
+    return count;
+
+fail:
+    sockets_close(fds, count);
+    free(copy);
+    return -1;
+}
+
+void sockets_close(int *fds, int count) {
+    for (int i = 0; i < count; ++i) {
+        close(fds[i]);
+    }
+    free(fds);
+}
+#endif
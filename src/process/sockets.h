@@ -0,0 +1,23 @@
+/*
+    Copyright © 2025 Mint teams
+    sockets.h
+    The generic Node.js process watcher
+*/
+
+#ifndef SOCKETS_H
+#define SOCKETS_H
+
+/*
+    Listening sockets owned by kavin and handed to every child in the
+    systemd LISTEN_FDS style. They stay open across restarts, so clients
+    that connect while the child is down wait in the kernel backlog
+    instead of getting ECONNREFUSED.
+
+    `spec` is a comma separated list of "port", "host:port" or
+    "[v6addr]:port". Returns the number of sockets opened (fds are
+    close-on-exec) or -1 after printing the reason.
+*/
+int sockets_listen(const char *spec, int **fds_out);
+void sockets_close(int *fds, int count);
+
+#endif // SOCKETS_H
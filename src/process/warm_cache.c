@@ -0,0 +1,434 @@
+/*
+    Copyright © 2025 Mint teams
+    warm_cache.c
+    The generic Node.js process watcher
+*/
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <sys/stat.h>
+
+#ifdef _WIN32
+#include <windows.h>
+#include <direct.h>
+#define getcwd _getcwd
+#else
+#include <unistd.h>
+#include <dirent.h>
+#endif
+
+#include <process/warm_cache.h>
+#include <watcher/watcher.h>
+
+#define WARM_CACHE_PATH_MAX 1024
+
+// Boot is over once the app has used no CPU for this long.
+static const uint64_t BOOT_QUIET_MS = 300;
+// An app still busy after this long is not booting, it is working.
+static const uint64_t BOOT_TIMEOUT_MS = 60000;
+// Shims rarely nest more than a few levels; this only stops a runaway walk.
+static const int BOOT_TREE_DEPTH_MAX = 16;
+
+typedef struct {
+    const char *name;
+    const char *subdir;
+} CacheVariable;
+
+static const CacheVariable CACHE_VARIABLES[] = {
+    { "NODE_COMPILE_CACHE", "node" },
+    { "PYTHONPYCACHEPREFIX", "python" },
+    { "BUN_RUNTIME_TRANSPILER_CACHE_PATH", "bun" },
+};
+#define CACHE_VARIABLE_COUNT WARM_CACHE_ENV_MAX // One entry per CACHE_VARIABLES row
+
+typedef struct {
+    unsigned long count;
+    uint64_t total_ms;
+    uint64_t cpu_ms;
+} BootTimes;
+
+struct WarmCache {
+    char dir[WARM_CACHE_PATH_MAX];
+    uint64_t max_bytes;
+    char *env_entries[CACHE_VARIABLE_COUNT];
+    const char *env[CACHE_VARIABLE_COUNT + 1];
+    uint64_t bytes;             // At the last prepare
+    unsigned long files;
+    unsigned long wipes;
+    int cold;                   // The next (or current) boot starts on an empty cache
+
+    int timing;
+    pid_t pid;
+    uint64_t start_ms;
+    uint64_t last_busy_ms;
+    unsigned long long last_ticks;
+    BootTimes cold_boots;
+    BootTimes warm_boots;
+};
+
+static int make_dirs(const char *path) {
+    char partial[WARM_CACHE_PATH_MAX];
+    snprintf(partial, sizeof(partial), "%s", path);
+    for (char *c = partial + 1;; ++c) {
+        if (*c != '/' && *c != '\\' && *c != '\0') {
+            continue;
+        }
+        char saved = *c;
+        *c = '\0';
+        #ifdef _WIN32
+        _mkdir(partial);
+        #else
+        mkdir(partial, 0700);
+        #endif
+        if (saved == '\0') {
+            break;
+        }
+        *c = saved;
+    }
+    struct stat st;
+    return stat(path, &st) == 0 && (st.st_mode & S_IFMT) == S_IFDIR ? 0 : -1;
+}
+
+// <user cache dir>/kavin/warm/<project dir name>-<hash of its path>
+static int auto_dir(char *out, size_t size) {
+    char cwd[WARM_CACHE_PATH_MAX];
+    if (!getcwd(cwd, sizeof(cwd))) {
+        return -1;
+    }
+    uint64_t hash = 1469598103934665603ULL; // FNV-1a
+    for (const char *c = cwd; *c; ++c) {
+        hash ^= (unsigned char)*c;
+        hash *= 1099511628211ULL;
+    }
+    const char *name = cwd;
+    for (const char *c = cwd; *c; ++c) {
+        if ((*c == '/' || *c == '\\') && c[1]) {
+            name = c + 1;
+        }
+    }
+
+    int n;
+    #ifdef _WIN32
+    const char *base = getenv("LOCALAPPDATA");
+    if (!base || !*base) {
+        return -1;
+    }
+    n = snprintf(out, size, "%s\\kavin\\warm\\%s-%016llx", base, name, (unsigned long long)hash);
+    #else
+    const char *xdg = getenv("XDG_CACHE_HOME");
+    const char *home = getenv("HOME");
+    if (xdg && *xdg) {
+        n = snprintf(out, size, "%s/kavin/warm/%s-%016llx", xdg, name, (unsigned long long)hash);
+    } else if (home && *home) {
+        n = snprintf(out, size, "%s/.cache/kavin/warm/%s-%016llx", home, name, (unsigned long long)hash);
+    } else {
+        return -1;
+    }
+    #endif
+    return n > 0 && (size_t)n < size ? 0 : -1;
+}
+
+/*
+    Adds up the files under `path`. With `wipe` it deletes them (and the
+    directories below `path`) instead.
+*/
+static void walk_cache(const char *path, int wipe, uint64_t *bytes, unsigned long *files) {
+    #ifdef _WIN32
+    char search[WARM_CACHE_PATH_MAX];
+    snprintf(search, sizeof(search), "%s\\*", path);
+    WIN32_FIND_DATA find_data;
+    HANDLE h_find = FindFirstFile(search, &find_data);
+    if (h_find == INVALID_HANDLE_VALUE) {
+        return;
+    }
+    do {
+        const char *name = find_data.cFileName;
+        if (strcmp(name, ".") == 0 || strcmp(name, "..") == 0) {
+            continue;
+        }
+        char child[WARM_CACHE_PATH_MAX];
+        snprintf(child, sizeof(child), "%s\\%s", path, name);
+        if (find_data.dwFileAttributes & FILE_ATTRIBUTE_DIRECTORY) {
+            walk_cache(child, wipe, bytes, files);
+            if (wipe) {
+                RemoveDirectory(child);
+            }
+        } else if (wipe) {
+            DeleteFile(child);
+        } else {
+            *bytes += ((uint64_t)find_data.nFileSizeHigh << 32) | find_data.nFileSizeLow;
+            (*files)++;
+        }
+    } while (FindNextFile(h_find, &find_data) != 0);
+    FindClose(h_find);
+    #else
+    DIR *d = opendir(path);
+    if (!d) {
+        return;
+    }
+    struct dirent *entry;
+    while ((entry = readdir(d)) != NULL) {
+        if (strcmp(entry->d_name, ".") == 0 || strcmp(entry->d_name, "..") == 0) {
+            continue;
+        }
+        char child[WARM_CACHE_PATH_MAX];
+        if (snprintf(child, sizeof(child), "%s/%s", path, entry->d_name) >= (int)sizeof(child)) {
+            continue;
+        }
+        struct stat st;
+        if (lstat(child, &st) != 0) {
+            continue;
+        }
+        if (S_ISDIR(st.st_mode)) {
+            walk_cache(child, wipe, bytes, files);
+            if (wipe) {
+                rmdir(child);
+            }
+        } else if (wipe) {
+            unlink(child);
+        } else {
+            *bytes += (uint64_t)st.st_size;
+            (*files)++;
+        }
+    }
+    closedir(d);
+    #endif
+}
+
+/*
+    Walks the runtime subdirectories only: `<dir>` may be a directory the
+    user also keeps other things in, and only what kavin put there is
+    counted, or wiped.
+*/
+static void walk_subdirs(const WarmCache *cache, int wipe, uint64_t *bytes, unsigned long *files) {
+    for (size_t i = 0; i < CACHE_VARIABLE_COUNT; ++i) {
+        char subdir[WARM_CACHE_PATH_MAX];
+        #ifdef _WIN32
+        int n = snprintf(subdir, sizeof(subdir), "%s\\%s", cache->dir, CACHE_VARIABLES[i].subdir);
+        #else
+        int n = snprintf(subdir, sizeof(subdir), "%s/%s", cache->dir, CACHE_VARIABLES[i].subdir);
+        #endif
+        if (n > 0 && n < (int)sizeof(subdir)) {
+            walk_cache(subdir, wipe, bytes, files);
+        }
+    }
+}
+
+WarmCache *warm_cache_open(const char *spec, int max_mb) {
+    WarmCache *cache = calloc(1, sizeof(WarmCache));
+    if (!cache) {
+        return NULL;
+    }
+    cache->max_bytes = (uint64_t)max_mb * 1024 * 1024;
+    int resolved = strcmp(spec, "auto") == 0 ? auto_dir(cache->dir, sizeof(cache->dir))
+                 : snprintf(cache->dir, sizeof(cache->dir), "%s", spec) < (int)sizeof(cache->dir) ? 0 : -1;
+    if (resolved != 0 || make_dirs(cache->dir) != 0) {
+        free(cache);
+        return NULL;
+    }
+
+    int count = 0;
+    for (size_t i = 0; i < CACHE_VARIABLE_COUNT; ++i) {
+        const char *set = getenv(CACHE_VARIABLES[i].name);
+        if (set && *set) {
+            continue; // The user's own setting wins
+        }
+        size_t len = strlen(CACHE_VARIABLES[i].name) + strlen(cache->dir) + strlen(CACHE_VARIABLES[i].subdir) + 3;
+        char *entry = malloc(len);
+        if (!entry) {
+            continue;
+        }
+        #ifdef _WIN32
+        snprintf(entry, len, "%s=%s\\%s", CACHE_VARIABLES[i].name, cache->dir, CACHE_VARIABLES[i].subdir);
+        #else
+        snprintf(entry, len, "%s=%s/%s", CACHE_VARIABLES[i].name, cache->dir, CACHE_VARIABLES[i].subdir);
+        #endif
+        cache->env_entries[count] = entry;
+        cache->env[count++] = entry;
+    }
+    cache->env[count] = NULL;
+    warm_cache_prepare(cache);
+    return cache;
+}
+
+void warm_cache_close(WarmCache *cache) {
+    if (!cache) {
+        return;
+    }
+    for (size_t i = 0; i < CACHE_VARIABLE_COUNT; ++i) {
+        free(cache->env_entries[i]);
+    }
+    free(cache);
+}
+
+const char *warm_cache_dir(const WarmCache *cache) {
+    return cache->dir;
+}
+
+const char *const *warm_cache_env(const WarmCache *cache) {
+    return cache->env;
+}
+
+void warm_cache_prepare(WarmCache *cache) {
+    cache->bytes = 0;
+    cache->files = 0;
+    walk_subdirs(cache, 0, &cache->bytes, &cache->files);
+    if (cache->max_bytes > 0 && cache->bytes > cache->max_bytes) {
+        printf("[Watcher info] Warm cache at %.1f MB, over %llu MB, emptying it\n",
+               cache->bytes / (1024.0 * 1024.0), (unsigned long long)(cache->max_bytes / (1024 * 1024)));
+        uint64_t unused = 0;
+        unsigned long none = 0;
+        walk_subdirs(cache, 1, &unused, &none);
+        cache->bytes = 0;
+        cache->files = 0;
+        cache->wipes++;
+    }
+    cache->cold = cache->files == 0;
+}
+
+#ifdef __linux__
+/*
+    Reads the CPU time of one /proc/<pid>/stat: its own, plus what its
+    reaped children used. -1 when it is gone or a zombie.
+*/
+static int read_stat(const char *path, unsigned long long *ticks) {
+    FILE *file = fopen(path, "r");
+    if (!file) {
+        return -1;
+    }
+    char line[1024];
+    int read = fgets(line, sizeof(line), file) != NULL;
+    fclose(file);
+    const char *fields = read ? strrchr(line, ')') : NULL; // The name may hold spaces and parentheses
+    char state;
+    unsigned long long utime, stime, cutime, cstime;
+    if (!fields || sscanf(fields + 2, "%c %*d %*d %*d %*d %*d %*u %*u %*u %*u %*u %llu %llu %llu %llu",
+                          &state, &utime, &stime, &cutime, &cstime) != 5 || state == 'Z') {
+        return -1;
+    }
+    *ticks = utime + stime + cutime + cstime;
+    return 0;
+}
+
+/*
+    CPU time of `pid` and everything below it, in clock ticks. The app is
+    rarely the pid we started: sh, npm and version-manager shims sit in
+    between and hand the work to a child. The tree is followed through
+    each thread's children list, so a tick reads the app's own processes
+    and never the rest of /proc.
+*/
+static int add_tree_ticks(pid_t pid, int depth, unsigned long long *ticks) {
+    char path[300];
+    unsigned long long own;
+    snprintf(path, sizeof(path), "/proc/%lld/stat", (long long)pid);
+    if (read_stat(path, &own) != 0) {
+        return -1; // Gone
+    }
+    *ticks += own;
+    if (depth == BOOT_TREE_DEPTH_MAX) {
+        return 0;
+    }
+
+    snprintf(path, sizeof(path), "/proc/%lld/task", (long long)pid);
+    DIR *tasks = opendir(path);
+    if (!tasks) {
+        return 0;
+    }
+    struct dirent *entry;
+    while ((entry = readdir(tasks)) != NULL) {
+        if (entry->d_name[0] < '1' || entry->d_name[0] > '9') {
+            continue;
+        }
+        snprintf(path, sizeof(path), "/proc/%lld/task/%s/children", (long long)pid, entry->d_name);
+        FILE *children = fopen(path, "r");
+        if (!children) {
+            continue;
+        }
+        long long child;
+        while (fscanf(children, "%lld", &child) == 1) {
+            add_tree_ticks((pid_t)child, depth + 1, ticks); // One that exited since is skipped
+        }
+        fclose(children);
+    }
+    closedir(tasks);
+    return 0;
+}
+
+void warm_cache_started(WarmCache *cache, pid_t pid) {
+    if (!cache) {
+        return;
+    }
+    cache->pid = pid;
+    cache->start_ms = watcher_clock_ms();
+    cache->last_busy_ms = cache->start_ms;
+    cache->last_ticks = 0;
+    cache->timing = 1;
+}
+
+void warm_cache_tick(WarmCache *cache) {
+    if (!cache || !cache->timing) {
+        return;
+    }
+    uint64_t now = watcher_clock_ms();
+    unsigned long long ticks;
+    ticks = 0;
+    if (add_tree_ticks(cache->pid, 0, &ticks) != 0) {
+        cache->timing = 0; // Exited while booting: nothing to compare
+        return;
+    }
+    if (ticks != cache->last_ticks) {
+        cache->last_ticks = ticks;
+        cache->last_busy_ms = now;
+    }
+    if (now - cache->last_busy_ms < BOOT_QUIET_MS) {
+        if (now - cache->start_ms > BOOT_TIMEOUT_MS) {
+            printf("[Watcher info] App still busy after %llu s, boot not timed\n",
+                   (unsigned long long)(BOOT_TIMEOUT_MS / 1000));
+            cache->timing = 0;
+        }
+        return;
+    }
+
+    cache->timing = 0;
+    uint64_t boot_ms = cache->last_busy_ms - cache->start_ms;
+    uint64_t cpu_ms = ticks * 1000 / (unsigned long long)sysconf(_SC_CLK_TCK);
+    BootTimes *times = cache->cold ? &cache->cold_boots : &cache->warm_boots;
+    times->count++;
+    times->total_ms += boot_ms;
+    times->cpu_ms += cpu_ms;
+    printf("[Watcher info] App booted in %llu ms, %llu ms CPU (%s cache)\n",
+           (unsigned long long)boot_ms, (unsigned long long)cpu_ms, cache->cold ? "cold" : "warm");
+    cache->cold = 0;
+}
+#else
+// Boot timing reads /proc; elsewhere the cache is only provisioned.
+void warm_cache_started(WarmCache *cache, pid_t pid) {
+    (void)cache; (void)pid;
+}
+
+void warm_cache_tick(WarmCache *cache) {
+    (void)cache;
+}
+#endif
+
+int warm_cache_timing(const WarmCache *cache) {
+    return cache && cache->timing;
+}
+
+static void print_boots(const char *kind, const BootTimes *times) {
+    if (times->count == 0) {
+        printf("[Watcher stats] warm cache: no %s boots timed\n", kind);
+        return;
+    }
+    printf("[Watcher stats] warm cache: %lu %s boot%s, avg %llu ms, %llu ms CPU\n", times->count, kind,
+           times->count == 1 ? "" : "s", (unsigned long long)(times->total_ms / times->count),
+           (unsigned long long)(times->cpu_ms / times->count));
+}
+
+void warm_cache_print_stats(const WarmCache *cache) {
+    printf("[Watcher stats] warm cache: %s, %.1f MB in %lu files at the last start, %lu wipes\n",
+           cache->dir, cache->bytes / (1024.0 * 1024.0), cache->files, cache->wipes);
+    print_boots("cold", &cache->cold_boots);
+    print_boots("warm", &cache->warm_boots);
+}
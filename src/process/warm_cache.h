@@ -0,0 +1,59 @@
+/*
+    Copyright © 2025 Mint teams
+    warm_cache.h
+    The generic Node.js process watcher
+*/
+
+#ifndef WARM_CACHE_H
+#define WARM_CACHE_H
+
+#include <stdint.h>
+#include <sys/types.h>
+
+/*
+    Managed compile cache (--warm-cache <dir|auto>). Every restart starts
+    the runtime from scratch, and most of a Node or Python boot is spent
+    compiling the same modules again. Children get one directory per
+    project through the runtimes' own switches:
+
+        NODE_COMPILE_CACHE                  <dir>/node    (Node 22.1+)
+        PYTHONPYCACHEPREFIX                 <dir>/python  (Python 3.8+)
+        BUN_RUNTIME_TRANSPILER_CACHE_PATH   <dir>/bun
+
+    A variable already set in kavin's environment is left alone. When the
+    directory grows past --warm-cache-max it is emptied before the next
+    start, which is then a cold one again.
+
+    On Linux each start of the app is timed: boot ends when the process
+    first stops using CPU for 300 ms, which for a server is when it
+    sits in its event loop. Cold and warm boots are reported separately.
+*/
+typedef struct WarmCache WarmCache;
+
+// Most entries warm_cache_env() returns, for callers merging it into their own list
+#define WARM_CACHE_ENV_MAX 3
+
+// `spec` is a directory or "auto" (per project, in the user's cache dir).
+WarmCache *warm_cache_open(const char *spec, int max_mb);
+void warm_cache_close(WarmCache *cache);
+
+const char *warm_cache_dir(const WarmCache *cache);
+
+// NULL-terminated "NAME=value" list for ProcessOptions.env, valid until close
+const char *const *warm_cache_env(const WarmCache *cache);
+
+// Call before a start: empties the cache when it is over budget.
+void warm_cache_prepare(WarmCache *cache);
+
+// The app was started as `pid`: times its boot. NULL-safe.
+void warm_cache_started(WarmCache *cache, pid_t pid);
+
+// Call once per tick while the app runs. NULL-safe.
+void warm_cache_tick(WarmCache *cache);
+
+// A boot is being timed; the caller keeps ticking at --poll-interval
+int warm_cache_timing(const WarmCache *cache);
+
+void warm_cache_print_stats(const WarmCache *cache);
+
+#endif // WARM_CACHE_H
@@ -0,0 +1,267 @@
+/*
+    Copyright © 2025 Mint teams
+    event_log.c
+    The generic Node.js process watcher
+*/
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <time.h>
+
+#ifdef _WIN32
+#include <windows.h>
+#endif
+
+#include <replay/event_log.h>
+#include <watcher/watcher_index.h>
+
+static const char EVENT_LOG_MAGIC[8] = { 'K', 'A', 'V', 'I', 'N', 'E', 'V', '1' };
+#define EVENT_NEW_PATH 0x80
+#define EVENT_KIND_MASK 0x7f
+
+struct EventLogWriter {
+    FILE *file;
+    uint64_t origin_us;
+    uint64_t last_us;
+    char **paths;           // Numbered in order of first appearance
+    int path_count;
+    PathIndex index;
+    unsigned long events;
+};
+
+struct EventLogReader {
+    unsigned char *data;
+    size_t size;
+    size_t offset;
+    uint64_t time_us;
+    char **paths;
+    int path_count;
+};
+
+static uint64_t event_clock_us(void) {
+#ifdef _WIN32
+    LARGE_INTEGER now, freq;
+    QueryPerformanceCounter(&now);
+    QueryPerformanceFrequency(&freq);
+    return (uint64_t)(now.QuadPart / freq.QuadPart) * 1000000 +
+           (uint64_t)(now.QuadPart % freq.QuadPart) * 1000000 / (uint64_t)freq.QuadPart;
+#else
+    struct timespec now;
+    clock_gettime(CLOCK_MONOTONIC, &now);
+    return (uint64_t)now.tv_sec * 1000000 + (uint64_t)now.tv_nsec / 1000;
+#endif
+}
+
+static void write_varint(FILE *file, uint64_t value) {
+    while (value >= 0x80) {
+        fputc((int)(value & 0x7f) | 0x80, file);
+        value >>= 7;
+    }
+    fputc((int)value, file);
+}
+
+EventLogWriter *event_log_create(const char *path) {
+    EventLogWriter *log = calloc(1, sizeof(EventLogWriter));
+    if (!log) {
+        return NULL;
+    }
+    log->file = fopen(path, "wb");
+    if (!log->file) {
+        free(log);
+        return NULL;
+    }
+    fwrite(EVENT_LOG_MAGIC, 1, sizeof(EVENT_LOG_MAGIC), log->file);
+    fflush(log->file);
+    path_index_init(&log->index);
+    log->origin_us = event_clock_us();
+    return log;
+}
+
+void event_log_close(EventLogWriter *log) {
+    if (!log) {
+        return;
+    }
+    fclose(log->file);
+    for (int i = 0; i < log->path_count; ++i) {
+        free(log->paths[i]);
+    }
+    free(log->paths);
+    path_index_free(&log->index);
+    free(log);
+}
+
+// Returns the path's number, or -1 when it is new (and now numbered).
+static int intern_path(EventLogWriter *log, const char *path) {
+    int id = path_index_find(&log->index, log->paths, path);
+    if (id >= 0) {
+        return id;
+    }
+    char **paths = realloc(log->paths, sizeof(char *) * (size_t)(log->path_count + 1));
+    if (!paths) {
+        return -2;
+    }
+    log->paths = paths;
+    paths[log->path_count] = strdup(path);
+    if (!paths[log->path_count] || path_index_insert(&log->index, log->paths, log->path_count) != 0) {
+        free(paths[log->path_count]);
+        return -2;
+    }
+    log->path_count++;
+    return -1;
+}
+
+void event_log_write(EventLogWriter *log, EventKind kind, const char *path) {
+    if (!log) {
+        return;
+    }
+    uint64_t now = event_clock_us() - log->origin_us;
+    int id = path ? intern_path(log, path) : 0;
+    if (id == -2) {
+        return; // Out of memory: drop the event rather than number it wrong
+    }
+
+    fputc((int)kind | (id == -1 ? EVENT_NEW_PATH : 0), log->file);
+    write_varint(log->file, now - log->last_us);
+    if (path) {
+        if (id == -1) {
+            size_t len = strlen(path);
+            write_varint(log->file, len);
+            fwrite(path, 1, len, log->file);
+        } else {
+            write_varint(log->file, (uint64_t)id);
+        }
+    }
+    log->last_us = now;
+    log->events++;
+}
+
+void event_log_flush(EventLogWriter *log) {
+    if (log) {
+        fflush(log->file);
+    }
+}
+
+unsigned long event_log_written(const EventLogWriter *log) {
+    return log ? log->events : 0;
+}
+
+EventLogReader *event_log_open(const char *path) {
+    FILE *file = fopen(path, "rb");
+    if (!file) {
+        perror("[Watcher error] Failed to open event log");
+        return NULL;
+    }
+
+    EventLogReader *log = calloc(1, sizeof(EventLogReader));
+    size_t cap = 0;
+    size_t n = 0;
+    do {
+        if (!log) {
+            break;
+        }
+        if (log->size == cap) {
+            cap = cap ? cap * 2 : 65536;
+            unsigned char *data = realloc(log->data, cap);
+            if (!data) {
+                break;
+            }
+            log->data = data;
+        }
+        n = fread(log->data + log->size, 1, cap - log->size, file);
+        log->size += n;
+    } while (n > 0);
+    fclose(file);
+
+    if (!log || log->size < sizeof(EVENT_LOG_MAGIC) ||
+        memcmp(log->data, EVENT_LOG_MAGIC, sizeof(EVENT_LOG_MAGIC)) != 0) {
+        fprintf(stderr, "[Watcher error] %s is not a kavin event log\n", path);
+        event_log_reader_close(log);
+        return NULL;
+    }
+    log->offset = sizeof(EVENT_LOG_MAGIC);
+    return log;
+}
+
+void event_log_reader_close(EventLogReader *log) {
+    if (!log) {
+        return;
+    }
+    for (int i = 0; i < log->path_count; ++i) {
+        free(log->paths[i]);
+    }
+    free(log->paths);
+    free(log->data);
+    free(log);
+}
+
+static int read_varint(EventLogReader *log, size_t *offset, uint64_t *value) {
+    *value = 0;
+    for (int shift = 0; shift < 64; shift += 7) {
+        if (*offset >= log->size) {
+            return 0;
+        }
+        unsigned char byte = log->data[(*offset)++];
+        *value |= (uint64_t)(byte & 0x7f) << shift;
+        if (!(byte & 0x80)) {
+            return 1;
+        }
+    }
+    return 0;
+}
+
+int event_log_next(EventLogReader *log, LoggedEvent *event) {
+    // Parse into a local offset first: a truncated tail record must not half-apply
+    size_t offset = log->offset;
+    if (offset >= log->size) {
+        return 0;
+    }
+    unsigned char head = log->data[offset++];
+    EventKind kind = (EventKind)(head & EVENT_KIND_MASK);
+    uint64_t delta;
+    if (kind < EVENT_CHANGED || kind > EVENT_GIT_END || !read_varint(log, &offset, &delta)) {
+        return 0;
+    }
+
+    const char *path = NULL;
+    if (kind != EVENT_GIT_BEGIN && kind != EVENT_GIT_END) {
+        uint64_t value;
+        if (!read_varint(log, &offset, &value)) {
+            return 0;
+        }
+        if (head & EVENT_NEW_PATH) {
+            if (value > log->size - offset) {
+                return 0;
+            }
+            char **paths = realloc(log->paths, sizeof(char *) * (size_t)(log->path_count + 1));
+            if (!paths) {
+                return 0;
+            }
+            log->paths = paths;
+            paths[log->path_count] = malloc((size_t)value + 1);
+            if (!paths[log->path_count]) {
+                return 0;
+            }
+            memcpy(paths[log->path_count], log->data + offset, (size_t)value);
+            paths[log->path_count][value] = '\0';
+            offset += (size_t)value;
+            path = paths[log->path_count++];
+        } else {
+            if (value >= (uint64_t)log->path_count) {
+                return 0;
+            }
+            path = log->paths[value];
+        }
+    }
+
+    log->offset = offset;
+    log->time_us += delta;
+    event->kind = kind;
+    event->time_us = log->time_us;
+    event->path = path;
+    return 1;
+}
+
+int event_log_paths(const EventLogReader *log) {
+    return log->path_count;
+}
@@ -0,0 +1,61 @@
+/*
+    Copyright © 2025 Mint teams
+    event_log.h
+    The generic Node.js process watcher
+*/
+
+#ifndef EVENT_LOG_H
+#define EVENT_LOG_H
+
+#include <stdint.h>
+
+/*
+    Compact binary log of the change events the watcher core sees
+    (--record <file>), read back by --replay.
+
+    The file starts with the 8-byte magic "KAVINEV1". Each record is:
+      - one byte: the kind, plus 0x80 when the path is new to the log
+      - LEB128 microseconds since the previous record
+      - for file events, either LEB128 length + bytes (new path) or the
+        LEB128 number of a path seen before, counted from 0 in order of
+        first appearance
+    Records are appended as they happen, so a log cut short by a crash
+    reads fine up to its last whole record.
+*/
+typedef enum {
+    EVENT_CHANGED = 1,
+    EVENT_CREATED = 2,
+    EVENT_DELETED = 3,
+    EVENT_GIT_BEGIN = 4,    // A git operation started holding the tree
+    EVENT_GIT_END = 5
+} EventKind;
+
+typedef struct {
+    EventKind kind;
+    uint64_t time_us;       // Since the log was started
+    const char *path;       // NULL for git events; valid until the reader closes
+} LoggedEvent;
+
+typedef struct EventLogWriter EventLogWriter;
+typedef struct EventLogReader EventLogReader;
+
+// Every writer call is a no-op on a NULL writer.
+EventLogWriter *event_log_create(const char *path);
+void event_log_close(EventLogWriter *log);
+void event_log_write(EventLogWriter *log, EventKind kind, const char *path);
+
+// Pushes buffered records to the file; call once per batch.
+void event_log_flush(EventLogWriter *log);
+unsigned long event_log_written(const EventLogWriter *log);
+
+// NULL (with a message) when the file is missing or not an event log.
+EventLogReader *event_log_open(const char *path);
+void event_log_reader_close(EventLogReader *log);
+
+// Returns 1 and fills `event`, or 0 at the end of the log.
+int event_log_next(EventLogReader *log, LoggedEvent *event);
+
+// Distinct paths read so far
+int event_log_paths(const EventLogReader *log);
+
+#endif // EVENT_LOG_H
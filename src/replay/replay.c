@@ -0,0 +1,214 @@
+/*
+    Copyright © 2025 Mint teams
+    replay.c
+    The generic Node.js process watcher
+*/
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+
+#include <replay/replay.h>
+#include <replay/event_log.h>
+#include <watcher/watcher_actions.h>
+#include <trace/trace.h>
+
+static const uint64_t NONE = UINT64_MAX;
+
+struct Replay {
+    EventLogReader *log;
+    LoggedEvent next;
+    int has_next;
+    int virtual_clock;
+    uint64_t start_ms;      // Real clock origin
+    uint64_t virtual_us;
+    time_t stamp;           // Synthetic mtimes: every event gets a fresh one
+
+    int holding;
+    int released;
+    uint64_t first_pending_us;  // Oldest event not compared yet
+    uint64_t batch_start_us;    // Oldest event of the change set in flight
+
+    unsigned long events;
+    unsigned long holds;
+    unsigned long change_sets;
+    uint64_t *latencies_us;
+    size_t latency_count;
+    size_t latency_cap;
+    uint64_t last_event_us;
+};
+
+static uint64_t replay_now_us(const Replay *replay) {
+    if (replay->virtual_clock) {
+        return replay->virtual_us;
+    }
+    return (watcher_clock_ms() - replay->start_ms) * 1000;
+}
+
+Replay *replay_open(const char *path, int virtual_clock) {
+    Replay *replay = calloc(1, sizeof(Replay));
+    if (!replay) {
+        return NULL;
+    }
+    replay->log = event_log_open(path);
+    if (!replay->log) {
+        free(replay);
+        return NULL;
+    }
+    replay->has_next = event_log_next(replay->log, &replay->next);
+    replay->virtual_clock = virtual_clock;
+    replay->start_ms = watcher_clock_ms();
+    replay->first_pending_us = NONE;
+    replay->batch_start_us = NONE;
+    return replay;
+}
+
+void replay_close(Replay *replay) {
+    if (!replay) {
+        return;
+    }
+    event_log_reader_close(replay->log);
+    free(replay->latencies_us);
+    free(replay);
+}
+
+static void apply_file_event(Replay *replay, Watcher *watcher, const LoggedEvent *event) {
+    int i = path_index_find(&watcher->file_index, watcher->files_to_watch, event->path);
+    if (i < 0) {
+        // First sight of a path: it joins the table as it was before the event
+        char *path = strdup(event->path);
+        time_t mtime = ++replay->stamp;
+        if (!path || watcher_add_files(watcher, &path, &mtime, 1) != 1) {
+            return;
+        }
+        i = watcher->file_count - 1;
+        if (event->kind == EVENT_CREATED) {
+            printf("[Watcher info] Now watching new file: %s\n", event->path);
+            return;
+        }
+    }
+
+    watcher->current_mtimes[i] = event->kind == EVENT_DELETED ? 0 : ++replay->stamp;
+    if (replay->first_pending_us == NONE) {
+        replay->first_pending_us = event->time_us;
+    }
+}
+
+int replay_apply(Replay *replay, Watcher *watcher) {
+    uint64_t now = replay_now_us(replay);
+    int applied = 0;
+    while (replay->has_next && replay->next.time_us <= now) {
+        const LoggedEvent *event = &replay->next;
+        if (event->kind == EVENT_GIT_BEGIN) {
+            if (!replay->holding) {
+                printf("[Watcher info] git operation in progress, holding changes\n");
+                trace_begin(watcher->trace, TRACE_GIT, "Git operation", NULL);
+                replay->holding = 1;
+                replay->holds++;
+            }
+        } else if (event->kind == EVENT_GIT_END) {
+            if (replay->holding) {
+                printf("[Watcher info] git operation finished, reconciling\n");
+                trace_end(watcher->trace, TRACE_GIT, NULL);
+                replay->holding = 0;
+                replay->released = 1;
+            }
+        } else {
+            apply_file_event(replay, watcher, event);
+        }
+        replay->last_event_us = event->time_us;
+        replay->events++;
+        applied++;
+        replay->has_next = event_log_next(replay->log, &replay->next);
+    }
+
+    if (!replay->has_next && replay->holding) {
+        printf("[Watcher info] Log ended during a git operation, reconciling\n");
+        trace_end(watcher->trace, TRACE_GIT, "log ended");
+        replay->holding = 0;
+        replay->released = 1;
+    }
+    return applied;
+}
+
+int replay_holding(const Replay *replay) {
+    return replay->holding;
+}
+
+int replay_take_released(Replay *replay) {
+    int released = replay->released;
+    replay->released = 0;
+    return released;
+}
+
+void replay_compared(Replay *replay, int changed) {
+    if (changed) {
+        replay->change_sets++;
+        if (replay->batch_start_us == NONE) {
+            replay->batch_start_us = replay->first_pending_us;
+        }
+    }
+    replay->first_pending_us = NONE;
+}
+
+void replay_applied(Replay *replay) {
+    if (replay->batch_start_us == NONE) {
+        return; // Initial start or crash restart
+    }
+    if (replay->latency_count == replay->latency_cap) {
+        size_t cap = replay->latency_cap ? replay->latency_cap * 2 : 64;
+        uint64_t *latencies = realloc(replay->latencies_us, sizeof(uint64_t) * cap);
+        if (!latencies) {
+            replay->batch_start_us = NONE;
+            return;
+        }
+        replay->latencies_us = latencies;
+        replay->latency_cap = cap;
+    }
+    uint64_t now = replay_now_us(replay);
+    replay->latencies_us[replay->latency_count++] = now > replay->batch_start_us ? now - replay->batch_start_us : 0;
+    replay->batch_start_us = NONE;
+}
+
+int replay_sleep(Replay *replay, int ms, int idle) {
+    if (!replay->virtual_clock) {
+        return 0;
+    }
+    replay->virtual_us += (uint64_t)ms * 1000;
+    return idle;
+}
+
+int replay_finished(const Replay *replay) {
+    return !replay->has_next && !replay->holding && !replay->released &&
+           replay->first_pending_us == NONE && replay->batch_start_us == NONE;
+}
+
+static int compare_u64(const void *a, const void *b) {
+    uint64_t x = *(const uint64_t *)a;
+    uint64_t y = *(const uint64_t *)b;
+    return x < y ? -1 : x > y;
+}
+
+void replay_report(const Replay *replay) {
+    printf("[Watcher stats] replay: %lu events on %d paths over %.1fs of log, %lu git holds (%s clock)\n",
+           replay->events, event_log_paths(replay->log), replay->last_event_us / 1e6, replay->holds,
+           replay->virtual_clock ? "virtual" : "real");
+    printf("[Watcher stats] replay: %lu change sets, %.1f events per change set\n",
+           replay->change_sets, replay->change_sets ? (double)replay->events / replay->change_sets : 0.0);
+    if (replay->latency_count == 0) {
+        return;
+    }
+
+    uint64_t *sorted = malloc(sizeof(uint64_t) * replay->latency_count);
+    if (!sorted) {
+        return;
+    }
+    memcpy(sorted, replay->latencies_us, sizeof(uint64_t) * replay->latency_count);
+    qsort(sorted, replay->latency_count, sizeof(uint64_t), compare_u64);
+    size_t n = replay->latency_count;
+    printf("[Watcher stats] replay: change to new code p50 %llu ms, p95 %llu ms, max %llu ms\n",
+           (unsigned long long)(sorted[(n - 1) / 2] / 1000),
+           (unsigned long long)(sorted[(n * 95 + 99) / 100 - 1] / 1000),
+           (unsigned long long)(sorted[n - 1] / 1000));
+    free(sorted);
+}
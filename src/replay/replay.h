@@ -0,0 +1,59 @@
+/*
+    Copyright © 2025 Mint teams
+    replay.h
+    The generic Node.js process watcher
+*/
+
+#ifndef REPLAY_H
+#define REPLAY_H
+
+#include <watcher/watcher.h>
+
+/*
+    Replay driver (--replay <file>). Stands in for the file system: the
+    events of a log written by --record are fed to the watch table at
+    their recorded offsets, and the usual compare and restart cycle runs
+    on them, real child processes included. Git holds in the log hold the
+    watcher the same way a live index.lock would.
+
+    With the virtual clock (the default), a tick with nothing in flight
+    advances time by its sleep without sleeping, so a recording is
+    replayed as fast as the restarts allow and batches the same way every
+    run. Restart cycles still sleep for real, the child is real. The real
+    clock replays at recorded speed.
+
+    Latency is measured from the first event of a change set to the app
+    running the new code (spawned, or soft reload acknowledged).
+*/
+typedef struct Replay Replay;
+
+Replay *replay_open(const char *path, int virtual_clock);
+void replay_close(Replay *replay);
+
+// Applies the events due by now to the table; returns how many there were.
+int replay_apply(Replay *replay, Watcher *watcher);
+
+// A replayed git operation holds the tree.
+int replay_holding(const Replay *replay);
+
+// Returns 1 once after a hold ended; the caller compares everything.
+int replay_take_released(Replay *replay);
+
+// The compare after an apply found (or didn't find) a change.
+void replay_compared(Replay *replay, int changed);
+
+// The app runs the new code: closes the latency of the change set in flight.
+void replay_applied(Replay *replay);
+
+/*
+    Call instead of the tick's sleep. Returns 1 when the virtual clock
+    took the time and no real sleep is needed (`idle`: nothing in flight).
+*/
+int replay_sleep(Replay *replay, int ms, int idle);
+
+// The log is used up and its last change set has been applied.
+int replay_finished(const Replay *replay);
+
+void replay_report(const Replay *replay);
+
+#endif // REPLAY_H
@@ -0,0 +1,165 @@
+/*
+    Copyright © 2025 Mint teams
+    trace.c
+    The generic Node.js process watcher
+*/
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <stdint.h>
+#include <time.h>
+
+#ifdef _WIN32
+#include <windows.h>
+#else
+#include <pthread.h>
+#endif
+
+#include <trace/trace.h>
+
+// All events live in one process; the tracks are its threads.
+#define TRACE_PID 1
+
+struct TraceWriter {
+    FILE *file;
+    char *path;
+    uint64_t origin_us;
+    unsigned long events;
+    #ifndef _WIN32
+    pthread_mutex_t lock;       // The watch thread writes events too
+    #endif
+};
+
+static uint64_t trace_clock_us(void) {
+#ifdef _WIN32
+    LARGE_INTEGER now, freq;
+    QueryPerformanceCounter(&now);
+    QueryPerformanceFrequency(&freq);
+    return (uint64_t)(now.QuadPart / freq.QuadPart) * 1000000 +
+           (uint64_t)(now.QuadPart % freq.QuadPart) * 1000000 / (uint64_t)freq.QuadPart;
+#else
+    struct timespec now;
+    clock_gettime(CLOCK_MONOTONIC, &now);
+    return (uint64_t)now.tv_sec * 1000000 + (uint64_t)now.tv_nsec / 1000;
+#endif
+}
+
+static void write_json_string(FILE *file, const char *text) {
+    fputc('"', file);
+    for (const unsigned char *c = (const unsigned char *)text; *c; ++c) {
+        if (*c == '"' || *c == '\\') {
+            fputc('\\', file);
+            fputc(*c, file);
+        } else if (*c < 0x20) {
+            fprintf(file, "\\u%04x", *c);
+        } else {
+            fputc(*c, file);
+        }
+    }
+    fputc('"', file);
+}
+
+static void write_event(TraceWriter *trace, char phase, TraceTrack track, const char *name, const char *detail) {
+    if (!trace) {
+        return;
+    }
+    #ifndef _WIN32
+    pthread_mutex_lock(&trace->lock);
+    #endif
+    uint64_t ts = trace_clock_us() - trace->origin_us; // Under the lock, so the file stays in time order
+
+    // Every event after the first is prefixed, so the array is valid up to the last one written
+    fprintf(trace->file, "%s{\"ph\":\"%c\",\"pid\":%d,\"tid\":%d,\"ts\":%llu",
+            trace->events ? ",\n" : "", phase, TRACE_PID, (int)track, (unsigned long long)ts);
+    if (name) {
+        fputs(",\"name\":", trace->file);
+        write_json_string(trace->file, name);
+    }
+    if (phase == 'i') {
+        fputs(",\"s\":\"t\"", trace->file); // Thread-scoped instant
+    }
+    if (detail) {
+        fputs(",\"args\":{\"detail\":", trace->file);
+        write_json_string(trace->file, detail);
+        fputc('}', trace->file);
+    }
+    fputc('}', trace->file);
+    fflush(trace->file);
+    trace->events++;
+    #ifndef _WIN32
+    pthread_mutex_unlock(&trace->lock);
+    #endif
+}
+
+static void write_metadata(TraceWriter *trace, const char *kind, int tid, const char *value) {
+    fprintf(trace->file, "%s{\"ph\":\"M\",\"pid\":%d,\"tid\":%d,\"name\":\"%s\",\"args\":{\"name\":",
+            trace->events ? ",\n" : "", TRACE_PID, tid, kind);
+    write_json_string(trace->file, value);
+    fputs("}}", trace->file);
+    trace->events++;
+}
+
+TraceWriter *trace_open(const char *path, const char *cmd) {
+    TraceWriter *trace = calloc(1, sizeof(TraceWriter));
+    if (!trace) {
+        return NULL;
+    }
+    trace->file = fopen(path, "w");
+    trace->path = strdup(path);
+    if (!trace->file || !trace->path) {
+        if (trace->file) {
+            fclose(trace->file);
+        }
+        free(trace->path);
+        free(trace);
+        return NULL;
+    }
+    trace->origin_us = trace_clock_us();
+    #ifndef _WIN32
+    pthread_mutex_init(&trace->lock, NULL);
+    #endif
+
+    char process_name[256];
+    snprintf(process_name, sizeof(process_name), "kavin: %s", cmd);
+    fputs("[\n", trace->file);
+    write_metadata(trace, "process_name", TRACE_WATCHER, process_name);
+    write_metadata(trace, "thread_name", TRACE_WATCHER, "Watcher");
+    write_metadata(trace, "thread_name", TRACE_APP, "Application");
+    write_metadata(trace, "thread_name", TRACE_GIT, "Git");
+    fflush(trace->file);
+    return trace;
+}
+
+void trace_close(TraceWriter *trace) {
+    if (!trace) {
+        return;
+    }
+    fputs("\n]\n", trace->file);
+    fclose(trace->file);
+    #ifndef _WIN32
+    pthread_mutex_destroy(&trace->lock);
+    #endif
+    free(trace->path);
+    free(trace);
+}
+
+void trace_begin(TraceWriter *trace, TraceTrack track, const char *name, const char *detail) {
+    write_event(trace, 'B', track, name, detail);
+}
+
+void trace_end(TraceWriter *trace, TraceTrack track, const char *detail) {
+    write_event(trace, 'E', track, NULL, detail);
+}
+
+void trace_instant(TraceWriter *trace, TraceTrack track, const char *name, const char *detail) {
+    write_event(trace, 'i', track, name, detail);
+}
+
+unsigned long trace_event_count(const TraceWriter *trace) {
+    return trace ? trace->events : 0;
+}
+
+const char *trace_path(const TraceWriter *trace) {
+    return trace ? trace->path : NULL;
+}
@@ -0,0 +1,38 @@
+/*
+    Copyright © 2025 Mint teams
+    trace.h
+    The generic Node.js process watcher
+*/
+
+#ifndef TRACE_H
+#define TRACE_H
+
+/*
+    Restart timeline in Chrome Trace Event format (--trace <file>).
+    Load the file in chrome://tracing or ui.perfetto.dev.
+
+    The file is a JSON array written one event at a time, so a trace cut
+    short by a crash still loads. Timestamps are monotonic microseconds
+    since the trace was opened. Every call is a no-op on a NULL writer.
+    Events may come from the watch thread as well as the supervisor.
+*/
+typedef struct TraceWriter TraceWriter;
+
+typedef enum {
+    TRACE_WATCHER = 1,  // File events, restart cycles, signals
+    TRACE_APP = 2,      // Lifetime of each child process
+    TRACE_GIT = 3       // Git holds, on their own track: the watch thread opens and closes them
+} TraceTrack;
+
+TraceWriter *trace_open(const char *path, const char *cmd);
+void trace_close(TraceWriter *trace);
+
+// `detail` is optional and shows up in the event's args.
+void trace_begin(TraceWriter *trace, TraceTrack track, const char *name, const char *detail);
+void trace_end(TraceWriter *trace, TraceTrack track, const char *detail);
+void trace_instant(TraceWriter *trace, TraceTrack track, const char *name, const char *detail);
+
+unsigned long trace_event_count(const TraceWriter *trace);
+const char *trace_path(const TraceWriter *trace);
+
+#endif // TRACE_H
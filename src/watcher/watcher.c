@@ -15,16 +15,37 @@
 #include <unistd.h>
 #include <sys/wait.h>
 #endif
+#ifdef __linux__
+#include <sys/prctl.h>
+#endif
 #include <sys/stat.h>
 
 #include <watcher/watcher.h>
 #include <watcher/watcher_actions.h>
+#include <watcher/watcher_poll.h>
+#include <watcher/watcher_fanotify.h>
+#include <watcher/watcher_inotify.h>
+#include <watcher/watcher_shared.h>
+#include <watcher/watcher_git.h>
+#include <watcher/watcher_heat.h>
+#include <watcher/watcher_scan.h>
+#include <watcher/watcher_psi.h>
+#include <watcher/watcher_thread.h>
+#include <process/sockets.h>
+#include <process/reload.h>
+#include <process/warm_cache.h>
+#include <process/build.h>
+#include <impact/impact.h>
+#include <cluster/cluster.h>
+#include <trace/trace.h>
+#include <replay/event_log.h>
+#include <replay/replay.h>
 #include <arch/syscalls.h>
+#include <arch/fingerprint.h>
 
-static const unsigned int FILE_INTERVAL_MS = 100; // 100ms
-
-void watcher_init(Watcher *watcher, const char *cmd, char **paths, int path_count) {
+void watcher_init(Watcher *watcher, const KavinOptions *options, const char *cmd, char **paths, int path_count) {
     watcher->cmd = cmd;
+    watcher->options = options;
     watcher->files_to_watch = NULL;
     watcher->dirs_to_watch = NULL;
     watcher->file_count = 0;
@@ -34,6 +55,71 @@ void watcher_init(Watcher *watcher, const char *cmd, char **paths, int path_coun
     watcher->state = STATE_RESTARTING;
     watcher->restart_count = 0;
     watcher->last_mtimes = NULL;
+    watcher->current_mtimes = NULL;
+    watcher->changed_bitmap = NULL;
+    watcher->poll_pool = NULL;
+    watcher->poll_cursor = 0;
+    watcher->poll_serial_only = 0;
+    watcher->file_heat = NULL;
+    watcher->dir_heat = NULL;
+    watcher->fanotify = NULL;
+    watcher->inotify = NULL;
+    watcher->shared = NULL;
+    watcher->stats_flag = NULL;
+    watcher->listen_fds = NULL;
+    watcher->listen_fd_count = 0;
+    watcher->impact = NULL;
+    watcher->cluster = NULL;
+    watcher->trace = NULL;
+    watcher->git = NULL;
+    watcher->record = NULL;
+    watcher->replay = NULL;
+    watcher->psi = NULL;
+    watcher->warm_cache = NULL;
+    watcher->watch_thread = NULL;
+    watcher->build = NULL;
+    memset(&watcher->build_batch, 0, sizeof(watcher->build_batch));
+    watcher->build_pending = 0;
+    watcher->build_wait_ms = 0;
+    watcher->write_generation = 0;
+    watcher->writes_seen = 0;
+    watcher->writes_reported = 0;
+    watcher->restart_due_ms = 0;
+    watcher->restart_held_ms = 0;
+    watcher->held_restarts = 0;
+    watcher->held_ms_total = 0;
+    watcher->reload_fd = -1;
+    watcher->reload_start_ms = 0;
+    watcher->soft_reloads = 0;
+    watcher->soft_reload_fallbacks = 0;
+    path_index_init(&watcher->file_index);
+
+    // Bind before the first start so the child never sees a missing socket
+    if (options->listen) {
+        watcher->listen_fd_count = sockets_listen(options->listen, &watcher->listen_fds);
+        if (watcher->listen_fd_count < 0) {
+            exit(1);
+        }
+        printf("[Watcher info] Holding %d listening socket(s) for %s\n", watcher->listen_fd_count, options->listen);
+    }
+
+    if (options->trace) {
+        watcher->trace = trace_open(options->trace, cmd);
+        if (!watcher->trace) {
+            perror("[Watcher error] Failed to open trace file");
+            exit(1);
+        }
+        printf("[Watcher info] Writing restart timeline to %s\n", options->trace);
+    }
+
+    if (options->soft_reload_ms > 0) {
+        #ifdef _WIN32
+        printf("[Watcher info] --soft-reload is not supported on Windows, restarting instead\n");
+        #else
+        printf("[Watcher info] Soft reload: the app gets KAVIN_RELOAD_FD and %d ms to acknowledge\n",
+               options->soft_reload_ms);
+        #endif
+    }
 
     // Allocate space for file and directory pointers
     watcher->files_to_watch = malloc(sizeof(char*) * path_count);
@@ -50,7 +136,12 @@ void watcher_init(Watcher *watcher, const char *cmd, char **paths, int path_coun
             if (S_ISDIR(st.st_mode)) {
                 watcher->dirs_to_watch[watcher->dir_count++] = strdup(paths[i]);
             } else if (S_ISREG(st.st_mode)) {
-                watcher->files_to_watch[watcher->file_count++] = strdup(paths[i]);
+                if (path_index_find(&watcher->file_index, watcher->files_to_watch, paths[i]) >= 0) {
+                    continue; // Listed twice
+                }
+                watcher->files_to_watch[watcher->file_count] = strdup(paths[i]);
+                path_index_insert(&watcher->file_index, watcher->files_to_watch, watcher->file_count);
+                watcher->file_count++;
             }
         } else {
             fprintf(stderr, "[Watcher warning] Path not found and will be ignored: %s\n", paths[i]);
@@ -61,16 +152,332 @@ void watcher_init(Watcher *watcher, const char *cmd, char **paths, int path_coun
     watcher->files_to_watch = realloc(watcher->files_to_watch, sizeof(char*) * watcher->file_count);
     watcher->dirs_to_watch = realloc(watcher->dirs_to_watch, sizeof(char*) * watcher->dir_count);
     watcher->last_mtimes = malloc(sizeof(time_t) * watcher->file_count);
-    if (!watcher->last_mtimes) {
+    watcher->current_mtimes = malloc(sizeof(time_t) * watcher->file_count);
+    watcher->changed_bitmap = malloc(sizeof(uint64_t) * (FINGERPRINT_BITMAP_WORDS(watcher->file_count) + 1)); // +1: never malloc(0)
+    if (!watcher->last_mtimes || !watcher->current_mtimes || !watcher->changed_bitmap) {
         perror("Failed to allocate memory for mtimes");
         exit(1);
     }
+    fingerprint_init();
+}
+
+uint64_t watcher_clock_ms(void) {
+#ifdef _WIN32
+    return GetTickCount64();
+#else
+    struct timespec now;
+    clock_gettime(CLOCK_MONOTONIC, &now);
+    return (uint64_t)now.tv_sec * 1000 + (uint64_t)now.tv_nsec / 1000000;
+#endif
+}
+
+static void watcher_open_backend(Watcher *watcher) {
+    const char *backend = watcher->options->backend;
+    int is_auto = strcmp(backend, "auto") == 0;
+
+    // Never picked by "auto": it starts a daemon that outlives this process.
+    if (strcmp(backend, "shared") == 0) {
+        watcher->shared = shared_backend_open(watcher->files_to_watch, watcher->file_count,
+                                              watcher->dirs_to_watch, watcher->dir_count);
+        if (watcher->shared) {
+            printf("[Watcher info] Using kavind (%d director%s registered)\n",
+                   shared_backend_dirs(watcher->shared), shared_backend_dirs(watcher->shared) == 1 ? "y" : "ies");
+        } else {
+            perror("[Watcher warning] kavind unavailable, falling back to polling");
+        }
+        return;
+    }
+
+    if (is_auto || strcmp(backend, "fanotify") == 0) {
+        watcher->fanotify = fanotify_backend_open(watcher->files_to_watch, watcher->file_count,
+                                                  watcher->dirs_to_watch, watcher->dir_count);
+        if (watcher->fanotify) {
+            printf("[Watcher info] Using fanotify (%d filesystem mark%s)\n",
+                   fanotify_backend_marks(watcher->fanotify),
+                   fanotify_backend_marks(watcher->fanotify) == 1 ? "" : "s");
+            return;
+        }
+        // "auto" falls back quietly; an explicit request deserves a reason.
+        if (!is_auto) {
+            perror("[Watcher warning] fanotify unavailable, falling back to polling");
+            return;
+        }
+    }
+
+    if (is_auto || strcmp(backend, "inotify") == 0) {
+        watcher->inotify = inotify_backend_open(watcher, watcher->options->watch_budget);
+        if (watcher->inotify) {
+            printf("[Watcher info] Using inotify\n");
+            return;
+        }
+        if (!is_auto) {
+            perror("[Watcher warning] inotify unavailable, falling back to polling");
+        }
+    }
+}
+
+void watcher_print_stats(const Watcher *watcher) {
+    // The table, its backends and their counters belong to the watch thread mid-pass
+    if (watcher->watch_thread) {
+        watch_thread_lock(watcher->watch_thread);
+    }
+    printf("[Watcher stats] %d files, %d directories, %lu restarts, %s compare\n",
+           watcher->file_count, watcher->dir_count, watcher->restart_count, fingerprint_kernel_name());
+    if (watcher->fanotify) {
+        printf("[Watcher stats] fanotify: %d filesystem marks\n", fanotify_backend_marks(watcher->fanotify));
+    } else if (watcher->inotify) {
+        inotify_backend_print_stats(watcher->inotify);
+    } else if (watcher->shared) {
+        printf("[Watcher stats] kavind: %d directories registered\n", shared_backend_dirs(watcher->shared));
+    } else {
+        printf("[Watcher stats] polling with %d stat worker%s\n", poll_pool_workers(watcher->poll_pool),
+               poll_pool_workers(watcher->poll_pool) == 1 ? "" : "s");
+        if (watcher->file_heat) {
+            PollHeatStats files, dirs;
+            poll_heat_stats(watcher->file_heat, &files);
+            poll_heat_stats(watcher->dir_heat, &dirs);
+            printf("[Watcher stats] polling: %d hot, %d cooling, %d cold files, %lu stat calls, %lu directory scans\n",
+                   files.hot, files.cooling, files.cold, files.polls, dirs.polls);
+        }
+    }
+    if (watcher->options->soft_reload_ms > 0) {
+        printf("[Watcher stats] soft reload: %lu handled in place, %lu fell back to a restart\n",
+               watcher->soft_reloads, watcher->soft_reload_fallbacks);
+    }
+    if (watcher->git) {
+        printf("[Watcher stats] git: on %s, %lu operations held\n", git_guard_head(watcher->git), git_guard_holds(watcher->git));
+    }
+    if (watcher->cluster) {
+        cluster_print_stats(watcher->cluster);
+    }
+    if (watcher->trace) {
+        printf("[Watcher stats] trace: %lu events in %s\n", trace_event_count(watcher->trace), trace_path(watcher->trace));
+    }
+    if (watcher->record) {
+        printf("[Watcher stats] record: %lu events in %s\n", event_log_written(watcher->record), watcher->options->record);
+    }
+    if (watcher->replay) {
+        replay_report(watcher->replay);
+    }
+    if (watcher->warm_cache) {
+        warm_cache_print_stats(watcher->warm_cache);
+    }
+    if (watcher->psi) {
+        PsiLevels levels;
+        psi_guard_levels(watcher->psi, &levels);
+        printf("[Watcher stats] psi: cpu %.0f%%, memory %.0f%%, io %.0f%% (%s)%s\n",
+               levels.cpu, levels.memory, levels.io, psi_guard_source(watcher->psi),
+               psi_guard_throttled(watcher->psi) ? ", throttling" : "");
+        printf("[Watcher stats] psi: throttled %lu times for %.1fs, %lu restarts held for %.1fs, children at %s priority\n",
+               psi_guard_episodes(watcher->psi), psi_guard_throttled_ms(watcher->psi, watcher_clock_ms()) / 1e3,
+               watcher->held_restarts, watcher->held_ms_total / 1e3,
+               strcmp(watcher->options->psi_priority, "off") == 0 ? "normal" : watcher->options->psi_priority);
+    }
+    if (watcher->build) {
+        build_step_print_stats(watcher->build);
+    }
+    if (watcher->watch_thread) {
+        watch_thread_print_stats(watcher->watch_thread);
+        watch_thread_unlock(watcher->watch_thread);
+    }
+}
+
+/*
+    Polling with heat sleeps until the next file or directory is due, up
+    to --poll-max, so a quiet tree costs a wakeup every couple of seconds.
+    Everything else watches every --poll-interval.
+*/
+int watcher_watch_sleep_ms(const Watcher *watcher) {
+    int base = watcher->options->poll_interval_ms;
+    if (!watcher->file_heat || watcher->fanotify || watcher->inotify || watcher->shared ||
+        (watcher->git && git_guard_holding(watcher->git))) {
+        return base;
+    }
+
+    uint64_t next = poll_heat_next_ms(watcher->file_heat);
+    uint64_t next_dir = poll_heat_next_ms(watcher->dir_heat);
+    if (next_dir < next) {
+        next = next_dir;
+    }
+    uint64_t now = watcher_clock_ms();
+    uint64_t wait = next > now ? next - now : 0;
+    if (wait > (uint64_t)watcher->options->poll_max_ms) {
+        wait = (uint64_t)watcher->options->poll_max_ms;
+    }
+    return wait > (uint64_t)base ? (int)wait : base;
+}
+
+/*
+    Time until the next tick. Watching inline, a quiet tree lets the
+    supervisor sleep as long as the watch schedule does; with anything
+    in flight, and always with the watch thread or replicas (READY=1,
+    kill deadlines and rolling restarts run on cluster ticks), it ticks
+    at --poll-interval.
+*/
+static int tick_sleep_ms(const Watcher *watcher) {
+    if (watcher->watch_thread || watcher->cluster || watcher->impact || watcher->state != STATE_RUNNING ||
+        watcher->restart_due_ms || watcher->build_pending || warm_cache_timing(watcher->warm_cache)) {
+        return watcher->options->poll_interval_ms;
+    }
+    return watcher_watch_sleep_ms(watcher);
+}
+
+static void watcher_sleep(const Watcher *watcher, int ms) {
+    // Virtual clock: unless a real child is being waited on, the time passes without waiting
+    if (watcher->replay && replay_sleep(watcher->replay, ms, watcher->state == STATE_RUNNING ||
+                                                             watcher->state == STATE_RESTARTING)) {
+        return;
+    }
+    if (watcher->watch_thread) {
+        watch_thread_wait(watcher->watch_thread, ms); // Also cut short by a published change set
+        return;
+    }
+    #ifdef _WIN32
+    (void)watcher;
+    Sleep(ms);
+    #else
+    #ifdef __linux__
+    // Let the kernel batch our wakeup with others: 10% of the sleep is never noticed
+    static unsigned long slack_ns = 0;
+    if (watcher->file_heat && slack_ns != (unsigned long)ms * 100000) {
+        slack_ns = (unsigned long)ms * 100000;
+        prctl(PR_SET_TIMERSLACK, slack_ns, 0, 0, 0);
+    }
+    #else
+    (void)watcher;
+    #endif
+    // Cut short by SIGCHLD, so a crash is noticed right away even in a long sleep
+    struct timespec delay = { ms / 1000, (long)(ms % 1000) * 1000000 };
+    nanosleep(&delay, NULL);
+    #endif
+}
+
+static void watcher_initial_scan(Watcher *watcher) {
+    ScanStats scan;
+    if (watcher->options->scan_workers == 1 || watcher->dir_count == 0 ||
+        watcher_scan_parallel(watcher, watcher->options->scan_workers, &scan) != 0) {
+        watcher_rescan_directories(watcher);
+        return;
+    }
+
+    double seconds = scan.elapsed_us / 1e6;
+    printf("[Watcher info] Scanned %d directories: %lu entries, %d files in %.3fs "
+           "(%.0f entries/s, %d threads, %lu stats, %lu steals)\n",
+           watcher->dir_count, scan.entries, scan.files, seconds,
+           seconds > 0 ? scan.entries / seconds : 0.0, scan.workers, scan.stats, scan.steals);
+}
+
+static void watcher_open_psi(Watcher *watcher) {
+    const KavinOptions *options = watcher->options;
+    if (strcmp(options->psi, "off") == 0) {
+        return;
+    }
+    watcher->psi = psi_guard_open(options->psi, options->psi_threshold);
+    if (!watcher->psi) {
+        // "auto" stays quiet on kernels and platforms without PSI
+        if (strcmp(options->psi, "auto") != 0) {
+            fprintf(stderr, "[Watcher warning] No %s pressure stall information, --psi is ignored\n", options->psi);
+        }
+        return;
+    }
+    printf("[Watcher info] Watching pressure in %s: throttling at %d%%\n", psi_guard_source(watcher->psi),
+           options->psi_threshold);
+}
+
+// Logs throttling as it starts and stops; the hold itself is decided per change.
+static void watcher_poll_psi(Watcher *watcher) {
+    if (!watcher->psi || !psi_guard_poll(watcher->psi, watcher_clock_ms())) {
+        return;
+    }
+    double percent;
+    const char *worst = psi_guard_worst(watcher->psi, &percent);
+    char detail[32];
+    snprintf(detail, sizeof(detail), "%s %.0f%%", worst, percent);
+    if (psi_guard_throttled(watcher->psi)) {
+        printf("[Watcher info] System under pressure (%s), restarts wait %d ms after the last change%s%s\n",
+               detail, watcher->options->psi_debounce_ms,
+               watcher_child_priority(watcher) != PROCESS_PRIORITY_NORMAL ? ", children start at " : "",
+               watcher_child_priority(watcher) != PROCESS_PRIORITY_NORMAL ? watcher->options->psi_priority : "");
+        trace_instant(watcher->trace, TRACE_WATCHER, "Pressure", detail);
+    } else {
+        printf("[Watcher info] Pressure cleared (%s), back to normal\n", detail);
+        trace_instant(watcher->trace, TRACE_WATCHER, "Pressure cleared", detail);
+    }
+}
+
+static void watcher_open_warm_cache(Watcher *watcher) {
+    watcher->warm_cache = warm_cache_open(watcher->options->warm_cache, watcher->options->warm_cache_max_mb);
+    if (!watcher->warm_cache) {
+        fprintf(stderr, "[Watcher warning] Can't create the warm cache directory, children start cold\n");
+        return;
+    }
+    const char *dir = warm_cache_dir(watcher->warm_cache);
+    printf("[Watcher info] Warm cache in %s\n", dir);
+
+    // The runtime writes there on every start; inside the tree, each write would be a change
+    #ifndef _WIN32
+    char real_cache[4096];
+    char real_dir[4096];
+    if (!realpath(dir, real_cache)) {
+        return;
+    }
+    size_t len;
+    for (int i = 0; i < watcher->dir_count; ++i) {
+        if (realpath(watcher->dirs_to_watch[i], real_dir) && (len = strlen(real_dir)) > 0 &&
+            strncmp(real_cache, real_dir, len) == 0 && (real_cache[len] == '/' || real_cache[len] == '\0' || len == 1)) {
+            fprintf(stderr, "[Watcher warning] The warm cache is inside watched directory %s, "
+                            "cache writes will look like changes\n", watcher->dirs_to_watch[i]);
+            break;
+        }
+    }
+    #endif
+}
+
+static void watcher_open_build(Watcher *watcher) {
+    watcher->build = build_step_create(watcher->options->build);
+    if (!watcher->build) {
+        fprintf(stderr, "[Watcher error] Failed to set up --build\n");
+        exit(1);
+    }
+    printf("[Watcher info] Build: %s\n", watcher->options->build);
+
+    // The first start waits for a build like any change: nothing to stop yet
+    watcher->build_pending = 1;
+    watcher->build_wait_ms = watcher_clock_ms();
+    watcher->state = STATE_RUNNING;
+
+    if (strcmp(watcher->options->build_speculative, "on") != 0) {
+        return;
+    }
+    if (watcher->inotify) {
+        inotify_backend_report_writes(watcher->inotify);
+    } else if (!watcher->fanotify || fanotify_backend_report_writes(watcher->fanotify, watcher_on_write) != 0) {
+        fprintf(stderr, "[Watcher warning] --build-speculative needs the inotify or fanotify backend, "
+                        "builds start once a save is complete\n");
+        return;
+    }
+    watcher->writes_reported = 1;
+    printf("[Watcher info] Speculative builds: starting on the first write of a save\n");
+}
+
+static void watcher_open_replay(Watcher *watcher) {
+    if (strcmp(watcher->options->test_map, "off") != 0 || watcher->options->replicas > 1) {
+        fprintf(stderr, "[Watcher error] --replay drives the restart cycle and can't be combined with --test-map or --replicas\n");
+        exit(1);
+    }
+    watcher->replay = replay_open(watcher->options->replay, strcmp(watcher->options->replay_clock, "virtual") == 0);
+    if (!watcher->replay) {
+        exit(1);
+    }
+    printf("[Watcher info] Replaying %s with the %s clock instead of watching\n",
+           watcher->options->replay, watcher->options->replay_clock);
 }
 
 void watcher_run(Watcher *watcher, volatile sig_atomic_t *running_flag) {
     // Initial check and population of modification times
     for (int i = 0; i < watcher->file_count; ++i) {
         watcher->last_mtimes[i] = get_mtime_asm(watcher->files_to_watch[i]);
+        watcher->current_mtimes[i] = watcher->last_mtimes[i];
         printf("[Watcher info] Watching: %s\n", watcher->files_to_watch[i]);
     }
     for (int i = 0; i < watcher->dir_count; ++i) {
@@ -79,31 +486,132 @@ void watcher_run(Watcher *watcher, volatile sig_atomic_t *running_flag) {
 
     printf("[Watcher info] Command: %s\n", watcher->cmd);
 
+    if (watcher->options->replay) {
+        watcher_open_replay(watcher);
+    } else {
+        // Event backends only report changes, so enumerate the directories once up front.
+        watcher_initial_scan(watcher);
+        watcher_open_backend(watcher);
+
+        if (strcmp(watcher->options->git, "off") != 0 && (watcher->dir_count > 0 || watcher->file_count > 0)) {
+            watcher->git = git_guard_open(watcher->dir_count > 0 ? watcher->dirs_to_watch[0] : watcher->files_to_watch[0]);
+            if (watcher->git) {
+                printf("[Watcher info] Holding changes during git operations (%s, on %s)\n",
+                       git_guard_dir(watcher->git), git_guard_head(watcher->git));
+            }
+        }
+
+        // Not with --replay: a hold would depend on the machine, not the log
+        watcher_open_psi(watcher);
+    }
+
+    // Opened after the initial scan, which isn't a change
+    if (watcher->options->record) {
+        watcher->record = event_log_create(watcher->options->record);
+        if (!watcher->record) {
+            perror("[Watcher error] Failed to open event log");
+            exit(1);
+        }
+        printf("[Watcher info] Recording change events to %s\n", watcher->options->record);
+    }
+
+    // Before test-impact and cluster mode, whose children get it too
+    if (watcher->options->warm_cache) {
+        watcher_open_warm_cache(watcher);
+    }
+
+    if (watcher->options->build && (strcmp(watcher->options->test_map, "off") != 0 || watcher->options->replicas > 1)) {
+        fprintf(stderr, "[Watcher warning] --build is ignored with --test-map and --replicas\n");
+    }
+
+    if (strcmp(watcher->options->test_map, "off") != 0) {
+        if (watcher->options->replicas > 1) {
+            fprintf(stderr, "[Watcher warning] --replicas is ignored with --test-map\n");
+        }
+        watcher->impact = impact_open(watcher);
+        if (!watcher->impact) {
+            fprintf(stderr, "[Watcher error] Failed to start test-impact mode\n");
+            exit(1);
+        }
+    } else if (watcher->options->replicas > 1) {
+        if (watcher->options->soft_reload_ms > 0) {
+            fprintf(stderr, "[Watcher warning] --soft-reload is ignored with --replicas, replicas are rolled instead\n");
+        }
+        watcher->cluster = cluster_open(watcher);
+        if (!watcher->cluster) {
+            fprintf(stderr, "[Watcher error] Failed to start cluster mode\n");
+            exit(1);
+        }
+    } else {
+        trace_begin(watcher->trace, TRACE_WATCHER, "Start", NULL); // Ended by the first spawn
+        if (watcher->options->build) {
+            watcher_open_build(watcher);
+        }
+    }
+
+    // Test-impact mode maps the table on every change set, and a replay is paced by the ticks: both stay inline
+    if (strcmp(watcher->options->watch_thread, "on") == 0 && !watcher->impact && !watcher->replay) {
+        watcher->watch_thread = watch_thread_start(watcher);
+    }
+
     while (*running_flag) {
-        switch (watcher->state) {
-            case STATE_RUNNING:
-                handle_state_running(watcher);
-                break;
+        if (watcher->stats_flag && *watcher->stats_flag) {
+            *watcher->stats_flag = 0;
+            watcher_print_stats(watcher);
+        }
+
+        watcher_poll_psi(watcher);
+
+        if (watcher->impact) {
+            // No long-running child: each change set becomes a batch of test runs.
+            if (check_for_file_changes(watcher)) {
+                impact_on_changes(watcher->impact, watcher);
+            }
+            impact_set_priority(watcher->impact, watcher_child_priority(watcher));
+            impact_tick(watcher->impact);
+        } else if (watcher->cluster) {
+            ChangeBatch batch;
+            if (watcher_take_changes(watcher, &batch)) {
+                cluster_on_change(watcher->cluster);
+            }
+            free(batch.lines);
+            cluster_tick(watcher->cluster);
+        } else {
+            switch (watcher->state) {
+                case STATE_RUNNING:
+                    handle_state_running(watcher);
+                    break;
+
+                case STATE_SHUTTING_DOWN:
+                    handle_state_shutting_down(watcher);
+                    break;
 
-            case STATE_SHUTTING_DOWN:
-                handle_state_shutting_down(watcher);
-                break;
+                case STATE_FORCE_KILLING:
+                    handle_state_force_killing(watcher);
+                    break;
 
-            case STATE_FORCE_KILLING:
-                handle_state_force_killing(watcher);
-                break;
+                case STATE_RESTARTING:
+                    handle_state_restarting(watcher);
+                    break;
 
-            case STATE_RESTARTING:
-                handle_state_restarting(watcher);
-                break;
+                case STATE_RELOADING:
+                    handle_state_reloading(watcher);
+                    break;
+            }
+        }
+
+        if (!watcher->watch_thread) {
+            event_log_flush(watcher->record); // The thread flushes after its own passes
+        }
+
+        if (watcher->replay && watcher->state == STATE_RUNNING && replay_finished(watcher->replay)) {
+            printf("[Watcher info] Replay finished\n");
+            replay_report(watcher->replay);
+            break;
         }
 
         if (*running_flag) {
-            #ifdef _WIN32
-            Sleep(FILE_INTERVAL_MS);
-            #else
-            usleep(FILE_INTERVAL_MS * 1000);
-            #endif
+            watcher_sleep(watcher, tick_sleep_ms(watcher));
         }
     }
 
@@ -111,10 +619,57 @@ void watcher_run(Watcher *watcher, volatile sig_atomic_t *running_flag) {
         printf("\n[Watcher info] Shutting down process (PID: %lld)...\n", (long long)watcher->process_id);
         watcher_initiate_shutdown(watcher);
         #ifndef _WIN32
-        waitpid(watcher->process_id, NULL, 0);
+        int status = 0;
+        if (waitpid(watcher->process_id, &status, 0) == watcher->process_id) {
+            watcher_trace_exit(watcher, status, 1);
+        }
         #endif
     }
 
+    // Everything below reads or frees what the thread works on
+    watch_thread_stop(watcher->watch_thread);
+    watcher->watch_thread = NULL;
+    build_step_destroy(watcher->build);
+    watcher->build = NULL;
+    free(watcher->build_batch.lines);
+    memset(&watcher->build_batch, 0, sizeof(watcher->build_batch));
+    cluster_close(watcher->cluster);
+    watcher->cluster = NULL;
+    impact_close(watcher->impact);
+    watcher->impact = NULL;
+
+    // Stop the stat threads before the table they read goes away
+    poll_pool_destroy(watcher->poll_pool);
+    watcher->poll_pool = NULL;
+    poll_heat_destroy(watcher->file_heat);
+    watcher->file_heat = NULL;
+    poll_heat_destroy(watcher->dir_heat);
+    watcher->dir_heat = NULL;
+    fanotify_backend_close(watcher->fanotify);
+    watcher->fanotify = NULL;
+    inotify_backend_close(watcher->inotify);
+    watcher->inotify = NULL;
+    shared_backend_close(watcher->shared);
+    watcher->shared = NULL;
+    git_guard_close(watcher->git);
+    watcher->git = NULL;
+    psi_guard_close(watcher->psi);
+    watcher->psi = NULL;
+    warm_cache_close(watcher->warm_cache);
+    watcher->warm_cache = NULL;
+    reload_channel_close(watcher->reload_fd);
+    watcher->reload_fd = -1;
+    watcher->stats_flag = NULL;
+    sockets_close(watcher->listen_fds, watcher->listen_fd_count);
+    watcher->listen_fds = NULL;
+    watcher->listen_fd_count = 0;
+    trace_close(watcher->trace);
+    watcher->trace = NULL;
+    event_log_close(watcher->record);
+    watcher->record = NULL;
+    replay_close(watcher->replay);
+    watcher->replay = NULL;
+
     // Free allocated memory
     for (int i = 0; i < watcher->file_count; ++i) {
         free(watcher->files_to_watch[i]);
@@ -125,4 +680,7 @@ void watcher_run(Watcher *watcher, volatile sig_atomic_t *running_flag) {
     free(watcher->files_to_watch);
     free(watcher->dirs_to_watch);
     free(watcher->last_mtimes);
+    free(watcher->current_mtimes);
+    free(watcher->changed_bitmap);
+    path_index_free(&watcher->file_index);
 }
\ No newline at end of file
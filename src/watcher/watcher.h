@@ -8,6 +8,7 @@
 #define WATCHER_H
 
 #include <signal.h>
+#include <stdint.h>
 #include <sys/types.h>
 #include <time.h>
 
@@ -17,20 +18,99 @@
 #include <unistd.h> // For useconds_t
 #endif
 
+#include <options/options.h>
+#include <watcher/watcher_index.h>
+
+struct PollPool;
+struct PollHeat;
+struct FanotifyBackend;
+struct InotifyBackend;
+struct SharedBackend;
+struct TestImpact;
+struct TraceWriter;
+struct GitGuard;
+struct Cluster;
+struct EventLogWriter;
+struct Replay;
+struct PsiGuard;
+struct WarmCache;
+struct WatchThread;
+struct BuildStep;
+
+/*
+    Called by event backends for each change on a watched path.
+    `in_watched_dir` is set when the path sits in a watched directory,
+    so a file the table doesn't know yet should be picked up.
+    Returns 1 when the path is (now) in the watch table.
+*/
+typedef int (*WatchEventFn)(void *ctx, const char *path, int in_watched_dir);
+
+/*
+    One change set, as handed from the watch thread to the supervisor.
+    `lines` holds the soft-reload lines ("changed <path>" / "deleted
+    <path>") when --soft-reload is on; NULL there means they could not be
+    built and the change restarts instead. The taker frees `lines`.
+*/
+typedef struct {
+    int changed;
+    char *lines;
+    size_t len;
+    int files;
+} ChangeBatch;
+
 typedef enum {
     STATE_RUNNING,
     STATE_SHUTTING_DOWN,
     STATE_FORCE_KILLING,
-    STATE_RESTARTING
+    STATE_RESTARTING,
+    STATE_RELOADING     // Waiting for the app to ack a soft reload
 } WatcherState;
 
 typedef struct {
     const char *cmd;
+    const KavinOptions *options;
     char **files_to_watch;
     char **dirs_to_watch;
     int file_count;
     int dir_count;
     time_t *last_mtimes;
+    time_t *current_mtimes; // Latest stat results, compared against last_mtimes
+    uint64_t *changed_bitmap; // One bit per entry, scratch for compare_mtimes
+    struct PollPool *poll_pool; // NULL while polling serially
+    int poll_cursor;            // Where the next budgeted pass starts
+    int poll_serial_only;       // Set once the stat pool failed to start
+    struct PollHeat *file_heat; // Per-file polling schedule, NULL with --poll-max 0
+    struct PollHeat *dir_heat;  // Same for directory rescans
+    struct FanotifyBackend *fanotify; // NULL unless --backend fanotify/auto got it
+    struct InotifyBackend *inotify;   // NULL unless --backend inotify/auto got it
+    struct SharedBackend *shared;     // NULL unless --backend shared reached kavind
+    PathIndex file_index;       // files_to_watch lookup by path
+    int *listen_fds;            // --listen sockets, kept open across restarts
+    struct TestImpact *impact;  // Set in test-impact mode, replaces the restart cycle
+    struct Cluster *cluster;    // Set with --replicas > 1, replaces the restart cycle
+    struct TraceWriter *trace;  // --trace timeline, NULL when off
+    struct GitGuard *git;       // Set when the watched tree is in a git repository
+    struct EventLogWriter *record; // --record log, NULL when off
+    struct Replay *replay;      // --replay driver, replaces the file system
+    struct PsiGuard *psi;       // Pressure stall info, NULL when off or unavailable
+    struct WarmCache *warm_cache; // --warm-cache directory handed to the children, NULL when off
+    struct WatchThread *watch_thread; // Owns the watch table while set; NULL when watching inline
+    struct BuildStep *build;    // --build runner, NULL without one
+    ChangeBatch build_batch;    // Changes waiting for a passing build
+    int build_pending;          // Set while a change (or the first start) waits for the build
+    uint64_t build_wait_ms;     // When it started waiting
+    uint64_t write_generation;  // Writes seen under watched paths; bumped by the watch side, atomically
+    uint64_t writes_seen;       // write_generation the supervisor last acted on
+    int writes_reported;        // The backend reports writes; without it every change is a new generation
+    uint64_t restart_due_ms;    // A restart held under pressure goes ahead at this time, 0 = none
+    uint64_t restart_held_ms;   // When the held restart was first due
+    unsigned long held_restarts;
+    uint64_t held_ms_total;
+    int listen_fd_count;
+    int reload_fd;              // Our end of the --soft-reload channel, -1 without one
+    uint64_t reload_start_ms;
+    unsigned long soft_reloads;
+    unsigned long soft_reload_fallbacks;
     pid_t process_id;
     volatile sig_atomic_t running;
     WatcherState state;
@@ -40,9 +120,17 @@ typedef struct {
     struct timespec shutdown_start_time;
 #endif
     unsigned long restart_count;
+    volatile sig_atomic_t *stats_flag; // Set by a signal handler to print stats, may be NULL
 } Watcher;
 
-void watcher_init(Watcher *watcher, const char *cmd, char **paths, int path_count);
+void watcher_init(Watcher *watcher, const KavinOptions *options, const char *cmd, char **paths, int path_count);
 void watcher_run(Watcher *watcher, volatile sig_atomic_t *running_flag);
+void watcher_print_stats(const Watcher *watcher);
+
+// Monotonic milliseconds
+uint64_t watcher_clock_ms(void);
+
+// Time until the next watch pass is due
+int watcher_watch_sleep_ms(const Watcher *watcher);
 
 #endif // WATCHER_H
\ No newline at end of file
@@ -17,34 +17,76 @@
 #include <sys/wait.h>
 #include <unistd.h>
 #include <dirent.h>
+#include <limits.h>
 #endif
 
 // Project-specific headers
 #include "watcher_actions.h"
 #include "../process/process.h"
+#include <process/reload.h>
+#include <process/warm_cache.h>
+#include <process/build.h>
+#include <watcher/watcher_poll.h>
+#include <watcher/watcher_heat.h>
+#include <watcher/watcher_fanotify.h>
+#include <watcher/watcher_inotify.h>
+#include <watcher/watcher_shared.h>
+#include <watcher/watcher_git.h>
+#include <watcher/watcher_psi.h>
+#include <watcher/watcher_thread.h>
 #include <arch/syscalls.h>
+#include <arch/fingerprint.h>
+#include <trace/trace.h>
+#include <replay/event_log.h>
+#include <replay/replay.h>
+
+// Tables at least this large get a stat pool when --poll-workers is auto.
+static const int POLL_PARALLEL_MIN_FILES = 512;
+static const int POLL_AUTO_WORKERS = 4;
+
+// A bulk change (checkout, npm install) gets a summary event past this many files.
+static const int TRACE_FILE_EVENTS_MAX = 32;
+
+// Under pressure, saves keep pushing the restart back, but never past this many debounces.
+static const uint64_t PSI_HOLD_MAX_WINDOWS = 4;
+
+// Sizes the table arrays for `new_count` entries; -1 when out of memory.
+static int grow_table(Watcher *watcher, int new_count) {
+    char **new_files = realloc(watcher->files_to_watch, sizeof(char *) * new_count);
+    if (new_files) {
+        watcher->files_to_watch = new_files;
+    }
+    time_t *new_mtimes = realloc(watcher->last_mtimes, sizeof(time_t) * new_count);
+    if (new_mtimes) {
+        watcher->last_mtimes = new_mtimes;
+    }
+    time_t *new_current = realloc(watcher->current_mtimes, sizeof(time_t) * new_count);
+    if (new_current) {
+        watcher->current_mtimes = new_current;
+    }
+    uint64_t *new_bitmap = watcher->changed_bitmap;
+    if (FINGERPRINT_BITMAP_WORDS(new_count) > FINGERPRINT_BITMAP_WORDS(watcher->file_count)) {
+        new_bitmap = realloc(watcher->changed_bitmap, sizeof(uint64_t) * FINGERPRINT_BITMAP_WORDS(new_count));
+        if (new_bitmap) {
+            watcher->changed_bitmap = new_bitmap;
+        }
+    }
+    return new_files && new_mtimes && new_current && new_bitmap ? 0 : -1;
+}
 
 static void add_watched_file(Watcher *watcher, const char *filepath) {
     // Check if file is already watched
-    for (int i = 0; i < watcher->file_count; ++i) {
-        if (strcmp(watcher->files_to_watch[i], filepath) == 0) {
-            return;
-        }
+    if (path_index_find(&watcher->file_index, watcher->files_to_watch, filepath) >= 0) {
+        return;
     }
 
     // Expand arrays if needed
     int new_count = watcher->file_count + 1;
-    char **new_files = realloc(watcher->files_to_watch, sizeof(char *) * new_count);
-    time_t *new_mtimes = realloc(watcher->last_mtimes, sizeof(time_t) * new_count);
-
-    if (!new_files || !new_mtimes) {
+    if (grow_table(watcher, new_count) != 0) {
         perror("Failed to reallocate memory for new file");
         return;
     }
 
-    watcher->files_to_watch = new_files;
-    watcher->last_mtimes = new_mtimes;
-
     watcher->files_to_watch[watcher->file_count] = strdup(filepath);
     if (!watcher->files_to_watch[watcher->file_count]) {
         perror("Failed to duplicate filepath string");
@@ -52,98 +94,778 @@ static void add_watched_file(Watcher *watcher, const char *filepath) {
     }
     
     watcher->last_mtimes[watcher->file_count] = get_mtime_asm(filepath);
+    watcher->current_mtimes[watcher->file_count] = watcher->last_mtimes[watcher->file_count];
+    path_index_insert(&watcher->file_index, watcher->files_to_watch, watcher->file_count);
     watcher->file_count = new_count;
+    if (watcher->inotify) {
+        inotify_backend_file_added(watcher->inotify, watcher, new_count - 1);
+    }
 
+    event_log_write(watcher->record, EVENT_CREATED, filepath);
     printf("[Watcher info] Now watching new file: %s\n", filepath);
 }
 
-static void rescan_directories(Watcher *watcher) {
-    #ifdef _WIN32
-    for (int i = 0; i < watcher->dir_count; ++i) {
-        char search_path[1024];
-        snprintf(search_path, sizeof(search_path), "%s\\*.*", watcher->dirs_to_watch[i]);
-        
-        WIN32_FIND_DATA find_data;
-        HANDLE h_find = FindFirstFile(search_path, &find_data);
+int watcher_add_files(Watcher *watcher, char **paths, const time_t *mtimes, int count) {
+    if (count <= 0) {
+        return 0;
+    }
+    if (grow_table(watcher, watcher->file_count + count) != 0) {
+        perror("Failed to reallocate memory for scanned files");
+        for (int k = 0; k < count; ++k) {
+            free(paths[k]);
+        }
+        return 0;
+    }
 
-        if (h_find == INVALID_HANDLE_VALUE) {
+    int added = 0;
+    for (int k = 0; k < count; ++k) {
+        if (path_index_find(&watcher->file_index, watcher->files_to_watch, paths[k]) >= 0) {
+            free(paths[k]); // Listed explicitly, or its directory was given twice
             continue;
         }
+        int i = watcher->file_count;
+        watcher->files_to_watch[i] = paths[k];
+        watcher->last_mtimes[i] = mtimes[k];
+        watcher->current_mtimes[i] = mtimes[k];
+        path_index_insert(&watcher->file_index, watcher->files_to_watch, i);
+        watcher->file_count++;
+        if (watcher->inotify) {
+            inotify_backend_file_added(watcher->inotify, watcher, i);
+        }
+        added++;
+    }
+    return added;
+}
 
-        do {
-            // Check if it's a file and not a directory
-            if (!(find_data.dwFileAttributes & FILE_ATTRIBUTE_DIRECTORY)) {
-                /*
-                    This example doesn't filter by extension,
-                    But you could add `strstr(find_data.cFileName, ".js")` here.
-                */
-                char filepath[1024];
-                snprintf(filepath, sizeof(filepath), "%s\\%s", watcher->dirs_to_watch[i], find_data.cFileName);
-                add_watched_file(watcher, filepath);
-            }
-        } while (FindNextFile(h_find, &find_data) != 0);
+void watcher_scan_directory(Watcher *watcher, const char *dirpath) {
+    #ifdef _WIN32
+    char search_path[1024];
+    snprintf(search_path, sizeof(search_path), "%s\\*.*", dirpath);
+
+    WIN32_FIND_DATA find_data;
+    HANDLE h_find = FindFirstFile(search_path, &find_data);
 
-        FindClose(h_find);
+    if (h_find == INVALID_HANDLE_VALUE) {
+        return;
     }
+
+    do {
+        // Check if it's a file and not a directory
+        if (!(find_data.dwFileAttributes & FILE_ATTRIBUTE_DIRECTORY)) {
+            /*
+                This example doesn't filter by extension,
+                But you could add `strstr(find_data.cFileName, ".js")` here.
+            */
+            char filepath[1024];
+            snprintf(filepath, sizeof(filepath), "%s\\%s", dirpath, find_data.cFileName);
+            add_watched_file(watcher, filepath);
+        }
+    } while (FindNextFile(h_find, &find_data) != 0);
+
+    FindClose(h_find);
     #else
+    DIR *d = opendir(dirpath);
+    if (!d) {
+        return;
+    }
+
+    struct dirent *dir;
+    while ((dir = readdir(d)) != NULL) {
+        if (dir->d_type == DT_REG) { // Regular file
+            /*
+                This example doesn't filter by extension,
+                But you could add `strstr(dir->d_name, ".js")` here.
+            */
+            char filepath[1024];
+            snprintf(filepath, sizeof(filepath), "%s/%s", dirpath, dir->d_name);
+            add_watched_file(watcher, filepath);
+        }
+    }
+    closedir(d);
+    #endif
+}
+
+void watcher_rescan_directories(Watcher *watcher) {
     for (int i = 0; i < watcher->dir_count; ++i) {
-        DIR *d = opendir(watcher->dirs_to_watch[i]);
-        if (!d) {
-            continue;
+        watcher_scan_directory(watcher, watcher->dirs_to_watch[i]);
+    }
+}
+
+static void ensure_poll_pool(Watcher *watcher) {
+    int workers = watcher->options->poll_workers;
+    if (watcher->poll_pool || workers == 1) {
+        return;
+    }
+    if (workers == 0) {
+        if (watcher->file_count < POLL_PARALLEL_MIN_FILES) {
+            return;
         }
+        workers = POLL_AUTO_WORKERS;
+    }
 
-        struct dirent *dir;
-        while ((dir = readdir(d)) != NULL) {
-            if (dir->d_type == DT_REG) { // Regular file
-                /*
-                    This example doesn't filter by extension,
-                    But you could add `strstr(dir->d_name, ".js")` here.
-                */
-                char filepath[1024];
-                snprintf(filepath, sizeof(filepath), "%s/%s", watcher->dirs_to_watch[i], dir->d_name);
-                add_watched_file(watcher, filepath);
+    watcher->poll_pool = poll_pool_create(workers);
+    if (watcher->poll_pool) {
+        printf("[Watcher info] Polling %d files with %d stat workers\n",
+               watcher->file_count, poll_pool_workers(watcher->poll_pool));
+    } else {
+        // Don't retry every tick; fall back to the serial loop for good.
+        printf("[Watcher info] Stat workers unavailable, polling serially\n");
+        watcher->poll_serial_only = 1;
+    }
+}
+
+/*
+    Stats the next window of the table into current_mtimes.
+    With a pool the pass runs in the background while the main
+    loop sleeps, and its results are compared on the next tick.
+*/
+static void start_poll_pass(Watcher *watcher) {
+    int total = watcher->file_count;
+    if (total == 0) {
+        return;
+    }
+
+    int count = watcher->options->poll_budget;
+    if (count <= 0 || count > total) {
+        count = total;
+    }
+    if (watcher->poll_cursor >= total) {
+        watcher->poll_cursor = 0;
+    }
+
+    if (watcher->poll_pool) {
+        poll_pool_submit(watcher->poll_pool, watcher->files_to_watch, watcher->current_mtimes,
+                         total, watcher->poll_cursor, count);
+    } else {
+        for (int k = 0; k < count; ++k) {
+            int i = (watcher->poll_cursor + k) % total;
+            watcher->current_mtimes[i] = get_mtime_asm(watcher->files_to_watch[i]);
+        }
+    }
+    watcher->poll_cursor = (watcher->poll_cursor + count) % total;
+}
+
+// Creates the heat schedules on the first polling pass; returns 1 when they are in use.
+static int ensure_heat(Watcher *watcher) {
+    if (watcher->file_heat) {
+        return 1;
+    }
+    if (watcher->options->poll_max_ms <= 0) {
+        return 0;
+    }
+    unsigned int min_ms = (unsigned int)watcher->options->poll_interval_ms;
+    unsigned int max_ms = (unsigned int)watcher->options->poll_max_ms;
+    watcher->file_heat = poll_heat_create(min_ms, max_ms);
+    watcher->dir_heat = poll_heat_create(min_ms, max_ms);
+    if (!watcher->file_heat || !watcher->dir_heat) {
+        poll_heat_destroy(watcher->file_heat);
+        poll_heat_destroy(watcher->dir_heat);
+        watcher->file_heat = NULL;
+        watcher->dir_heat = NULL;
+        return 0;
+    }
+    return 1;
+}
+
+// Polling-mode pass: only the files whose heat says they are due.
+static void start_scheduled_pass(Watcher *watcher) {
+    if (!ensure_heat(watcher)) {
+        start_poll_pass(watcher);
+        return;
+    }
+    uint64_t now = watcher_clock_ms();
+    if (poll_heat_resize(watcher->file_heat, watcher->file_count, now) != 0) {
+        start_poll_pass(watcher);
+        return;
+    }
+
+    const int *due;
+    int count = poll_heat_due(watcher->file_heat, now, watcher->options->poll_budget, &due);
+    if (watcher->poll_pool) {
+        poll_pool_submit_indices(watcher->poll_pool, watcher->files_to_watch, watcher->current_mtimes, due, count);
+    } else {
+        for (int k = 0; k < count; ++k) {
+            watcher->current_mtimes[due[k]] = get_mtime_asm(watcher->files_to_watch[due[k]]);
+        }
+    }
+}
+
+// Directories that gained a file stay hot, quiet ones are read less and less often.
+static void rescan_scheduled_directories(Watcher *watcher) {
+    if (!ensure_heat(watcher)) {
+        watcher_rescan_directories(watcher);
+        return;
+    }
+    uint64_t now = watcher_clock_ms();
+    if (poll_heat_resize(watcher->dir_heat, watcher->dir_count, now) != 0) {
+        watcher_rescan_directories(watcher);
+        return;
+    }
+
+    const int *due;
+    int count = poll_heat_due(watcher->dir_heat, now, 0, &due);
+    for (int k = 0; k < count; ++k) {
+        int before = watcher->file_count;
+        watcher_scan_directory(watcher, watcher->dirs_to_watch[due[k]]);
+        if (watcher->file_count != before) {
+            poll_heat_changed(watcher->dir_heat, due[k], now);
+        }
+    }
+}
+
+/*
+    Diffs the whole table in one vectorized pass, then walks only the set
+    bits. Every entry that differs is refreshed, including ones that
+    don't trigger a restart (a file seen for the first time, last == 0).
+*/
+static int compare_mtimes(Watcher *watcher) {
+    if (!fingerprint_diff(watcher->current_mtimes, watcher->last_mtimes, watcher->file_count,
+                          watcher->changed_bitmap)) {
+        return 0;
+    }
+
+    uint64_t now = watcher->file_heat ? watcher_clock_ms() : 0;
+    const char *action = watcher->impact ? "Running affected tests..."
+                       : watcher->cluster ? "Rolling restart..."
+                       : watcher->build ? "Building..."
+                       : watcher->reload_fd >= 0 ? "Reloading..." : "Restarting...";
+    int changed = 0;
+    size_t words = FINGERPRINT_BITMAP_WORDS(watcher->file_count);
+    for (size_t w = 0; w < words; ++w) {
+        uint64_t bits = watcher->changed_bitmap[w];
+        while (bits) {
+            int i = (int)(w * 64) + __builtin_ctzll(bits);
+            bits &= bits - 1;
+
+            if (watcher->file_heat) {
+                poll_heat_changed(watcher->file_heat, i, now);
             }
+            event_log_write(watcher->record,
+                            watcher->current_mtimes[i] == 0 ? EVENT_DELETED
+                            : watcher->last_mtimes[i] == 0 ? EVENT_CREATED : EVENT_CHANGED,
+                            watcher->files_to_watch[i]);
+            if (watcher->last_mtimes[i] != 0) {
+                if (changed == 0) {
+                    if (watcher->current_mtimes[i] == 0) {
+                        printf("[Watcher info] File deleted: %s! %s\n", watcher->files_to_watch[i], action);
+                    } else {
+                        printf("[Watcher info] Change detected in %s! %s\n", watcher->files_to_watch[i], action);
+                    }
+                }
+                if (changed < TRACE_FILE_EVENTS_MAX) {
+                    trace_instant(watcher->trace, TRACE_WATCHER,
+                                  watcher->current_mtimes[i] == 0 ? "File deleted" : "File changed",
+                                  watcher->files_to_watch[i]);
+                }
+                changed++;
+            }
+            watcher->last_mtimes[i] = watcher->current_mtimes[i];
         }
-        closedir(d);
     }
-    #endif
+
+    if (changed > 1) {
+        printf("[Watcher info] ...and %d more changed files\n", changed - 1);
+    }
+    if (watcher->trace && changed > TRACE_FILE_EVENTS_MAX) {
+        char detail[64];
+        snprintf(detail, sizeof(detail), "%d more files", changed - TRACE_FILE_EVENTS_MAX);
+        trace_instant(watcher->trace, TRACE_WATCHER, "More changes", detail);
+    }
+    return changed > 0; // Change or deletion detected
+}
+
+int watcher_on_event(void *ctx, const char *path, int in_watched_dir) {
+    Watcher *watcher = ctx;
+    int i = path_index_find(&watcher->file_index, watcher->files_to_watch, path);
+    if (i >= 0) {
+        watcher->current_mtimes[i] = get_mtime_asm(path);
+        return 1;
+    }
+
+    struct stat st;
+    if (in_watched_dir && stat(path, &st) == 0 && S_ISREG(st.st_mode)) {
+        add_watched_file(watcher, path);
+        return 1;
+    }
+    return 0;
+}
+
+int watcher_on_write(void *ctx, const char *path, int in_watched_dir) {
+    Watcher *watcher = ctx;
+    if (!in_watched_dir && path_index_find(&watcher->file_index, watcher->files_to_watch, path) < 0) {
+        return 0;
+    }
+    __atomic_add_fetch(&watcher->write_generation, 1, __ATOMIC_RELEASE); // Read by the supervisor
+    return 1;
+}
+
+/*
+    Keeps the kernel queues short during a git hold without comparing:
+    last_mtimes stays put, so the reconciliation pass still sees every change.
+*/
+static void drain_events(Watcher *watcher) {
+    if (watcher->fanotify) {
+        fanotify_backend_collect(watcher->fanotify, watcher_on_event, watcher);
+    } else if (watcher->shared) {
+        if (shared_backend_collect(watcher->shared, watcher_on_event, watcher) == -2) {
+            printf("[Watcher info] kavind went away, falling back to polling\n");
+            shared_backend_close(watcher->shared);
+            watcher->shared = NULL;
+        }
+    } else if (watcher->inotify) {
+        inotify_backend_check(watcher->inotify, watcher);
+    }
+}
+
+// One full pass over the tree once git is done with it. Overflows during the hold don't matter.
+static int reconcile_after_git(Watcher *watcher) {
+    drain_events(watcher);
+    watcher_rescan_directories(watcher);
+
+    int total = watcher->file_count;
+    if (watcher->poll_pool) {
+        poll_pool_submit(watcher->poll_pool, watcher->files_to_watch, watcher->current_mtimes, total, 0, total);
+        poll_pool_wait(watcher->poll_pool);
+    } else {
+        for (int i = 0; i < total; ++i) {
+            watcher->current_mtimes[i] = get_mtime_asm(watcher->files_to_watch[i]);
+        }
+    }
+    watcher->poll_cursor = 0;
+    return compare_mtimes(watcher);
+}
+
+// Returns 1 while git rewrites the tree
+static int git_holding(Watcher *watcher) {
+    unsigned long holds = git_guard_holds(watcher->git);
+    if (!git_guard_poll(watcher->git)) {
+        return 0;
+    }
+    if (git_guard_holds(watcher->git) != holds) {
+        printf("[Watcher info] git operation in progress, holding changes\n");
+        trace_begin(watcher->trace, TRACE_GIT, "Git operation", NULL);
+        event_log_write(watcher->record, EVENT_GIT_BEGIN, NULL);
+    }
+    return 1;
+}
+
+static int git_released(Watcher *watcher) {
+    if (!git_guard_take_released(watcher->git)) {
+        return 0;
+    }
+    printf("[Watcher info] git operation finished (on %s), reconciling\n", git_guard_head(watcher->git));
+    trace_end(watcher->trace, TRACE_GIT, git_guard_head(watcher->git));
+    event_log_write(watcher->record, EVENT_GIT_END, NULL);
+    return 1;
 }
 
 int check_for_file_changes(Watcher *watcher) {
-    // Rescan directories for new files.
-    rescan_directories(watcher);
-
-    for (int i = 0; i < watcher->file_count; ++i) {
-        time_t current_mtime = get_mtime_asm(watcher->files_to_watch[i]);
-        if (current_mtime != watcher->last_mtimes[i] && watcher->last_mtimes[i] != 0) {
-            printf("[Watcher info] Change detected in %s! Restarting...\n", watcher->files_to_watch[i]);
-            for (int j = 0; j < watcher->file_count; ++j) {
-                watcher->last_mtimes[j] = get_mtime_asm(watcher->files_to_watch[j]);
+    int changed;
+
+    if (watcher->replay) {
+        // The log stands in for the file system; a hold defers the compare like a live one.
+        // Every other tick compares, events applied while restarting included.
+        replay_apply(watcher->replay, watcher);
+        if (replay_holding(watcher->replay)) {
+            return 0;
+        }
+        replay_take_released(watcher->replay);
+        changed = compare_mtimes(watcher);
+        replay_compared(watcher->replay, changed);
+        return changed;
+    }
+
+    if (watcher->git) {
+        if (git_holding(watcher)) {
+            // A pass in flight reads files_to_watch, which the drain may grow
+            if (watcher->poll_pool) {
+                poll_pool_wait(watcher->poll_pool);
+            }
+            drain_events(watcher);
+            return 0;
+        }
+        if (git_released(watcher)) {
+            if (watcher->poll_pool) {
+                poll_pool_wait(watcher->poll_pool);
             }
-            return 1; // Change detected
+            return reconcile_after_git(watcher);
         }
-        // Handle deleted files
-        if (current_mtime == 0 && watcher->last_mtimes[i] != 0) {
-             printf("[Watcher info] File deleted: %s! Restarting...\n", watcher->files_to_watch[i]);
-             return 1; // Deletion detected
+    }
+
+    if (watcher->fanotify) {
+        // Quiet tick: nothing to rescan or stat.
+        int hits = fanotify_backend_collect(watcher->fanotify, watcher_on_event, watcher);
+        if (hits >= 0) {
+            return hits > 0 ? compare_mtimes(watcher) : 0;
         }
+        printf("[Watcher info] fanotify queue overflowed, rescanning everything\n");
+        watcher_rescan_directories(watcher);
+        start_poll_pass(watcher);
+        return compare_mtimes(watcher);
     }
-    return 0;
+
+    if (watcher->shared) {
+        int hits = shared_backend_collect(watcher->shared, watcher_on_event, watcher);
+        if (hits >= 0) {
+            return hits > 0 ? compare_mtimes(watcher) : 0;
+        }
+        if (hits == -2) {
+            printf("[Watcher info] kavind went away, falling back to polling\n");
+            shared_backend_close(watcher->shared);
+            watcher->shared = NULL;
+        } else {
+            printf("[Watcher info] kavind dropped events, rescanning everything\n");
+        }
+        watcher_rescan_directories(watcher);
+        start_poll_pass(watcher);
+        return compare_mtimes(watcher);
+    }
+
+    if (watcher->inotify) {
+        int hits = inotify_backend_check(watcher->inotify, watcher);
+        if (hits >= 0) {
+            return hits > 0 ? compare_mtimes(watcher) : 0;
+        }
+        printf("[Watcher info] inotify queue overflowed, rescanning everything\n");
+        watcher_rescan_directories(watcher);
+        start_poll_pass(watcher);
+        return compare_mtimes(watcher);
+    }
+
+    if (watcher->poll_pool && !watcher->file_heat) {
+        // Collect the pass started on the previous tick, then queue the next one.
+        poll_pool_wait(watcher->poll_pool);
+        changed = compare_mtimes(watcher);
+        rescan_scheduled_directories(watcher);
+        start_scheduled_pass(watcher);
+        return changed;
+    }
+
+    // Rescan directories for new files. With heat the pool runs in the
+    // foreground: a pass collected one (long) sleep later would add its
+    // length to the detection latency.
+    rescan_scheduled_directories(watcher);
+    if (!watcher->poll_serial_only) {
+        ensure_poll_pool(watcher);
+    }
+    start_scheduled_pass(watcher);
+    if (watcher->poll_pool) {
+        poll_pool_wait(watcher->poll_pool);
+    }
+    changed = compare_mtimes(watcher);
+    return changed;
+}
+
+static int append_line(char **buffer, size_t *len, size_t *cap, const char *a, const char *b, const char *c) {
+    size_t need = strlen(a) + strlen(b) + strlen(c) + 2;
+    if (*len + need > *cap) {
+        size_t new_cap = (*cap ? *cap * 2 : 4096) + need;
+        char *grown = realloc(*buffer, new_cap);
+        if (!grown) {
+            return 0;
+        }
+        *buffer = grown;
+        *cap = new_cap;
+    }
+    *len += (size_t)sprintf(*buffer + *len, "%s%s%s\n", a, b, c);
+    return 1;
+}
+
+int watcher_reload_lines(Watcher *watcher, char **lines, size_t *len) {
+    // Prefix for relative paths. Without a readable cwd they go out as they are.
+    #ifdef _WIN32
+    const char *cwd = "";
+    #else
+    char cwd[PATH_MAX + 1] = "";
+    char dir[PATH_MAX];
+    if (!getcwd(dir, sizeof(dir)) ||
+        snprintf(cwd, sizeof(cwd), "%s%s", dir, strcmp(dir, "/") == 0 ? "" : "/") >= (int)sizeof(cwd)) {
+        cwd[0] = '\0';
+    }
+    #endif
+
+    char *batch = NULL;
+    size_t cap = 0;
+    int files = 0;
+    int built = 1;
+    *len = 0;
+    size_t words = FINGERPRINT_BITMAP_WORDS(watcher->file_count);
+    for (size_t w = 0; w < words; ++w) {
+        uint64_t bits = watcher->changed_bitmap[w];
+        while (bits) {
+            int i = (int)(w * 64) + __builtin_ctzll(bits);
+            bits &= bits - 1;
+            const char *path = watcher->files_to_watch[i];
+            built &= append_line(&batch, len, &cap, watcher->current_mtimes[i] == 0 ? "deleted " : "changed ",
+                                 path[0] == '/' ? "" : cwd, path);
+            files++;
+        }
+    }
+    if (!built) {
+        free(batch);
+        batch = NULL;
+        *len = 0;
+    }
+    *lines = batch;
+    return files;
+}
+
+/*
+    Offers a change set to the app over the reload channel. Returns 0
+    when the batch could not be handed over, so the caller restarts
+    right away.
+*/
+static int request_soft_reload(Watcher *watcher, ChangeBatch *batch) {
+    size_t cap = batch->len + 1;
+    int built = batch->lines && append_line(&batch->lines, &batch->len, &cap, "reload", "", "");
+    int sent = built && reload_send(watcher->reload_fd, batch->lines, batch->len) == 0;
+    if (!sent) {
+        printf("[Watcher info] App is not reading its reload channel, restarting\n");
+        watcher->soft_reload_fallbacks++;
+        return 0;
+    }
+
+    watcher->reload_start_ms = watcher_clock_ms();
+    if (watcher->trace) {
+        char detail[32];
+        snprintf(detail, sizeof(detail), "%d files", batch->files);
+        trace_begin(watcher->trace, TRACE_WATCHER, "Soft reload", detail);
+    }
+    return 1;
+}
+
+void change_batch_merge(ChangeBatch *into, ChangeBatch *from, int want_lines) {
+    if (want_lines && into->changed == 0) {
+        *into = *from;
+        memset(from, 0, sizeof(*from));
+        return;
+    }
+    if (want_lines) {
+        char *lines = into->lines && from->lines ? realloc(into->lines, into->len + from->len + 1) : NULL;
+        if (lines) {
+            memcpy(lines + into->len, from->lines, from->len + 1);
+            into->lines = lines;
+            into->len += from->len;
+        } else {
+            free(into->lines); // The merged set can't be offered whole; it restarts
+            into->lines = NULL;
+            into->len = 0;
+        }
+    }
+    into->changed += from->changed;
+    into->files += from->files;
+    free(from->lines);
+    memset(from, 0, sizeof(*from));
+}
+
+int watcher_take_changes(Watcher *watcher, ChangeBatch *batch) {
+    if (watcher->watch_thread) {
+        return watch_thread_take(watcher->watch_thread, batch);
+    }
+    memset(batch, 0, sizeof(*batch));
+    if (!check_for_file_changes(watcher)) {
+        return 0;
+    }
+    batch->changed = 1;
+    if (watcher->reload_fd >= 0) {
+        batch->files = watcher_reload_lines(watcher, &batch->lines, &batch->len);
+    }
+    return 1;
+}
+
+ProcessPriority watcher_child_priority(const Watcher *watcher) {
+    if (!psi_guard_throttled(watcher->psi)) {
+        return PROCESS_PRIORITY_NORMAL;
+    }
+    const char *mode = watcher->options->psi_priority;
+    return strcmp(mode, "idle") == 0 ? PROCESS_PRIORITY_IDLE
+         : strcmp(mode, "batch") == 0 ? PROCESS_PRIORITY_BATCH : PROCESS_PRIORITY_NORMAL;
+}
+
+/*
+    Under pressure a change doesn't restart right away: the restart waits
+    until --psi-debounce has passed without another change, so a burst of
+    saves costs one restart on a machine that is already struggling.
+*/
+static void hold_restart(Watcher *watcher) {
+    uint64_t now = watcher_clock_ms();
+    uint64_t window = (uint64_t)watcher->options->psi_debounce_ms;
+    if (watcher->restart_due_ms == 0) {
+        watcher->restart_held_ms = now;
+        watcher->held_restarts++;
+        printf("[Watcher info] System under pressure, holding the restart for %llu ms\n", (unsigned long long)window);
+        trace_instant(watcher->trace, TRACE_WATCHER, "Restart held", "pressure");
+    }
+    uint64_t due = now + window;
+    uint64_t latest = watcher->restart_held_ms + window * PSI_HOLD_MAX_WINDOWS;
+    watcher->restart_due_ms = due < latest ? due : latest;
+}
+
+static void end_restart_hold(Watcher *watcher, const char *reason) {
+    uint64_t held = watcher_clock_ms() - watcher->restart_held_ms;
+    watcher->held_ms_total += held;
+    watcher->restart_due_ms = 0;
+    printf("[Watcher info] Restart held for %llu ms, %s\n", (unsigned long long)held, reason);
+}
+
+static void start_build(Watcher *watcher, uint64_t writes, int speculative) {
+    build_step_start(watcher->build, writes, speculative,
+                     watcher->warm_cache ? warm_cache_env(watcher->warm_cache) : NULL,
+                     watcher_child_priority(watcher));
+    watcher->writes_seen = writes;
+}
+
+/*
+    --build runs before every start, while the current app keeps serving.
+    A change (or the first start) waits in build_batch until a build of
+    the current content passes; a failed one drops it and the app stays
+    as it is. With --build-speculative the build starts on the first
+    write of a save, before the change is final, and any later write
+    starts it over. The change adopts it only if nothing was written
+    since it started. Without write events, each change counts as a
+    write, so one landing mid-build starts it over too. Returns 1 with
+    the change in `batch` once its build passed.
+*/
+static void queue_for_build(Watcher *watcher, ChangeBatch *batch) {
+    if (!watcher->writes_reported) {
+        __atomic_add_fetch(&watcher->write_generation, 1, __ATOMIC_RELEASE);
+    }
+    change_batch_merge(&watcher->build_batch, batch, watcher->reload_fd >= 0);
+    if (!watcher->build_pending) {
+        watcher->build_pending = 1;
+        watcher->build_wait_ms = watcher_clock_ms();
+    }
+}
+
+static int build_gate(Watcher *watcher, int changed, ChangeBatch *batch) {
+    BuildStep *build = watcher->build;
+    if (changed) {
+        queue_for_build(watcher, batch);
+    }
+    uint64_t writes = __atomic_load_n(&watcher->write_generation, __ATOMIC_ACQUIRE); // After the take
+
+    BuildState state = build_step_poll(build);
+    int current = state != BUILD_IDLE && build_step_generation(build) == writes;
+    if (watcher->build_pending && !current) {
+        if (build_step_cancel(build)) {
+            printf("[Watcher info] Files changed during the build, starting it over\n");
+        }
+        start_build(watcher, writes, 0);
+    } else if (!watcher->build_pending && writes != watcher->writes_seen) {
+        build_step_cancel(build); // A newer write makes a speculative build stale
+        start_build(watcher, writes, 1);
+        return 0;
+    }
+    if (!watcher->build_pending) {
+        return 0;
+    }
+
+    state = build_step_poll(build);
+    if (state == BUILD_RUNNING) {
+        return 0;
+    }
+    uint64_t started = build_step_started_ms(build);
+    uint64_t head_start = started < watcher->build_wait_ms ? watcher->build_wait_ms - started : 0;
+    uint64_t elapsed = build_step_elapsed_ms(build);
+    watcher->build_pending = 0;
+    build_step_done(build, head_start < elapsed ? head_start : elapsed);
+
+    if (state == BUILD_FAILED) {
+        printf("[Watcher error] Build failed after %llu ms, %s\n", (unsigned long long)elapsed,
+               watcher->process_id > 0 ? "keeping the running app" : "waiting for the next change");
+        build_step_print_output(build);
+        trace_instant(watcher->trace, TRACE_WATCHER, "Build failed", NULL);
+        free(watcher->build_batch.lines);
+        memset(&watcher->build_batch, 0, sizeof(watcher->build_batch));
+        return 0;
+    }
+
+    if (head_start > 0) {
+        printf("[Watcher info] Build passed in %llu ms, started %llu ms before the save completed\n",
+               (unsigned long long)elapsed, (unsigned long long)head_start);
+    } else {
+        printf("[Watcher info] Build passed in %llu ms\n", (unsigned long long)elapsed);
+    }
+    if (watcher->trace) {
+        char detail[32];
+        snprintf(detail, sizeof(detail), "%llu ms", (unsigned long long)elapsed);
+        trace_instant(watcher->trace, TRACE_WATCHER, "Build passed", detail);
+    }
+    *batch = watcher->build_batch;
+    memset(&watcher->build_batch, 0, sizeof(watcher->build_batch));
+    return 1;
 }
 
 void watcher_restart(Watcher *watcher) {
+    if (watcher->process_id > 0) {
+        watcher->restart_count++;
+    }
     printf("[Watcher info] Starting application\n");
-    watcher->process_id = process_start(watcher->cmd);
+    trace_begin(watcher->trace, TRACE_WATCHER, "Spawn", NULL);
+
+    // A fresh channel per child, so a late answer from the old one can't ack the new one's batch
+    int child_reload_fd = -1;
+    reload_channel_close(watcher->reload_fd);
+    watcher->reload_fd = -1;
+    if (watcher->options->soft_reload_ms > 0) {
+        watcher->reload_fd = reload_channel_open(&child_reload_fd);
+    }
+
+    if (watcher->warm_cache) {
+        warm_cache_prepare(watcher->warm_cache); // The old process is gone, nothing writes to it now
+    }
+
+    ProcessOptions process_options = { watcher->listen_fds, watcher->listen_fd_count, 0,
+                                       child_reload_fd > 0 ? child_reload_fd : 0,
+                                       watcher->warm_cache ? warm_cache_env(watcher->warm_cache) : NULL,
+                                       watcher_child_priority(watcher) };
+    watcher->process_id = process_start_with(watcher->cmd, &process_options);
+    reload_channel_close(child_reload_fd); // The child holds its own copy
     
     if (watcher->process_id > 0) {
         printf("[Watcher info] Started [PID: %lld]\n", (long long)watcher->process_id);
+        warm_cache_started(watcher->warm_cache, watcher->process_id);
+        if (watcher->replay) {
+            replay_applied(watcher->replay);
+        }
+        if (watcher->trace) {
+            char detail[32];
+            snprintf(detail, sizeof(detail), "PID %lld", (long long)watcher->process_id);
+            trace_end(watcher->trace, TRACE_WATCHER, detail);
+            trace_begin(watcher->trace, TRACE_APP, "Running", detail);
+        }
     } else {
         fprintf(stderr, "[Watcher error] Failed to start process\n");
+        trace_end(watcher->trace, TRACE_WATCHER, "failed");
+    }
+}
+
+void watcher_trace_exit(Watcher *watcher, int status, int stopping) {
+    if (!watcher->trace) {
+        return;
+    }
+    char detail[48];
+    #ifdef _WIN32
+    snprintf(detail, sizeof(detail), "exit code %d", status);
+    #else
+    if (WIFSIGNALED(status)) {
+        snprintf(detail, sizeof(detail), "killed by signal %d", WTERMSIG(status));
+    } else {
+        snprintf(detail, sizeof(detail), "exit code %d", WEXITSTATUS(status));
+    }
+    #endif
+    trace_end(watcher->trace, TRACE_APP, detail);
+    if (stopping) {
+        trace_end(watcher->trace, TRACE_WATCHER, detail); // Stop
     }
 }
 
 void watcher_initiate_shutdown(Watcher *watcher) {
     if (watcher->process_id > 0) {
+        if (watcher->state != STATE_SHUTTING_DOWN && watcher->state != STATE_FORCE_KILLING) {
+            trace_begin(watcher->trace, TRACE_WATCHER, "Stop", NULL); // Not again on Ctrl+C mid-restart
+        }
+        trace_instant(watcher->trace, TRACE_WATCHER, "SIGTERM", NULL);
         process_stop(watcher->process_id);
         #ifdef _WIN32
         watcher->shutdown_start_time = GetTickCount64();
@@ -157,16 +879,97 @@ void handle_state_running(Watcher *watcher) {
     int status;
     if (watcher->process_id > 0 && process_check_status(watcher->process_id, &status) == watcher->process_id) {
         printf("[Watcher info] Process died unexpectedly\n");
+        if (watcher->restart_due_ms > 0) {
+            end_restart_hold(watcher, "process died");
+        }
+        watcher_trace_exit(watcher, status, 0);
+        trace_begin(watcher->trace, TRACE_WATCHER, "Restart", "process died");
         watcher->state = STATE_RESTARTING;
         return;
     }
 
-    if (check_for_file_changes(watcher)) {
+    warm_cache_tick(watcher->warm_cache);
+
+    ChangeBatch batch;
+    int changed = watcher_take_changes(watcher, &batch);
+    if (watcher->build) {
+        changed = build_gate(watcher, changed, &batch);
+    }
+    if (changed && watcher->process_id <= 0) {
+        free(batch.lines); // First start, after its build: there is nothing to stop or reload
+        watcher->state = STATE_RESTARTING;
+        return;
+    }
+    // A soft reload is cheap, it isn't held; with a restart already held the batch goes with it
+    if (changed && watcher->restart_due_ms == 0 && watcher->reload_fd >= 0 && request_soft_reload(watcher, &batch)) {
+        free(batch.lines);
+        watcher->state = STATE_RELOADING;
+        handle_state_reloading(watcher); // Pick up a quick ack without waiting a tick
+        return;
+    }
+    free(batch.lines);
+    if (changed && psi_guard_throttled(watcher->psi)) {
+        hold_restart(watcher);
+        return;
+    }
+    if (watcher->restart_due_ms > 0) {
+        if (psi_guard_throttled(watcher->psi) && watcher_clock_ms() < watcher->restart_due_ms) {
+            return;
+        }
+        end_restart_hold(watcher, psi_guard_throttled(watcher->psi) ? "restarting" : "pressure cleared, restarting");
+        changed = 1;
+    }
+
+    if (changed) {
+        trace_begin(watcher->trace, TRACE_WATCHER, "Restart", "file change");
         watcher_initiate_shutdown(watcher);
         watcher->state = STATE_SHUTTING_DOWN;
     }
 }
 
+void handle_state_reloading(Watcher *watcher) {
+    int status;
+    if (process_check_status(watcher->process_id, &status) == watcher->process_id) {
+        printf("[Watcher info] Process died during soft reload\n");
+        trace_end(watcher->trace, TRACE_WATCHER, "process died");
+        watcher_trace_exit(watcher, status, 0);
+        trace_begin(watcher->trace, TRACE_WATCHER, "Restart", "process died");
+        watcher->state = STATE_RESTARTING;
+        return;
+    }
+
+    uint64_t elapsed = watcher_clock_ms() - watcher->reload_start_ms;
+    int deadline = watcher->options->soft_reload_ms;
+    int wait_ms = elapsed >= (uint64_t)deadline ? 0 : deadline - (int)elapsed;
+    if (wait_ms > watcher->options->poll_interval_ms) {
+        wait_ms = watcher->options->poll_interval_ms; // Keep ticking for signals and stats
+    }
+
+    ReloadReply reply = reload_wait_reply(watcher->reload_fd, wait_ms);
+    elapsed = watcher_clock_ms() - watcher->reload_start_ms;
+    if (reply == RELOAD_HANDLED) {
+        printf("[Watcher info] Reloaded in place in %llu ms\n", (unsigned long long)elapsed);
+        trace_end(watcher->trace, TRACE_WATCHER, "handled");
+        watcher->soft_reloads++;
+        if (watcher->replay) {
+            replay_applied(watcher->replay);
+        }
+        watcher->state = STATE_RUNNING;
+        return;
+    }
+    if (reply == RELOAD_PENDING && elapsed < (uint64_t)deadline) {
+        return;
+    }
+
+    const char *reason = reply == RELOAD_PENDING ? "timed out" : "declined";
+    printf("[Watcher info] Soft reload %s, restarting...\n", reason);
+    trace_end(watcher->trace, TRACE_WATCHER, reason);
+    trace_begin(watcher->trace, TRACE_WATCHER, "Restart", "soft reload failed");
+    watcher->soft_reload_fallbacks++;
+    watcher_initiate_shutdown(watcher);
+    watcher->state = STATE_SHUTTING_DOWN;
+}
+
 void handle_state_shutting_down(Watcher *watcher) {
     if (watcher->process_id <= 0) {
         watcher->state = STATE_RESTARTING;
@@ -174,12 +977,14 @@ void handle_state_shutting_down(Watcher *watcher) {
     }
     int status;
     if (process_check_status(watcher->process_id, &status) == watcher->process_id) {
+        watcher_trace_exit(watcher, status, 1);
         watcher->state = STATE_RESTARTING;
     } else {
         #ifdef _WIN32
         ULONGLONG now = GetTickCount64();
         if (now - watcher->shutdown_start_time >= 2000) { // 2 seconds
             printf("[Watcher info] Process did not respond gracefully, sending kill signal...\n");
+            trace_instant(watcher->trace, TRACE_WATCHER, "SIGKILL", NULL);
             process_kill(watcher->process_id);
             watcher->state = STATE_FORCE_KILLING;
         }
@@ -188,6 +993,7 @@ void handle_state_shutting_down(Watcher *watcher) {
         clock_gettime(CLOCK_MONOTONIC, &now);
         if (now.tv_sec - watcher->shutdown_start_time.tv_sec >= 2) {
             printf("[Watcher info] Process did not respond to SIGTERM, sending SIGKILL...\n");
+            trace_instant(watcher->trace, TRACE_WATCHER, "SIGKILL", NULL);
             process_kill(watcher->process_id);
             watcher->state = STATE_FORCE_KILLING;
         }
@@ -202,11 +1008,49 @@ void handle_state_force_killing(Watcher *watcher) {
     }
     int status;
     if (process_check_status(watcher->process_id, &status) == watcher->process_id) {
+        watcher_trace_exit(watcher, status, 1);
         watcher->state = STATE_RESTARTING;
     }
 }
 
+/*
+    Whatever changed while the old process stopped is on disk, so the new
+    one starts with it and needs no second restart. Not so with --build:
+    its output predates those changes, which wait for the next build.
+*/
 void handle_state_restarting(Watcher *watcher) {
+    ChangeBatch batch;
+    memset(&batch, 0, sizeof(batch));
+    if (watcher->watch_thread) {
+        if (watch_thread_holding(watcher->watch_thread)) {
+            return; // The thread reconciles once git is done
+        }
+        watch_thread_take(watcher->watch_thread, &batch);
+    } else if (watcher->git) {
+        if (git_holding(watcher)) {
+            return; // Don't start the app on a half-written tree
+        }
+        if (git_released(watcher) && reconcile_after_git(watcher) && watcher->build) {
+            batch.changed = 1;
+            if (watcher->reload_fd >= 0) {
+                batch.files = watcher_reload_lines(watcher, &batch.lines, &batch.len);
+            }
+        }
+    }
+    if (batch.changed && watcher->build) {
+        queue_for_build(watcher, &batch);
+    }
+    free(batch.lines);
+    if (watcher->replay) {
+        replay_apply(watcher->replay, watcher);
+        if (replay_holding(watcher->replay)) {
+            return;
+        }
+        if (replay_take_released(watcher->replay)) {
+            replay_compared(watcher->replay, compare_mtimes(watcher));
+        }
+    }
     watcher_restart(watcher);
+    trace_end(watcher->trace, TRACE_WATCHER, NULL); // Start or Restart
     watcher->state = STATE_RUNNING;
 }
\ No newline at end of file
@@ -8,13 +8,66 @@
 #define WATCHER_ACTIONS_H
 
 #include <watcher/watcher.h>
+#include <process/process.h>
+#include <watcher/watcher_thread.h>
 
 void handle_state_running(Watcher *watcher);
 void handle_state_shutting_down(Watcher *watcher);
 void handle_state_force_killing(Watcher *watcher);
 void handle_state_restarting(Watcher *watcher);
+void handle_state_reloading(Watcher *watcher);
 
 // Helper
 void watcher_initiate_shutdown(Watcher *watcher);
 
+// Records a reaped child in the trace; `stopping` closes the Stop span too
+void watcher_trace_exit(Watcher *watcher, int status, int stopping);
+
+// Adds files found in the watched directories to the table
+void watcher_rescan_directories(Watcher *watcher);
+void watcher_scan_directory(Watcher *watcher, const char *dirpath);
+
+/*
+    Appends `count` files found by a scan, with their mtimes, in one grow.
+    Takes ownership of the strings (duplicates are freed). Returns the
+    number added.
+*/
+int watcher_add_files(Watcher *watcher, char **paths, const time_t *mtimes, int count);
+
+// Refreshes current_mtimes; returns 1 (and fills changed_bitmap) on a change
+int check_for_file_changes(Watcher *watcher);
+
+// Scheduling for a child started now: lowered per --psi-priority while pressure throttles
+ProcessPriority watcher_child_priority(const Watcher *watcher);
+
+/*
+    Lists the entries flagged by the last compare for a soft reload, one
+    "changed <path>" or "deleted <path>" line each, with absolute paths.
+    Returns the number of entries; *lines is NULL when out of memory.
+*/
+int watcher_reload_lines(Watcher *watcher, char **lines, size_t *len);
+
+/*
+    The change set of this tick: taken from the watch thread, or checked
+    inline. `lines` are filled when a soft reload may be offered; the
+    caller frees them. Returns 1 on a change.
+*/
+int watcher_take_changes(Watcher *watcher, ChangeBatch *batch);
+
+/*
+    Appends `from` to `into` and frees what `from` owned. With
+    `want_lines`, a set whose lines are missing on either side loses
+    them: the merged set restarts instead of reloading.
+*/
+void change_batch_merge(ChangeBatch *into, ChangeBatch *from, int want_lines);
+
+// WatchEventFn for the event backends; ctx is the Watcher
+int watcher_on_event(void *ctx, const char *path, int in_watched_dir);
+
+/*
+    WatchEventFn for writes that don't end a save (--build-speculative):
+    bumps write_generation when the path is watched. Returns 1 then.
+*/
+int watcher_on_write(void *ctx, const char *path, int in_watched_dir);
+
 #endif // WATCHER_ACTIONS_H
\ No newline at end of file
@@ -0,0 +1,379 @@
+/*
+    Copyright © 2025 Mint teams
+    watcher_fanotify.c
+    The generic Node.js process watcher
+*/
+
+#ifndef _GNU_SOURCE
+#define _GNU_SOURCE // open_by_handle_at(), struct file_handle, O_PATH
+#endif
+
+#include <errno.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+
+#include <watcher/watcher_fanotify.h>
+
+#if defined(__linux__)
+#include <fcntl.h>
+#include <limits.h>
+#include <unistd.h>
+#include <sys/fanotify.h>
+#include <sys/stat.h>
+#include <sys/statfs.h>
+#endif
+
+#if defined(__linux__) && defined(FAN_REPORT_DFID_NAME) && defined(FAN_MARK_FILESYSTEM)
+
+/*
+    Directory-entry and close events only. FAN_MODIFY on a whole
+    filesystem fires for every write() on the machine, and a save
+    always ends in a close, a rename or a metadata update anyway.
+*/
+#define FANOTIFY_MASK (FAN_CLOSE_WRITE | FAN_ATTRIB | FAN_CREATE | FAN_DELETE | \
+                       FAN_MOVED_FROM | FAN_MOVED_TO)
+
+// Content changes under a name, for fanotify_backend_report_writes()
+#define FANOTIFY_WRITE_MASK (FAN_MODIFY | FAN_CREATE | FAN_DELETE | FAN_MOVED_FROM | FAN_MOVED_TO)
+
+// Resolved directory handles; storms tend to hit the same few dirs.
+#define HANDLE_CACHE_SIZE 64
+#define HANDLE_CACHE_BYTES 128
+
+typedef struct {
+    char *real;     // Canonical directory path, as /proc/self/fd reports it
+    char *prefix;   // The same directory as spelled in the watch table ("" = cwd)
+    int enumerate;  // Watched directory (1) or parent of an explicit file (0)
+} FanotifyRoot;
+
+typedef struct {
+    fsid_t fsid;
+    int mount_fd;   // Any fd on the filesystem, for open_by_handle_at()
+} FanotifyMount;
+
+typedef struct {
+    unsigned char key[HANDLE_CACHE_BYTES];
+    size_t key_len;
+    char *dir;      // NULL = resolved, but not a watched directory
+} HandleCacheEntry;
+
+struct FanotifyBackend {
+    int fd;
+    FanotifyRoot *roots;
+    int root_count;
+    FanotifyMount *mounts;
+    int mount_count;
+    HandleCacheEntry cache[HANDLE_CACHE_SIZE];
+    WatchEventFn on_write;  // NULL unless writes are reported
+};
+
+static int add_root(FanotifyBackend *backend, const char *dir, int enumerate) {
+    char real[PATH_MAX];
+    if (!realpath(*dir ? dir : ".", real)) {
+        return 0; // Vanished since watcher_init; polling would miss it too
+    }
+
+    for (int i = 0; i < backend->root_count; ++i) {
+        FanotifyRoot *root = &backend->roots[i];
+        if (strcmp(root->real, real) == 0 && strcmp(root->prefix, dir) == 0) {
+            root->enumerate |= enumerate;
+            return 0;
+        }
+    }
+
+    FanotifyRoot *roots = realloc(backend->roots, sizeof(FanotifyRoot) * (backend->root_count + 1));
+    if (!roots) {
+        return -1;
+    }
+    backend->roots = roots;
+    roots[backend->root_count].real = strdup(real);
+    roots[backend->root_count].prefix = strdup(dir);
+    roots[backend->root_count].enumerate = enumerate;
+    if (!roots[backend->root_count].real || !roots[backend->root_count].prefix) {
+        free(roots[backend->root_count].real);
+        free(roots[backend->root_count].prefix);
+        return -1;
+    }
+    backend->root_count++;
+    return 0;
+}
+
+static int add_mark(FanotifyBackend *backend, const char *real) {
+    struct statfs sfs;
+    if (statfs(real, &sfs) != 0) {
+        return -1;
+    }
+    for (int i = 0; i < backend->mount_count; ++i) {
+        if (memcmp(&backend->mounts[i].fsid, &sfs.f_fsid, sizeof(fsid_t)) == 0) {
+            return 0; // Already covered by this filesystem's mark
+        }
+    }
+
+    // Everything that can fail after the mark is done first, so a failure never leaves one behind
+    int mount_fd = open(real, O_RDONLY | O_DIRECTORY | O_CLOEXEC);
+    if (mount_fd < 0) {
+        return -1;
+    }
+    FanotifyMount *mounts = realloc(backend->mounts, sizeof(FanotifyMount) * (backend->mount_count + 1));
+    if (!mounts) {
+        close(mount_fd);
+        return -1;
+    }
+    backend->mounts = mounts; // Kept even if the mark fails; freed with the backend
+    if (fanotify_mark(backend->fd, FAN_MARK_ADD | FAN_MARK_FILESYSTEM, FANOTIFY_MASK, AT_FDCWD, real) != 0) {
+        int saved = errno;
+        close(mount_fd);
+        errno = saved;
+        return -1;
+    }
+    mounts[backend->mount_count].fsid = sfs.f_fsid;
+    mounts[backend->mount_count].mount_fd = mount_fd;
+    backend->mount_count++;
+    return 0;
+}
+
+FanotifyBackend *fanotify_backend_open(char **files, int file_count, char **dirs, int dir_count) {
+    FanotifyBackend *backend = calloc(1, sizeof(FanotifyBackend));
+    if (!backend) {
+        return NULL;
+    }
+
+    backend->fd = fanotify_init(FAN_CLASS_NOTIF | FAN_REPORT_DFID_NAME | FAN_NONBLOCK | FAN_CLOEXEC,
+                                O_RDONLY | O_CLOEXEC);
+    if (backend->fd < 0) {
+        int saved = errno;
+        free(backend);
+        errno = saved;
+        return NULL;
+    }
+
+    int failed = 0;
+    for (int i = 0; i < dir_count && !failed; ++i) {
+        failed = add_root(backend, dirs[i], 1) != 0;
+    }
+    for (int i = 0; i < file_count && !failed; ++i) {
+        char parent[PATH_MAX] = "";
+        const char *slash = strrchr(files[i], '/');
+        if (slash == files[i]) {
+            strcpy(parent, "/"); // File directly under "/"
+        } else if (slash) {
+            size_t len = (size_t)(slash - files[i]);
+            if (len >= sizeof(parent)) {
+                continue;
+            }
+            memcpy(parent, files[i], len);
+            parent[len] = '\0';
+        }
+        failed = add_root(backend, parent, 0) != 0;
+    }
+    for (int i = 0; i < backend->root_count && !failed; ++i) {
+        failed = add_mark(backend, backend->roots[i].real) != 0;
+    }
+
+    if (failed || backend->mount_count == 0) {
+        int saved = failed ? errno : ENOENT;
+        fanotify_backend_close(backend);
+        errno = saved;
+        return NULL;
+    }
+    return backend;
+}
+
+void fanotify_backend_close(FanotifyBackend *backend) {
+    if (!backend) {
+        return;
+    }
+    for (int i = 0; i < backend->root_count; ++i) {
+        free(backend->roots[i].real);
+        free(backend->roots[i].prefix);
+    }
+    for (int i = 0; i < backend->mount_count; ++i) {
+        close(backend->mounts[i].mount_fd);
+    }
+    for (int i = 0; i < HANDLE_CACHE_SIZE; ++i) {
+        free(backend->cache[i].dir);
+    }
+    free(backend->roots);
+    free(backend->mounts);
+    close(backend->fd);
+    free(backend);
+}
+
+int fanotify_backend_marks(const FanotifyBackend *backend) {
+    return backend->mount_count;
+}
+
+int fanotify_backend_report_writes(FanotifyBackend *backend, WatchEventFn on_write) {
+    for (int i = 0; i < backend->mount_count; ++i) {
+        if (fanotify_mark(backend->fd, FAN_MARK_ADD | FAN_MARK_FILESYSTEM, FAN_MODIFY,
+                          backend->mounts[i].mount_fd, NULL) != 0) {
+            return -1;
+        }
+    }
+    backend->on_write = on_write;
+    return 0;
+}
+
+/*
+    Maps the event's directory handle to a canonical path, or NULL when
+    it can't be resolved. Hits and misses are both cached by handle bytes.
+    A directory renamed after being cached keeps its old path here, which
+    at worst drops events until it falls out of the cache.
+*/
+static const char *resolve_dir(FanotifyBackend *backend, struct fanotify_event_info_fid *fid) {
+    struct file_handle *handle = (struct file_handle *)fid->handle;
+    size_t key_len = sizeof(fid->fsid) + sizeof(*handle) + handle->handle_bytes;
+    if (key_len > HANDLE_CACHE_BYTES) {
+        return NULL;
+    }
+
+    unsigned char key[HANDLE_CACHE_BYTES];
+    memcpy(key, &fid->fsid, sizeof(fid->fsid));
+    memcpy(key + sizeof(fid->fsid), handle, key_len - sizeof(fid->fsid));
+
+    unsigned int hash = 2166136261u;
+    for (size_t i = 0; i < key_len; ++i) {
+        hash = (hash ^ key[i]) * 16777619u;
+    }
+    HandleCacheEntry *entry = &backend->cache[hash % HANDLE_CACHE_SIZE];
+    if (entry->key_len == key_len && memcmp(entry->key, key, key_len) == 0) {
+        return entry->dir;
+    }
+
+    int mount_fd = -1;
+    for (int i = 0; i < backend->mount_count; ++i) {
+        if (memcmp(&backend->mounts[i].fsid, &fid->fsid, sizeof(fsid_t)) == 0) {
+            mount_fd = backend->mounts[i].mount_fd;
+            break;
+        }
+    }
+    if (mount_fd < 0) {
+        return NULL;
+    }
+
+    char *dir = NULL;
+    int dfd = open_by_handle_at(mount_fd, handle, O_PATH | O_CLOEXEC);
+    if (dfd >= 0) {
+        char link[64];
+        char real[PATH_MAX];
+        snprintf(link, sizeof(link), "/proc/self/fd/%d", dfd);
+        ssize_t len = readlink(link, real, sizeof(real) - 1);
+        if (len > 0) {
+            real[len] = '\0';
+            for (int i = 0; i < backend->root_count; ++i) {
+                if (strcmp(backend->roots[i].real, real) == 0) {
+                    dir = strdup(real);
+                    break;
+                }
+            }
+        }
+        close(dfd);
+    } else if (errno == ESTALE) {
+        return NULL; // Directory is gone; don't cache a dead handle
+    }
+
+    free(entry->dir);
+    memcpy(entry->key, key, key_len);
+    entry->key_len = key_len;
+    entry->dir = dir;
+    return dir;
+}
+
+static int deliver(FanotifyBackend *backend, const char *dir, const char *name,
+                   WatchEventFn on_event, void *ctx) {
+    int hits = 0;
+    for (int i = 0; i < backend->root_count; ++i) {
+        FanotifyRoot *root = &backend->roots[i];
+        if (strcmp(root->real, dir) != 0) {
+            continue;
+        }
+
+        char path[PATH_MAX];
+        if (root->prefix[0] == '\0') {
+            snprintf(path, sizeof(path), "%s", name);
+        } else if (strcmp(root->prefix, "/") == 0) {
+            snprintf(path, sizeof(path), "/%s", name);
+        } else {
+            snprintf(path, sizeof(path), "%s/%s", root->prefix, name);
+        }
+        hits += on_event(ctx, path, root->enumerate);
+    }
+    return hits;
+}
+
+int fanotify_backend_collect(FanotifyBackend *backend, WatchEventFn on_event, void *ctx) {
+    char buffer[16384] __attribute__((aligned(__alignof__(struct fanotify_event_metadata))));
+    int hits = 0;
+    int overflow = 0;
+
+    for (;;) {
+        ssize_t len = read(backend->fd, buffer, sizeof(buffer));
+        if (len <= 0) {
+            break; // EAGAIN: queue drained
+        }
+
+        struct fanotify_event_metadata *meta = (struct fanotify_event_metadata *)buffer;
+        for (; FAN_EVENT_OK(meta, len); meta = FAN_EVENT_NEXT(meta, len)) {
+            if (meta->vers != FANOTIFY_METADATA_VERSION) {
+                continue;
+            }
+            if (meta->mask & FAN_Q_OVERFLOW) {
+                overflow = 1;
+                continue;
+            }
+
+            struct fanotify_event_info_fid *fid = (struct fanotify_event_info_fid *)(meta + 1);
+            if ((char *)fid + sizeof(*fid) > (char *)meta + meta->event_len ||
+                fid->hdr.info_type != FAN_EVENT_INFO_TYPE_DFID_NAME) {
+                continue;
+            }
+
+            struct file_handle *handle = (struct file_handle *)fid->handle;
+            const char *name = (const char *)(handle->f_handle + handle->handle_bytes);
+            if (name[0] == '\0' || strcmp(name, ".") == 0) {
+                continue;
+            }
+
+            const char *dir = resolve_dir(backend, fid);
+            if (!dir) {
+                continue;
+            }
+            if (backend->on_write && (meta->mask & FANOTIFY_WRITE_MASK)) {
+                deliver(backend, dir, name, backend->on_write, ctx);
+            }
+            if (meta->mask & FANOTIFY_MASK) {
+                hits += deliver(backend, dir, name, on_event, ctx);
+            }
+        }
+    }
+
+    return overflow ? -1 : hits;
+}
+
+#else // No fanotify filesystem marks on this platform
+
+FanotifyBackend *fanotify_backend_open(char **files, int file_count, char **dirs, int dir_count) {
+    (void)files; (void)file_count; (void)dirs; (void)dir_count;
+    errno = ENOSYS;
+    return NULL;
+}
+
+void fanotify_backend_close(FanotifyBackend *backend) { (void)backend; }
+
+int fanotify_backend_collect(FanotifyBackend *backend, WatchEventFn on_event, void *ctx) {
+    (void)backend; (void)on_event; (void)ctx;
+    return 0;
+}
+
+int fanotify_backend_marks(const FanotifyBackend *backend) {
+    (void)backend;
+    return 0;
+}
+
+int fanotify_backend_report_writes(FanotifyBackend *backend, WatchEventFn on_write) {
+    (void)backend; (void)on_write;
+    errno = ENOSYS;
+    return -1;
+}
+#endif
@@ -0,0 +1,40 @@
+/*
+    Copyright © 2025 Mint teams
+    watcher_fanotify.h
+    The generic Node.js process watcher
+*/
+
+#ifndef WATCHER_FANOTIFY_H
+#define WATCHER_FANOTIFY_H
+
+#include <watcher/watcher.h>
+
+/*
+    fanotify backend: one FAN_MARK_FILESYSTEM mark per filesystem that
+    holds a watched path, with FAN_REPORT_DFID_NAME events filtered in
+    user space. Kernel cost does not grow with the number of directories.
+    Needs Linux 5.9+ and CAP_SYS_ADMIN.
+*/
+typedef struct FanotifyBackend FanotifyBackend;
+
+// Returns NULL (with errno set) when the kernel or privileges don't allow it.
+FanotifyBackend *fanotify_backend_open(char **files, int file_count, char **dirs, int dir_count);
+void fanotify_backend_close(FanotifyBackend *backend);
+
+/*
+    Drains pending events without blocking and calls `on_event` for each
+    one that hits a watched path. Returns the number of hits, or -1 when
+    the kernel queue overflowed and the caller must rescan everything.
+*/
+int fanotify_backend_collect(FanotifyBackend *backend, WatchEventFn on_event, void *ctx);
+
+int fanotify_backend_marks(const FanotifyBackend *backend);
+
+/*
+    Adds FAN_MODIFY to the marks and passes every write under a watched
+    directory to `on_write` as well, for --build-speculative. That is
+    every write() on those filesystems, filtered in user space.
+*/
+int fanotify_backend_report_writes(FanotifyBackend *backend, WatchEventFn on_write);
+
+#endif // WATCHER_FANOTIFY_H
@@ -0,0 +1,185 @@
+/*
+    Copyright © 2025 Mint teams
+    watcher_git.c
+    The generic Node.js process watcher
+*/
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <stdint.h>
+#include <sys/stat.h>
+
+#ifdef _WIN32
+#include <windows.h>
+#define S_ISDIR(m) (((m) & S_IFMT) == S_IFDIR)
+#define S_ISREG(m) (((m) & S_IFMT) == S_IFREG)
+#define realpath(path, resolved) _fullpath((resolved), (path), GIT_PATH_MAX)
+#endif
+
+#include <watcher/watcher.h>
+#include <watcher/watcher_git.h>
+
+#define GIT_PATH_MAX 4096
+
+// Rebase and am take the lock once per commit; don't reconcile between two of them.
+static const uint64_t GIT_SETTLE_MS = 300;
+
+static const char *const GIT_LOCK_FILES[] = { "index.lock", "HEAD.lock" };
+
+struct GitGuard {
+    char dir[GIT_PATH_MAX];      // The git dir, worktree-specific for linked worktrees
+    char head[128];
+    int holding;
+    int released;
+    uint64_t last_lock_ms;
+    unsigned long holds;
+};
+
+static int path_is(const char *path, int want_dir) {
+    struct stat st;
+    if (stat(path, &st) != 0) {
+        return 0;
+    }
+    return want_dir ? S_ISDIR(st.st_mode) : S_ISREG(st.st_mode);
+}
+
+/*
+    `worktree/.git` is a directory in a plain clone, or a "gitdir: <path>"
+    file in linked worktrees and submodules.
+*/
+static int resolve_git_dir(const char *worktree, char *out, size_t size) {
+    char dotgit[GIT_PATH_MAX];
+    if (snprintf(dotgit, sizeof(dotgit), "%s/.git", worktree) >= (int)sizeof(dotgit)) {
+        return -1;
+    }
+    if (path_is(dotgit, 1)) {
+        return snprintf(out, size, "%s", dotgit) < (int)size ? 0 : -1;
+    }
+    if (!path_is(dotgit, 0)) {
+        return -1;
+    }
+
+    FILE *file = fopen(dotgit, "r");
+    if (!file) {
+        return -1;
+    }
+    char line[GIT_PATH_MAX];
+    int found = fgets(line, sizeof(line), file) && strncmp(line, "gitdir: ", 8) == 0;
+    fclose(file);
+    if (!found) {
+        return -1;
+    }
+    line[strcspn(line, "\r\n")] = '\0';
+
+    const char *target = line + 8;
+    int len;
+    if (target[0] == '/' || (target[0] && target[1] == ':')) {
+        len = snprintf(out, size, "%s", target);
+    } else {
+        len = snprintf(out, size, "%s/%s", worktree, target);
+    }
+    return len < (int)size && path_is(out, 1) ? 0 : -1;
+}
+
+static void read_head(GitGuard *guard) {
+    char path[GIT_PATH_MAX + 8];
+    snprintf(path, sizeof(path), "%s/HEAD", guard->dir);
+    FILE *file = fopen(path, "r");
+    if (!file) {
+        return;
+    }
+    char line[256];
+    if (fgets(line, sizeof(line), file)) {
+        line[strcspn(line, "\r\n")] = '\0';
+        if (strncmp(line, "ref: refs/heads/", 16) == 0) {
+            snprintf(guard->head, sizeof(guard->head), "%.127s", line + 16);
+        } else {
+            snprintf(guard->head, sizeof(guard->head), "%.12s", line); // Detached
+        }
+    }
+    fclose(file);
+}
+
+GitGuard *git_guard_open(const char *path) {
+    char dir[GIT_PATH_MAX];
+    if (!realpath(*path ? path : ".", dir)) {
+        return NULL;
+    }
+    if (!path_is(dir, 1)) {
+        char *slash = strrchr(dir, '/');
+        if (!slash) {
+            return NULL;
+        }
+        *slash = '\0';
+    }
+
+    GitGuard *guard = calloc(1, sizeof(GitGuard));
+    if (!guard) {
+        return NULL;
+    }
+    // Walk up to the work tree root
+    for (;;) {
+        if (resolve_git_dir(*dir ? dir : "/", guard->dir, sizeof(guard->dir)) == 0) {
+            read_head(guard);
+            return guard;
+        }
+        char *slash = strrchr(dir, '/');
+        if (!slash || dir[0] == '\0') {
+            break;
+        }
+        *slash = '\0';
+    }
+    free(guard);
+    return NULL;
+}
+
+void git_guard_close(GitGuard *guard) {
+    free(guard);
+}
+
+int git_guard_poll(GitGuard *guard) {
+    uint64_t now = watcher_clock_ms();
+    int locked = 0;
+    for (size_t i = 0; i < sizeof(GIT_LOCK_FILES) / sizeof(GIT_LOCK_FILES[0]) && !locked; ++i) {
+        char path[GIT_PATH_MAX + 16];
+        snprintf(path, sizeof(path), "%s/%s", guard->dir, GIT_LOCK_FILES[i]);
+        struct stat st;
+        locked = stat(path, &st) == 0;
+    }
+
+    if (locked) {
+        guard->last_lock_ms = now;
+        if (!guard->holding) {
+            guard->holding = 1;
+            guard->holds++;
+        }
+    } else if (guard->holding && now - guard->last_lock_ms >= GIT_SETTLE_MS) {
+        guard->holding = 0;
+        guard->released = 1;
+        read_head(guard);
+    }
+    return guard->holding;
+}
+
+int git_guard_holding(const GitGuard *guard) {
+    return guard->holding;
+}
+
+int git_guard_take_released(GitGuard *guard) {
+    int released = guard->released;
+    guard->released = 0;
+    return released;
+}
+
+const char *git_guard_head(const GitGuard *guard) {
+    return guard->head;
+}
+
+const char *git_guard_dir(const GitGuard *guard) {
+    return guard->dir;
+}
+
+unsigned long git_guard_holds(const GitGuard *guard) {
+    return guard->holds;
+}
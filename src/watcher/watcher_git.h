@@ -0,0 +1,41 @@
+/*
+    Copyright © 2025 Mint teams
+    watcher_git.h
+    The generic Node.js process watcher
+*/
+
+#ifndef WATCHER_GIT_H
+#define WATCHER_GIT_H
+
+/*
+    Holds change processing while git rewrites the work tree. A checkout,
+    rebase step, merge or stash keeps index.lock (or HEAD.lock) in the git
+    dir until it is done; while one exists, and for a short settle window
+    after, the watcher neither stats nor restarts. Once the lock is gone
+    it reconciles the whole table in one pass, so a branch switch costs at
+    most one restart instead of one per file the checkout touched.
+*/
+typedef struct GitGuard GitGuard;
+
+// Finds the repository holding `path`; NULL when there is none.
+GitGuard *git_guard_open(const char *path);
+void git_guard_close(GitGuard *guard);
+
+/*
+    Checks the lock files; call once per tick. Returns 1 while a git
+    operation holds the tree.
+*/
+int git_guard_poll(GitGuard *guard);
+
+// Result of the last poll, without checking again
+int git_guard_holding(const GitGuard *guard);
+
+// Returns 1 once after a hold ended; the caller owes a full reconciliation.
+int git_guard_take_released(GitGuard *guard);
+
+// Current branch (or short commit id when detached)
+const char *git_guard_head(const GitGuard *guard);
+const char *git_guard_dir(const GitGuard *guard);
+unsigned long git_guard_holds(const GitGuard *guard);
+
+#endif // WATCHER_GIT_H
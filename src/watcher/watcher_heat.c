@@ -0,0 +1,157 @@
+/*
+    Copyright © 2025 Mint teams
+    watcher_heat.c
+    The generic Node.js process watcher
+*/
+
+#include <stdlib.h>
+#include <string.h>
+
+#include <watcher/watcher_heat.h>
+
+// An entry stays hot this long after a change, doubled per heat level.
+static const uint64_t HOT_WINDOW_MS = 30000;
+static const unsigned int HEAT_MAX = 4;
+
+typedef struct {
+    uint64_t next_ms;
+    uint64_t last_change_ms;
+    unsigned int interval_ms;
+    unsigned int heat;
+} HeatEntry;
+
+struct PollHeat {
+    HeatEntry *entries;
+    int count;
+    int *due;           // Scratch for poll_heat_due
+    int cursor;         // Where the next budgeted scan starts
+    unsigned int min_ms;
+    unsigned int max_ms;
+    uint64_t next_ms;
+    unsigned long polls;
+};
+
+PollHeat *poll_heat_create(unsigned int min_ms, unsigned int max_ms) {
+    PollHeat *heat = calloc(1, sizeof(PollHeat));
+    if (!heat) {
+        return NULL;
+    }
+    heat->min_ms = min_ms ? min_ms : 1;
+    heat->max_ms = max_ms > heat->min_ms ? max_ms : heat->min_ms;
+    return heat;
+}
+
+void poll_heat_destroy(PollHeat *heat) {
+    if (!heat) {
+        return;
+    }
+    free(heat->entries);
+    free(heat->due);
+    free(heat);
+}
+
+int poll_heat_resize(PollHeat *heat, int count, uint64_t now) {
+    if (count <= heat->count) {
+        return 0;
+    }
+    HeatEntry *entries = realloc(heat->entries, sizeof(HeatEntry) * (size_t)count);
+    if (!entries) {
+        return -1;
+    }
+    heat->entries = entries;
+    int *due = realloc(heat->due, sizeof(int) * (size_t)count);
+    if (!due) {
+        return -1;
+    }
+    heat->due = due;
+
+    for (int i = heat->count; i < count; ++i) {
+        // The initial table counts as long quiet; files that show up later were just written
+        entries[i].last_change_ms = heat->count ? now : 0;
+        entries[i].next_ms = now;
+        entries[i].interval_ms = heat->min_ms;
+        entries[i].heat = 0;
+    }
+    heat->count = count;
+    heat->next_ms = now;
+    return 0;
+}
+
+static unsigned int next_interval(const PollHeat *heat, HeatEntry *entry, uint64_t now) {
+    uint64_t window = HOT_WINDOW_MS << entry->heat;
+    if (entry->last_change_ms && now - entry->last_change_ms < window) {
+        return heat->min_ms;
+    }
+    unsigned int interval = entry->interval_ms * 2;
+    if (interval >= heat->max_ms) {
+        interval = heat->max_ms;
+        if (entry->interval_ms < heat->max_ms && entry->heat > 0) {
+            entry->heat--; // Cooled down all the way: one level less next time
+        }
+    }
+    return interval;
+}
+
+int poll_heat_due(PollHeat *heat, uint64_t now, int budget, const int **indices) {
+    int count = 0;
+    uint64_t next = UINT64_MAX;
+    if (budget <= 0 || budget > heat->count) {
+        budget = heat->count;
+    }
+
+    for (int k = 0; k < heat->count; ++k) {
+        int i = (heat->cursor + k) % heat->count;
+        HeatEntry *entry = &heat->entries[i];
+        if (entry->next_ms <= now && count < budget) {
+            entry->interval_ms = next_interval(heat, entry, now);
+            entry->next_ms = now + entry->interval_ms;
+            heat->due[count++] = i;
+        }
+        if (entry->next_ms < next) {
+            next = entry->next_ms;
+        }
+    }
+
+    if (heat->count > 0 && count == budget) {
+        heat->cursor = (heat->due[count - 1] + 1) % heat->count; // Over budget: the rest go first next time
+    }
+    heat->next_ms = next;
+    heat->polls += (unsigned long)count;
+    *indices = heat->due;
+    return count;
+}
+
+void poll_heat_changed(PollHeat *heat, int index, uint64_t now) {
+    if (index >= heat->count) {
+        return;
+    }
+    HeatEntry *entry = &heat->entries[index];
+    entry->last_change_ms = now;
+    entry->interval_ms = heat->min_ms;
+    entry->next_ms = now + heat->min_ms;
+    if (entry->heat < HEAT_MAX) {
+        entry->heat++;
+    }
+    if (entry->next_ms < heat->next_ms) {
+        heat->next_ms = entry->next_ms;
+    }
+}
+
+uint64_t poll_heat_next_ms(const PollHeat *heat) {
+    return heat->count ? heat->next_ms : UINT64_MAX;
+}
+
+void poll_heat_stats(const PollHeat *heat, PollHeatStats *stats) {
+    memset(stats, 0, sizeof(*stats));
+    for (int i = 0; i < heat->count; ++i) {
+        unsigned int interval = heat->entries[i].interval_ms;
+        if (interval <= heat->min_ms) {
+            stats->hot++;
+        } else if (interval >= heat->max_ms) {
+            stats->cold++;
+        } else {
+            stats->cooling++;
+        }
+    }
+    stats->polls = heat->polls;
+}
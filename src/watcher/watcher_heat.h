@@ -0,0 +1,50 @@
+/*
+    Copyright © 2025 Mint teams
+    watcher_heat.h
+    The generic Node.js process watcher
+*/
+
+#ifndef WATCHER_HEAT_H
+#define WATCHER_HEAT_H
+
+#include <stdint.h>
+
+/*
+    Per-entry polling schedule (--poll-max). An entry that changed in the
+    last hot window is polled every tick; once quiet, its interval doubles
+    on every poll up to the ceiling. Each change adds heat, and a hotter
+    entry keeps a longer hot window, so the file being edited right now is
+    checked every tick while the rest of the tree costs a stat every
+    couple of seconds. Used for files and for directory rescans.
+*/
+typedef struct PollHeat PollHeat;
+
+PollHeat *poll_heat_create(unsigned int min_ms, unsigned int max_ms);
+void poll_heat_destroy(PollHeat *heat);
+
+// Tracks `count` entries; entries added since the last call start hot.
+int poll_heat_resize(PollHeat *heat, int count, uint64_t now);
+
+/*
+    Picks the entries due at `now`, at most `budget` of them (0 = all),
+    and schedules each one's next poll as if it turns out unchanged.
+    Returns the count; the indices stay valid until the next call.
+*/
+int poll_heat_due(PollHeat *heat, uint64_t now, int budget, const int **indices);
+
+// The poll found a change: back to the tightest interval.
+void poll_heat_changed(PollHeat *heat, int index, uint64_t now);
+
+// Earliest scheduled poll, for sizing the main loop's sleep.
+uint64_t poll_heat_next_ms(const PollHeat *heat);
+
+typedef struct {
+    int hot;        // Polled every tick
+    int cooling;
+    int cold;       // At the ceiling
+    unsigned long polls;
+} PollHeatStats;
+
+void poll_heat_stats(const PollHeat *heat, PollHeatStats *stats);
+
+#endif // WATCHER_HEAT_H
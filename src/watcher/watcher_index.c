@@ -0,0 +1,81 @@
+/*
+    Copyright © 2025 Mint teams
+    watcher_index.c
+    The generic Node.js process watcher
+*/
+
+#include <stdlib.h>
+#include <string.h>
+#include <stdint.h>
+
+#include <watcher/watcher_index.h>
+
+static const size_t INDEX_MIN_CAPACITY = 64;
+
+static uint64_t hash_path(const char *path) {
+    uint64_t hash = 1469598103934665603ULL; // FNV-1a
+    while (*path) {
+        hash ^= (unsigned char)*path++;
+        hash *= 1099511628211ULL;
+    }
+    return hash;
+}
+
+void path_index_init(PathIndex *index) {
+    index->slots = NULL;
+    index->capacity = 0;
+    index->used = 0;
+}
+
+void path_index_free(PathIndex *index) {
+    free(index->slots);
+    path_index_init(index);
+}
+
+int path_index_find(const PathIndex *index, char **paths, const char *path) {
+    if (index->capacity == 0) {
+        return -1;
+    }
+    size_t mask = index->capacity - 1;
+    for (size_t slot = hash_path(path) & mask;; slot = (slot + 1) & mask) {
+        int pos = index->slots[slot];
+        if (pos < 0) {
+            return -1;
+        }
+        if (strcmp(paths[pos], path) == 0) {
+            return pos;
+        }
+    }
+}
+
+static void place(int *slots, size_t mask, char **paths, int pos) {
+    size_t slot = hash_path(paths[pos]) & mask;
+    while (slots[slot] >= 0) {
+        slot = (slot + 1) & mask;
+    }
+    slots[slot] = pos;
+}
+
+int path_index_insert(PathIndex *index, char **paths, int pos) {
+    // Keep the load factor under 1/2 so probes stay short.
+    if ((index->used + 1) * 2 > index->capacity) {
+        size_t capacity = index->capacity ? index->capacity * 2 : INDEX_MIN_CAPACITY;
+        int *slots = malloc(sizeof(int) * capacity);
+        if (!slots) {
+            return -1;
+        }
+        memset(slots, 0xff, sizeof(int) * capacity);
+        for (size_t i = 0; i < index->capacity; ++i) {
+            if (index->slots[i] >= 0) {
+                place(slots, capacity - 1, paths, index->slots[i]);
+            }
+        }
+        free(index->slots);
+        index->slots = slots;
+        index->capacity = capacity;
+    }
+
+    place(index->slots, index->capacity - 1, paths, pos);
+    index->used++;
+    return 0;
+}
@@ -0,0 +1,31 @@
+/*
+    Copyright © 2025 Mint teams
+    watcher_index.h
+    The generic Node.js process watcher
+*/
+
+#ifndef WATCHER_INDEX_H
+#define WATCHER_INDEX_H
+
+#include <stddef.h>
+
+/*
+    Open-addressing hash of path -> position in files_to_watch.
+    The index stores positions only; the strings stay in the table.
+*/
+typedef struct {
+    int *slots;       // -1 = empty
+    size_t capacity;  // Always a power of two
+    size_t used;
+} PathIndex;
+
+void path_index_init(PathIndex *index);
+void path_index_free(PathIndex *index);
+
+// Returns the table position of `path`, or -1.
+int path_index_find(const PathIndex *index, char **paths, const char *path);
+
+// Adds table position `pos` (paths[pos] must be set). Returns -1 on OOM.
+int path_index_insert(PathIndex *index, char **paths, int pos);
+
+#endif // WATCHER_INDEX_H
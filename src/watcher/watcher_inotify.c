@@ -0,0 +1,489 @@
+/*
+    Copyright © 2025 Mint teams
+    watcher_inotify.c
+    The generic Node.js process watcher
+*/
+
+#include <errno.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <stdint.h>
+
+#include <watcher/watcher_inotify.h>
+#include <watcher/watcher_actions.h>
+#include <arch/syscalls.h>
+
+#ifdef __linux__
+#include <limits.h>
+#include <unistd.h>
+#include <sys/inotify.h>
+
+#define INOTIFY_MASK (IN_CLOSE_WRITE | IN_ATTRIB | IN_CREATE | IN_DELETE | \
+                      IN_MOVED_FROM | IN_MOVED_TO)
+
+// Events that change content under a name; IN_MODIFY alone never reaches the table.
+#define INOTIFY_WRITE_MASK (IN_MODIFY | IN_CREATE | IN_DELETE | IN_MOVED_FROM | IN_MOVED_TO)
+
+static const unsigned int COLD_POLL_MIN_MS = 1000;
+static const unsigned int COLD_POLL_MAX_MS = 30000;
+static const unsigned int REBALANCE_INTERVAL_MS = 5000;
+static const int REBALANCE_MAX_SWAPS = 16;
+
+typedef struct {
+    char *path;                 // As spelled in the watch table ("" = cwd)
+    int enumerate;              // Watched directory (1) or parent of explicit files (0)
+    int wd;                     // Kernel watch, -1 while polled
+    unsigned int heat;          // Changes seen, halved at every rebalance
+    unsigned int poll_interval_ms;
+    uint64_t next_poll_ms;
+} InotifyDir;
+
+struct InotifyBackend {
+    int fd;
+    InotifyDir *dirs;
+    int dir_count;
+    int *wd_dirs;               // wd -> dir index
+    int wd_capacity;
+    int *file_dirs;             // file index -> dir index
+    int file_capacity;
+    unsigned char *due;         // Scratch: dirs polled this tick
+    int budget;                 // 0 = whatever the kernel allows
+    uint32_t mask;              // INOTIFY_MASK, plus IN_MODIFY when writes are reported
+    int kernel_limit;           // Watches held when ENOSPC was last hit, 0 = never
+    int watched;
+    uint64_t next_rebalance_ms;
+    unsigned long swaps;
+    unsigned long cold_polls;
+};
+
+static int find_dir(const InotifyBackend *backend, const char *path, size_t len) {
+    for (int i = 0; i < backend->dir_count; ++i) {
+        if (strlen(backend->dirs[i].path) == len && strncmp(backend->dirs[i].path, path, len) == 0) {
+            return i;
+        }
+    }
+    return -1;
+}
+
+static int add_dir(InotifyBackend *backend, const char *path, size_t len, int enumerate) {
+    int i = find_dir(backend, path, len);
+    if (i >= 0) {
+        backend->dirs[i].enumerate |= enumerate;
+        return i;
+    }
+
+    InotifyDir *dirs = realloc(backend->dirs, sizeof(InotifyDir) * (backend->dir_count + 1));
+    if (!dirs) {
+        return -1;
+    }
+    backend->dirs = dirs;
+
+    InotifyDir *dir = &dirs[backend->dir_count];
+    dir->path = strndup(path, len);
+    if (!dir->path) {
+        return -1;
+    }
+    dir->enumerate = enumerate;
+    dir->wd = -1;
+    dir->heat = 0;
+    dir->poll_interval_ms = COLD_POLL_MIN_MS;
+    dir->next_poll_ms = 0;
+    return backend->dir_count++;
+}
+
+// Length of the parent directory prefix of a table path ("" for bare names).
+static size_t parent_len(const char *file) {
+    const char *slash = strrchr(file, '/');
+    if (!slash) {
+        return 0;
+    }
+    return slash == file ? 1 : (size_t)(slash - file);
+}
+
+// Parent directory of a table path, as an index into dirs (or -1).
+static int dir_of_file(const InotifyBackend *backend, const char *file) {
+    return find_dir(backend, file, parent_len(file));
+}
+
+static int place_watch(InotifyBackend *backend, int d) {
+    InotifyDir *dir = &backend->dirs[d];
+    if (backend->budget > 0 && backend->watched >= backend->budget) {
+        errno = ENOSPC;
+        return -1;
+    }
+
+    int wd = inotify_add_watch(backend->fd, dir->path[0] ? dir->path : ".", backend->mask);
+    if (wd < 0) {
+        if (errno == ENOSPC) {
+            backend->kernel_limit = backend->watched;
+        }
+        return -1;
+    }
+
+    if (wd >= backend->wd_capacity) {
+        int capacity = backend->wd_capacity ? backend->wd_capacity : 64;
+        while (capacity <= wd) {
+            capacity *= 2;
+        }
+        int *map = realloc(backend->wd_dirs, sizeof(int) * capacity);
+        if (!map) {
+            inotify_rm_watch(backend->fd, wd);
+            return -1;
+        }
+        for (int i = backend->wd_capacity; i < capacity; ++i) {
+            map[i] = -1;
+        }
+        backend->wd_dirs = map;
+        backend->wd_capacity = capacity;
+    }
+
+    if (backend->wd_dirs[wd] >= 0) {
+        // Same inode under another spelling; the first entry keeps the watch.
+        errno = EEXIST;
+        return -1;
+    }
+
+    backend->wd_dirs[wd] = d;
+    dir->wd = wd;
+    backend->watched++;
+    return 0;
+}
+
+static void drop_watch(InotifyBackend *backend, int d, uint64_t now) {
+    InotifyDir *dir = &backend->dirs[d];
+    if (dir->wd < 0) {
+        return;
+    }
+    inotify_rm_watch(backend->fd, dir->wd);
+    backend->wd_dirs[dir->wd] = -1;
+    dir->wd = -1;
+    dir->poll_interval_ms = COLD_POLL_MIN_MS;
+    dir->next_poll_ms = now;
+    backend->watched--;
+}
+
+static int grow_file_map(InotifyBackend *backend, int count) {
+    if (count <= backend->file_capacity) {
+        return 0;
+    }
+    int capacity = backend->file_capacity ? backend->file_capacity : 256;
+    while (capacity < count) {
+        capacity *= 2;
+    }
+    int *map = realloc(backend->file_dirs, sizeof(int) * capacity);
+    if (!map) {
+        return -1;
+    }
+    backend->file_dirs = map;
+    backend->file_capacity = capacity;
+    return 0;
+}
+
+InotifyBackend *inotify_backend_open(Watcher *watcher, int budget) {
+    InotifyBackend *backend = calloc(1, sizeof(InotifyBackend));
+    if (!backend) {
+        return NULL;
+    }
+    backend->budget = budget;
+    backend->mask = INOTIFY_MASK;
+    backend->fd = inotify_init1(IN_NONBLOCK | IN_CLOEXEC);
+    if (backend->fd < 0) {
+        int saved = errno;
+        free(backend);
+        errno = saved;
+        return NULL;
+    }
+
+    // Explicitly watched directories first: they get the budget before parents of single files.
+    for (int i = 0; i < watcher->dir_count; ++i) {
+        add_dir(backend, watcher->dirs_to_watch[i], strlen(watcher->dirs_to_watch[i]), 1);
+    }
+    for (int i = 0; i < watcher->file_count; ++i) {
+        add_dir(backend, watcher->files_to_watch[i], parent_len(watcher->files_to_watch[i]), 0);
+    }
+
+    backend->due = calloc((size_t)backend->dir_count + 1, 1);
+    if (!backend->due || grow_file_map(backend, watcher->file_count) != 0) {
+        inotify_backend_close(backend);
+        errno = ENOMEM;
+        return NULL;
+    }
+    for (int i = 0; i < watcher->file_count; ++i) {
+        backend->file_dirs[i] = dir_of_file(backend, watcher->files_to_watch[i]);
+    }
+
+    for (int d = 0; d < backend->dir_count; ++d) {
+        if (place_watch(backend, d) != 0 && errno == ENOSPC) {
+            break; // Out of budget: everything after this starts out polled
+        }
+    }
+
+    if (backend->watched == 0) {
+        inotify_backend_close(backend);
+        errno = ENOSPC;
+        return NULL;
+    }
+
+    uint64_t now = watcher_clock_ms();
+    backend->next_rebalance_ms = now + REBALANCE_INTERVAL_MS;
+    for (int d = 0; d < backend->dir_count; ++d) {
+        backend->dirs[d].next_poll_ms = now + COLD_POLL_MIN_MS;
+    }
+    return backend;
+}
+
+void inotify_backend_close(InotifyBackend *backend) {
+    if (!backend) {
+        return;
+    }
+    for (int i = 0; i < backend->dir_count; ++i) {
+        free(backend->dirs[i].path);
+    }
+    free(backend->dirs);
+    free(backend->wd_dirs);
+    free(backend->file_dirs);
+    free(backend->due);
+    close(backend->fd); // Drops every remaining watch
+    free(backend);
+}
+
+void inotify_backend_file_added(InotifyBackend *backend, Watcher *watcher, int file_index) {
+    if (grow_file_map(backend, file_index + 1) != 0) {
+        return;
+    }
+    backend->file_dirs[file_index] = dir_of_file(backend, watcher->files_to_watch[file_index]);
+}
+
+static int drain_events(InotifyBackend *backend, Watcher *watcher, uint64_t now) {
+    char buffer[8192] __attribute__((aligned(__alignof__(struct inotify_event))));
+    int hits = 0;
+    int overflow = 0;
+
+    for (;;) {
+        ssize_t len = read(backend->fd, buffer, sizeof(buffer));
+        if (len <= 0) {
+            break; // EAGAIN: queue drained
+        }
+
+        for (char *p = buffer; p < buffer + len; p += sizeof(struct inotify_event) + ((struct inotify_event *)p)->len) {
+            struct inotify_event *event = (struct inotify_event *)p;
+            if (event->mask & IN_Q_OVERFLOW) {
+                overflow = 1;
+                continue;
+            }
+            if (event->wd < 0 || event->wd >= backend->wd_capacity || backend->wd_dirs[event->wd] < 0) {
+                continue; // Watch we already dropped
+            }
+
+            int d = backend->wd_dirs[event->wd];
+            InotifyDir *dir = &backend->dirs[d];
+            if (event->mask & IN_IGNORED) {
+                // Directory deleted or unmounted: keep an eye on it by polling.
+                backend->wd_dirs[event->wd] = -1;
+                dir->wd = -1;
+                dir->next_poll_ms = now;
+                backend->watched--;
+                continue;
+            }
+            if (event->len == 0 || (event->mask & IN_ISDIR)) {
+                continue;
+            }
+            int write = (backend->mask & IN_MODIFY) && (event->mask & INOTIFY_WRITE_MASK);
+            if (!write && !(event->mask & INOTIFY_MASK)) {
+                continue;
+            }
+
+            char path[PATH_MAX];
+            if (dir->path[0] == '\0') {
+                snprintf(path, sizeof(path), "%s", event->name);
+            } else if (strcmp(dir->path, "/") == 0) {
+                snprintf(path, sizeof(path), "/%s", event->name);
+            } else {
+                snprintf(path, sizeof(path), "%s/%s", dir->path, event->name);
+            }
+            if (write) {
+                watcher_on_write(watcher, path, dir->enumerate);
+            }
+            if ((event->mask & INOTIFY_MASK) && watcher_on_event(watcher, path, dir->enumerate)) {
+                dir->heat++;
+                hits++;
+            }
+        }
+    }
+
+    return overflow ? -1 : hits;
+}
+
+static int poll_cold_dirs(InotifyBackend *backend, Watcher *watcher, uint64_t now) {
+    int any_due = 0;
+    for (int d = 0; d < backend->dir_count; ++d) {
+        InotifyDir *dir = &backend->dirs[d];
+        backend->due[d] = dir->wd < 0 && now >= dir->next_poll_ms;
+        if (backend->due[d]) {
+            any_due = 1;
+            backend->cold_polls++;
+            if (dir->enumerate) {
+                watcher_scan_directory(watcher, dir->path[0] ? dir->path : ".");
+            }
+        }
+    }
+    if (!any_due) {
+        return 0;
+    }
+
+    // One pass over the table stats every file of every due directory.
+    int touched = 0;
+    for (int i = 0; i < watcher->file_count; ++i) {
+        int d = backend->file_dirs[i];
+        if (d < 0 || !backend->due[d]) {
+            continue;
+        }
+        watcher->current_mtimes[i] = get_mtime_asm(watcher->files_to_watch[i]);
+        if (watcher->current_mtimes[i] != watcher->last_mtimes[i]) {
+            backend->dirs[d].heat++;
+            backend->due[d] = 2; // Changed: poll it eagerly again
+            touched++;
+        }
+    }
+
+    for (int d = 0; d < backend->dir_count; ++d) {
+        InotifyDir *dir = &backend->dirs[d];
+        if (backend->due[d] == 2) {
+            dir->poll_interval_ms = COLD_POLL_MIN_MS;
+        } else if (backend->due[d] == 1 && dir->poll_interval_ms < COLD_POLL_MAX_MS) {
+            dir->poll_interval_ms *= 2;
+            if (dir->poll_interval_ms > COLD_POLL_MAX_MS) {
+                dir->poll_interval_ms = COLD_POLL_MAX_MS;
+            }
+        }
+        if (backend->due[d]) {
+            dir->next_poll_ms = now + dir->poll_interval_ms;
+        }
+    }
+    return touched;
+}
+
+/*
+    Moves kernel watches from the coldest watched directories to the
+    hottest polled ones, and takes back any room the kernel freed up.
+    Heat halves every round so old activity fades out.
+*/
+static void rebalance(InotifyBackend *backend, uint64_t now) {
+    if (now < backend->next_rebalance_ms) {
+        return;
+    }
+    backend->next_rebalance_ms = now + REBALANCE_INTERVAL_MS;
+
+    for (int round = 0; round < REBALANCE_MAX_SWAPS && backend->watched < backend->dir_count; ++round) {
+        int hot = -1;
+        int cold = -1;
+        for (int d = 0; d < backend->dir_count; ++d) {
+            InotifyDir *dir = &backend->dirs[d];
+            if (dir->wd < 0) {
+                if (hot < 0 || dir->heat > backend->dirs[hot].heat) {
+                    hot = d;
+                }
+            } else if (cold < 0 || dir->heat < backend->dirs[cold].heat) {
+                cold = d;
+            }
+        }
+        if (hot < 0) {
+            break;
+        }
+
+        // Room left under the budget, or the kernel freed some: just add.
+        if (place_watch(backend, hot) == 0) {
+            continue;
+        }
+
+        if (cold < 0 || backend->dirs[hot].heat <= backend->dirs[cold].heat) {
+            break;
+        }
+        drop_watch(backend, cold, now);
+        if (place_watch(backend, hot) != 0) {
+            place_watch(backend, cold); // Put things back the way they were
+            break;
+        }
+        backend->swaps++;
+    }
+
+    for (int d = 0; d < backend->dir_count; ++d) {
+        backend->dirs[d].heat /= 2;
+    }
+}
+
+int inotify_backend_check(InotifyBackend *backend, Watcher *watcher) {
+    uint64_t now = watcher_clock_ms();
+    int hits = drain_events(backend, watcher, now);
+    if (hits < 0) {
+        return -1;
+    }
+    hits += poll_cold_dirs(backend, watcher, now);
+    rebalance(backend, now);
+    return hits;
+}
+
+void inotify_backend_report_writes(InotifyBackend *backend) {
+    backend->mask |= IN_MODIFY;
+    for (int d = 0; d < backend->dir_count; ++d) {
+        if (backend->dirs[d].wd >= 0) {
+            // Same inode: the kernel updates the mask of the watch already there
+            inotify_add_watch(backend->fd, backend->dirs[d].path[0] ? backend->dirs[d].path : ".", backend->mask);
+        }
+    }
+}
+
+void inotify_backend_print_stats(const InotifyBackend *backend) {
+    unsigned int fastest = 0;
+    unsigned int slowest = 0;
+    for (int d = 0; d < backend->dir_count; ++d) {
+        const InotifyDir *dir = &backend->dirs[d];
+        if (dir->wd >= 0) {
+            continue;
+        }
+        if (fastest == 0 || dir->poll_interval_ms < fastest) {
+            fastest = dir->poll_interval_ms;
+        }
+        if (dir->poll_interval_ms > slowest) {
+            slowest = dir->poll_interval_ms;
+        }
+    }
+
+    printf("[Watcher stats] inotify: %d/%d directories on kernel watches", backend->watched, backend->dir_count);
+    if (backend->budget > 0) {
+        printf(" (budget %d)", backend->budget);
+    } else if (backend->kernel_limit > 0) {
+        printf(" (kernel limit hit at %d)", backend->kernel_limit);
+    }
+    printf("\n");
+    if (backend->watched < backend->dir_count) {
+        printf("[Watcher stats] inotify: %d polled every %.1f-%.1fs, %lu cold polls\n",
+               backend->dir_count - backend->watched, fastest / 1000.0, slowest / 1000.0, backend->cold_polls);
+    }
+    printf("[Watcher stats] inotify: %lu hot/cold swaps\n", backend->swaps);
+}
+
+#else // No inotify on this platform
+
+InotifyBackend *inotify_backend_open(Watcher *watcher, int budget) {
+    (void)watcher; (void)budget;
+    errno = ENOSYS;
+    return NULL;
+}
+
+void inotify_backend_close(InotifyBackend *backend) { (void)backend; }
+
+void inotify_backend_file_added(InotifyBackend *backend, Watcher *watcher, int file_index) {
+    (void)backend; (void)watcher; (void)file_index;
+}
+
+int inotify_backend_check(InotifyBackend *backend, Watcher *watcher) {
+    (void)backend; (void)watcher;
+    return 0;
+}
+
+void inotify_backend_report_writes(InotifyBackend *backend) { (void)backend; }
+
+void inotify_backend_print_stats(const InotifyBackend *backend) { (void)backend; }
+#endif
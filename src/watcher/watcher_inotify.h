@@ -0,0 +1,44 @@
+/*
+    Copyright © 2025 Mint teams
+    watcher_inotify.h
+    The generic Node.js process watcher
+*/
+
+#ifndef WATCHER_INOTIFY_H
+#define WATCHER_INOTIFY_H
+
+#include <watcher/watcher.h>
+
+/*
+    inotify backend with a watch budget. Kernel watches go to the
+    directories that changed most recently or most often; the rest are
+    polled at an adaptive, slower rate. The split is revisited as
+    activity moves around, so kavin keeps working when
+    fs.inotify.max_user_watches is too low for the whole tree.
+*/
+typedef struct InotifyBackend InotifyBackend;
+
+// Returns NULL when inotify is unavailable or not a single watch fits.
+InotifyBackend *inotify_backend_open(Watcher *watcher, int budget);
+void inotify_backend_close(InotifyBackend *backend);
+
+// Keeps the file -> directory map current; call after a file is appended.
+void inotify_backend_file_added(InotifyBackend *backend, Watcher *watcher, int file_index);
+
+/*
+    Drains events, polls the cold directories that are due and rebalances
+    the budget. Refreshes current_mtimes for every touched entry and
+    returns how many there were, or -1 when the event queue overflowed.
+*/
+int inotify_backend_check(InotifyBackend *backend, Watcher *watcher);
+
+/*
+    Also reports bare writes (IN_MODIFY) to watcher_on_write(), for
+    --build-speculative. They never count as changes: those still wait
+    for the close, rename or delete that ends a save.
+*/
+void inotify_backend_report_writes(InotifyBackend *backend);
+
+void inotify_backend_print_stats(const InotifyBackend *backend);
+
+#endif // WATCHER_INOTIFY_H
@@ -0,0 +1,216 @@
+/*
+    Copyright © 2025 Mint teams
+    watcher_poll.c
+    The generic Node.js process watcher
+*/
+
+#include <stdio.h>
+#include <stdlib.h>
+
+#include <watcher/watcher_poll.h>
+#include <arch/syscalls.h>
+
+#ifdef _WIN32
+
+PollPool *poll_pool_create(int workers) {
+    (void)workers;
+    return NULL;
+}
+
+void poll_pool_destroy(PollPool *pool) { (void)pool; }
+
+void poll_pool_submit(PollPool *pool, char **paths, time_t *out_mtimes, int total, int start, int count) {
+    (void)pool; (void)paths; (void)out_mtimes; (void)total; (void)start; (void)count;
+}
+
+void poll_pool_submit_indices(PollPool *pool, char **paths, time_t *out_mtimes, const int *indices, int count) {
+    (void)pool; (void)paths; (void)out_mtimes; (void)indices; (void)count;
+}
+
+int poll_pool_wait(PollPool *pool) {
+    (void)pool;
+    return 0;
+}
+
+int poll_pool_workers(const PollPool *pool) {
+    (void)pool;
+    return 1;
+}
+
+#else // POSIX implementation
+#include <pthread.h>
+
+// Entries claimed per grab; small enough to balance slow shards.
+static const int POLL_CHUNK = 32;
+
+struct PollPool {
+    pthread_t *threads;
+    int workers;
+
+    pthread_mutex_t lock;
+    pthread_cond_t work_ready;
+    pthread_cond_t work_done;
+
+    // Current pass, guarded by `lock` except for `next`.
+    char **paths;
+    time_t *out_mtimes;
+    const int *indices; // Entries to stat, or NULL for the window below
+    int total;
+    int start;
+    int count;
+    int next;
+    unsigned long generation;
+    int busy_workers;
+    int pending;
+    int stopping;
+};
+
+static void run_shard(PollPool *pool) {
+    for (;;) {
+        int begin = __atomic_fetch_add(&pool->next, POLL_CHUNK, __ATOMIC_RELAXED);
+        if (begin >= pool->count) {
+            return;
+        }
+        int end = begin + POLL_CHUNK < pool->count ? begin + POLL_CHUNK : pool->count;
+        for (int k = begin; k < end; ++k) {
+            int i = pool->indices ? pool->indices[k] : (pool->start + k) % pool->total;
+            pool->out_mtimes[i] = get_mtime_asm(pool->paths[i]);
+        }
+    }
+}
+
+static void *poll_worker(void *arg) {
+    PollPool *pool = arg;
+    unsigned long seen = 0;
+
+    pthread_mutex_lock(&pool->lock);
+    for (;;) {
+        while (!pool->stopping && pool->generation == seen) {
+            pthread_cond_wait(&pool->work_ready, &pool->lock);
+        }
+        if (pool->stopping) {
+            break;
+        }
+        seen = pool->generation;
+        pthread_mutex_unlock(&pool->lock);
+
+        run_shard(pool);
+
+        pthread_mutex_lock(&pool->lock);
+        if (--pool->busy_workers == 0) {
+            pthread_cond_signal(&pool->work_done);
+        }
+    }
+    pthread_mutex_unlock(&pool->lock);
+    return NULL;
+}
+
+PollPool *poll_pool_create(int workers) {
+    if (workers < 2) {
+        return NULL;
+    }
+
+    PollPool *pool = calloc(1, sizeof(PollPool));
+    if (!pool) {
+        return NULL;
+    }
+    pool->threads = calloc((size_t)workers, sizeof(pthread_t));
+    if (!pool->threads) {
+        free(pool);
+        return NULL;
+    }
+
+    pthread_mutex_init(&pool->lock, NULL);
+    pthread_cond_init(&pool->work_ready, NULL);
+    pthread_cond_init(&pool->work_done, NULL);
+
+    for (int i = 0; i < workers; ++i) {
+        if (pthread_create(&pool->threads[i], NULL, poll_worker, pool) != 0) {
+            perror("[Watcher warning] Failed to start poll worker");
+            break;
+        }
+        pool->workers++;
+    }
+
+    if (pool->workers < 2) {
+        poll_pool_destroy(pool);
+        return NULL;
+    }
+    return pool;
+}
+
+void poll_pool_destroy(PollPool *pool) {
+    if (!pool) {
+        return;
+    }
+    poll_pool_wait(pool);
+
+    pthread_mutex_lock(&pool->lock);
+    pool->stopping = 1;
+    pthread_cond_broadcast(&pool->work_ready);
+    pthread_mutex_unlock(&pool->lock);
+
+    for (int i = 0; i < pool->workers; ++i) {
+        pthread_join(pool->threads[i], NULL);
+    }
+
+    pthread_cond_destroy(&pool->work_done);
+    pthread_cond_destroy(&pool->work_ready);
+    pthread_mutex_destroy(&pool->lock);
+    free(pool->threads);
+    free(pool);
+}
+
+void poll_pool_submit(PollPool *pool, char **paths, time_t *out_mtimes, int total, int start, int count) {
+    if (total <= 0 || count <= 0) {
+        return;
+    }
+    pthread_mutex_lock(&pool->lock);
+    pool->paths = paths;
+    pool->out_mtimes = out_mtimes;
+    pool->indices = NULL;
+    pool->total = total;
+    pool->start = start % total;
+    pool->count = count < total ? count : total;
+    pool->next = 0;
+    pool->busy_workers = pool->workers;
+    pool->pending = 1;
+    pool->generation++;
+    pthread_cond_broadcast(&pool->work_ready);
+    pthread_mutex_unlock(&pool->lock);
+}
+
+void poll_pool_submit_indices(PollPool *pool, char **paths, time_t *out_mtimes, const int *indices, int count) {
+    if (count <= 0) {
+        return;
+    }
+    pthread_mutex_lock(&pool->lock);
+    pool->paths = paths;
+    pool->out_mtimes = out_mtimes;
+    pool->indices = indices;
+    pool->total = count;
+    pool->start = 0;
+    pool->count = count;
+    pool->next = 0;
+    pool->busy_workers = pool->workers;
+    pool->pending = 1;
+    pool->generation++;
+    pthread_cond_broadcast(&pool->work_ready);
+    pthread_mutex_unlock(&pool->lock);
+}
+
+int poll_pool_wait(PollPool *pool) {
+    pthread_mutex_lock(&pool->lock);
+    int had_pass = pool->pending;
+    while (pool->pending && pool->busy_workers > 0) {
+        pthread_cond_wait(&pool->work_done, &pool->lock);
+    }
+    pool->pending = 0;
+    pthread_mutex_unlock(&pool->lock);
+    return had_pass;
+}
+
+int poll_pool_workers(const PollPool *pool) {
+    return pool ? pool->workers : 1;
+}
+#endif
@@ -0,0 +1,38 @@
+/*
+    Copyright © 2025 Mint teams
+    watcher_poll.h
+    The generic Node.js process watcher
+*/
+
+#ifndef WATCHER_POLL_H
+#define WATCHER_POLL_H
+
+#include <time.h>
+
+/*
+    A small pool of stat threads. One pass stats a window of the
+    watch table split into shards, so slow network filesystems
+    (NFS, FUSE) get several stat calls in flight at once.
+*/
+typedef struct PollPool PollPool;
+
+// Returns NULL when threads are unavailable; callers then stat serially.
+PollPool *poll_pool_create(int workers);
+void poll_pool_destroy(PollPool *pool);
+
+/*
+    Starts a pass in the background: stats `count` entries of `paths`
+    starting at `start` (wrapping around `total`) into `out_mtimes`.
+    The arrays must stay untouched until poll_pool_wait() returns.
+*/
+void poll_pool_submit(PollPool *pool, char **paths, time_t *out_mtimes, int total, int start, int count);
+
+// Same, for the `count` entries listed in `indices` (kept alive until the wait).
+void poll_pool_submit_indices(PollPool *pool, char **paths, time_t *out_mtimes, const int *indices, int count);
+
+// Blocks until the submitted pass is done. Returns 0 if none was pending.
+int poll_pool_wait(PollPool *pool);
+
+int poll_pool_workers(const PollPool *pool);
+
+#endif // WATCHER_POLL_H
@@ -0,0 +1,221 @@
+/*
+    Copyright © 2025 Mint teams
+    watcher_psi.c
+    The generic Node.js process watcher
+*/
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+
+#ifdef __linux__
+#include <fcntl.h>
+#include <unistd.h>
+#endif
+
+#include <watcher/watcher_psi.h>
+
+// avg10 itself moves slowly; reading it every tick would only cost syscalls.
+static const uint64_t PSI_SAMPLE_MS = 1000;
+
+enum { PSI_CPU, PSI_MEMORY, PSI_IO, PSI_RESOURCES };
+
+static const char *const PSI_NAMES[PSI_RESOURCES] = { "cpu", "memory", "io" };
+
+struct PsiGuard {
+    char dir[512];
+    int fds[PSI_RESOURCES];     // -1 for a resource the kernel doesn't report
+    double levels[PSI_RESOURCES];
+    double threshold;
+    int sampled;
+    uint64_t last_sample_ms;
+    int throttled;
+    uint64_t throttle_start_ms;
+    uint64_t throttled_ms;      // Closed episodes only
+    unsigned long episodes;
+};
+
+#ifdef __linux__
+
+// "some avg10=12.34 avg60=... total=...": the first avg10 is the "some" line
+static int read_level(int fd, double *level) {
+    char buffer[256];
+    ssize_t n = pread(fd, buffer, sizeof(buffer) - 1, 0);
+    if (n <= 0) {
+        return -1;
+    }
+    buffer[n] = '\0';
+    const char *avg10 = strstr(buffer, "avg10=");
+    if (!avg10) {
+        return -1;
+    }
+    *level = strtod(avg10 + 6, NULL);
+    return 0;
+}
+
+static int psi_sample(PsiGuard *guard) {
+    int read = 0;
+    for (int i = 0; i < PSI_RESOURCES; ++i) {
+        if (guard->fds[i] >= 0 && read_level(guard->fds[i], &guard->levels[i]) == 0) {
+            read++;
+        }
+    }
+    return read > 0 ? 0 : -1;
+}
+
+// Opens whichever of cpu/memory/io `dir` has; returns how many.
+static int open_files(PsiGuard *guard, const char *dir, const char *suffix) {
+    int opened = 0;
+    for (int i = 0; i < PSI_RESOURCES; ++i) {
+        char path[600];
+        snprintf(path, sizeof(path), "%s/%s%s", dir, PSI_NAMES[i], suffix);
+        guard->fds[i] = open(path, O_RDONLY | O_CLOEXEC);
+        opened += guard->fds[i] >= 0;
+    }
+    if (opened > 0) {
+        snprintf(guard->dir, sizeof(guard->dir), "%s", dir);
+    }
+    return opened;
+}
+
+/*
+    Our cgroup v2 directory, from the "0::<path>" line of /proc/self/cgroup.
+    Pure v2 mounts it at /sys/fs/cgroup, hybrid setups at .../unified.
+*/
+static int open_cgroup_files(PsiGuard *guard) {
+    FILE *file = fopen("/proc/self/cgroup", "r");
+    if (!file) {
+        return 0;
+    }
+    char line[512];
+    char cgroup[512] = "";
+    while (fgets(line, sizeof(line), file)) {
+        if (strncmp(line, "0::", 3) == 0) {
+            line[strcspn(line, "\n")] = '\0';
+            snprintf(cgroup, sizeof(cgroup), "%s", strcmp(line + 3, "/") == 0 ? "" : line + 3);
+            break;
+        }
+    }
+    fclose(file);
+
+    static const char *const ROOTS[] = { "/sys/fs/cgroup", "/sys/fs/cgroup/unified" };
+    for (size_t i = 0; i < sizeof(ROOTS) / sizeof(ROOTS[0]); ++i) {
+        char dir[512];
+        if (snprintf(dir, sizeof(dir), "%s%s", ROOTS[i], cgroup) < (int)sizeof(dir) &&
+            open_files(guard, dir, ".pressure") > 0) {
+            return 1;
+        }
+    }
+    return 0;
+}
+
+PsiGuard *psi_guard_open(const char *source, int threshold_pct) {
+    PsiGuard *guard = calloc(1, sizeof(PsiGuard));
+    if (!guard) {
+        return NULL;
+    }
+    guard->threshold = threshold_pct;
+
+    int opened = 0;
+    if (strcmp(source, "cgroup") != 0) {
+        opened = open_files(guard, "/proc/pressure", "") > 0;
+    }
+    if (!opened && strcmp(source, "system") != 0) {
+        opened = open_cgroup_files(guard);
+    }
+    // The files exist but can't be read when the kernel runs with psi=0
+    if (!opened || psi_sample(guard) != 0) {
+        psi_guard_close(guard);
+        return NULL;
+    }
+    return guard;
+}
+
+void psi_guard_close(PsiGuard *guard) {
+    if (!guard) {
+        return;
+    }
+    for (int i = 0; i < PSI_RESOURCES; ++i) {
+        if (guard->fds[i] > 0) {
+            close(guard->fds[i]);
+        }
+    }
+    free(guard);
+}
+
+#else
+
+PsiGuard *psi_guard_open(const char *source, int threshold_pct) {
+    (void)source; (void)threshold_pct;
+    return NULL; // Linux only
+}
+
+void psi_guard_close(PsiGuard *guard) {
+    free(guard);
+}
+
+static int psi_sample(PsiGuard *guard) {
+    (void)guard;
+    return -1;
+}
+
+#endif
+
+int psi_guard_poll(PsiGuard *guard, uint64_t now_ms) {
+    if (guard->sampled && now_ms - guard->last_sample_ms < PSI_SAMPLE_MS) {
+        return 0;
+    }
+    guard->sampled = 1;
+    guard->last_sample_ms = now_ms;
+    if (psi_sample(guard) != 0) {
+        return 0;
+    }
+
+    double worst;
+    psi_guard_worst(guard, &worst);
+    if (!guard->throttled && worst >= guard->threshold) {
+        guard->throttled = 1;
+        guard->throttle_start_ms = now_ms;
+        guard->episodes++;
+        return 1;
+    }
+    if (guard->throttled && worst < guard->threshold / 2) {
+        guard->throttled = 0;
+        guard->throttled_ms += now_ms - guard->throttle_start_ms;
+        return 1;
+    }
+    return 0;
+}
+
+int psi_guard_throttled(const PsiGuard *guard) {
+    return guard && guard->throttled;
+}
+
+void psi_guard_levels(const PsiGuard *guard, PsiLevels *levels) {
+    levels->cpu = guard->levels[PSI_CPU];
+    levels->memory = guard->levels[PSI_MEMORY];
+    levels->io = guard->levels[PSI_IO];
+}
+
+const char *psi_guard_worst(const PsiGuard *guard, double *percent) {
+    int worst = PSI_CPU;
+    for (int i = 1; i < PSI_RESOURCES; ++i) {
+        if (guard->levels[i] > guard->levels[worst]) {
+            worst = i;
+        }
+    }
+    *percent = guard->levels[worst];
+    return PSI_NAMES[worst];
+}
+
+const char *psi_guard_source(const PsiGuard *guard) {
+    return guard->dir;
+}
+
+unsigned long psi_guard_episodes(const PsiGuard *guard) {
+    return guard->episodes;
+}
+
+uint64_t psi_guard_throttled_ms(const PsiGuard *guard, uint64_t now_ms) {
+    return guard->throttled_ms + (guard->throttled ? now_ms - guard->throttle_start_ms : 0);
+}
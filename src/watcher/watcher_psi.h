@@ -0,0 +1,59 @@
+/*
+    Copyright © 2025 Mint teams
+    watcher_psi.h
+    The generic Node.js process watcher
+*/
+
+#ifndef WATCHER_PSI_H
+#define WATCHER_PSI_H
+
+#include <stdint.h>
+
+/*
+    Reads Linux pressure stall information (PSI): the share of the last
+    10 seconds some task spent waiting for CPU, memory or IO, from
+    /proc/pressure or from the cgroup kavin runs in. The highest of the
+    three drives a throttle with hysteresis: it starts at the threshold
+    and ends once pressure falls below half of it, so a load hovering
+    around the line doesn't flip it every second.
+
+    While throttled the watcher holds restarts for a longer debounce and
+    may start children at a lower CPU and IO priority.
+*/
+typedef struct PsiGuard PsiGuard;
+
+typedef struct {
+    double cpu;         // "some avg10", in percent
+    double memory;
+    double io;
+} PsiLevels;
+
+/*
+    `source` is "auto" (/proc/pressure, else the cgroup's files),
+    "system" or "cgroup". NULL when the kernel has no PSI for it.
+*/
+PsiGuard *psi_guard_open(const char *source, int threshold_pct);
+void psi_guard_close(PsiGuard *guard);
+
+/*
+    Samples the files, at most once a second; call once per tick.
+    Returns 1 when this poll started or ended throttling.
+*/
+int psi_guard_poll(PsiGuard *guard, uint64_t now_ms);
+
+// NULL-safe: no guard never throttles
+int psi_guard_throttled(const PsiGuard *guard);
+
+void psi_guard_levels(const PsiGuard *guard, PsiLevels *levels);
+
+// "cpu", "memory" or "io", whichever is highest
+const char *psi_guard_worst(const PsiGuard *guard, double *percent);
+
+// The directory the files are read from
+const char *psi_guard_source(const PsiGuard *guard);
+
+// Times throttling started, and its total length including a throttle still on
+unsigned long psi_guard_episodes(const PsiGuard *guard);
+uint64_t psi_guard_throttled_ms(const PsiGuard *guard, uint64_t now_ms);
+
+#endif // WATCHER_PSI_H
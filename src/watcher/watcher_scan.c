@@ -0,0 +1,397 @@
+/*
+    Copyright © 2025 Mint teams
+    watcher_scan.c
+    The generic Node.js process watcher
+*/
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+
+#include <watcher/watcher_scan.h>
+#include <watcher/watcher_actions.h>
+
+#ifdef __linux__
+#include <dirent.h>
+#include <fcntl.h>
+#include <pthread.h>
+#include <sched.h>
+#include <time.h>
+#include <unistd.h>
+#include <sys/stat.h>
+
+#include <arch/syscalls.h>
+
+// A directory of a few thousand entries comes back in one syscall.
+#define DENTS_BUFFER_SIZE (256 * 1024)
+
+// Names per stat task, the unit a thief takes.
+#define SCAN_BATCH 256
+
+static const int SCAN_AUTO_WORKERS_MAX = 8;
+
+struct linux_dirent64 {
+    uint64_t d_ino;
+    int64_t d_off;
+    unsigned short d_reclen;
+    unsigned char d_type;
+    char d_name[];
+};
+
+typedef struct {
+    const char *path;   // As spelled in dirs_to_watch
+    size_t len;
+    int fd;
+    int refs;           // The reading task plus its queued batches; the last one closes fd
+} ScanDir;
+
+typedef struct {
+    ScanDir *dir;
+    int count;          // 0 = read the directory, otherwise stat `paths`
+    char *paths[SCAN_BATCH];
+} ScanTask;
+
+typedef struct {
+    pthread_mutex_t lock;
+    ScanTask **tasks;   // Ring: the owner takes the newest, thieves the oldest
+    int capacity;
+    int head;
+    int size;
+
+    // Results, owned by this worker until the merge
+    char **paths;
+    time_t *mtimes;
+    int count;
+    int result_capacity;
+
+    char *buffer;       // getdents64 records
+    unsigned long entries;
+    unsigned long stats;
+    unsigned long steals;
+} ScanWorker;
+
+typedef struct {
+    ScanWorker *workers;
+    int worker_count;
+    int pending;        // Tasks queued or running; 0 means the scan is done
+} Scan;
+
+typedef struct {
+    Scan *scan;
+    int self;
+} ScanThread;
+
+static uint64_t clock_us(void) {
+    struct timespec ts;
+    clock_gettime(CLOCK_MONOTONIC, &ts);
+    return (uint64_t)ts.tv_sec * 1000000 + (uint64_t)ts.tv_nsec / 1000;
+}
+
+static int deque_push(ScanWorker *worker, ScanTask *task) {
+    pthread_mutex_lock(&worker->lock);
+    if (worker->size == worker->capacity) {
+        int capacity = worker->capacity ? worker->capacity * 2 : 64;
+        ScanTask **tasks = malloc(sizeof(ScanTask *) * (size_t)capacity);
+        if (!tasks) {
+            pthread_mutex_unlock(&worker->lock);
+            return -1;
+        }
+        for (int k = 0; k < worker->size; ++k) {
+            tasks[k] = worker->tasks[(worker->head + k) % worker->capacity];
+        }
+        free(worker->tasks);
+        worker->tasks = tasks;
+        worker->capacity = capacity;
+        worker->head = 0;
+    }
+    worker->tasks[(worker->head + worker->size) % worker->capacity] = task;
+    worker->size++;
+    pthread_mutex_unlock(&worker->lock);
+    return 0;
+}
+
+static ScanTask *deque_pop(ScanWorker *worker) {
+    ScanTask *task = NULL;
+    pthread_mutex_lock(&worker->lock);
+    if (worker->size > 0) {
+        worker->size--;
+        task = worker->tasks[(worker->head + worker->size) % worker->capacity];
+    }
+    pthread_mutex_unlock(&worker->lock);
+    return task;
+}
+
+static ScanTask *deque_steal(ScanWorker *victim) {
+    ScanTask *task = NULL;
+    pthread_mutex_lock(&victim->lock);
+    if (victim->size > 0) {
+        task = victim->tasks[victim->head];
+        victim->head = (victim->head + 1) % victim->capacity;
+        victim->size--;
+    }
+    pthread_mutex_unlock(&victim->lock);
+    return task;
+}
+
+static void release_dir(ScanDir *dir) {
+    if (__atomic_sub_fetch(&dir->refs, 1, __ATOMIC_ACQ_REL) == 0 && dir->fd >= 0) {
+        close(dir->fd);
+    }
+}
+
+static void add_result(ScanWorker *worker, char *path, time_t mtime) {
+    if (worker->count == worker->result_capacity) {
+        int capacity = worker->result_capacity ? worker->result_capacity * 2 : 1024;
+        char **paths = realloc(worker->paths, sizeof(char *) * (size_t)capacity);
+        if (paths) {
+            worker->paths = paths;
+        }
+        time_t *mtimes = realloc(worker->mtimes, sizeof(time_t) * (size_t)capacity);
+        if (mtimes) {
+            worker->mtimes = mtimes;
+        }
+        if (!paths || !mtimes) {
+            free(path);
+            return;
+        }
+        worker->result_capacity = capacity;
+    }
+    worker->paths[worker->count] = path;
+    worker->mtimes[worker->count] = mtime;
+    worker->count++;
+}
+
+static void stat_batch(ScanWorker *worker, ScanTask *task) {
+    ScanDir *dir = task->dir;
+    for (int k = 0; k < task->count; ++k) {
+        struct stat st;
+        worker->stats++;
+        // Relative to the open directory: the kernel skips the path walk
+        if (fstatat(dir->fd, task->paths[k] + dir->len + 1, &st, AT_SYMLINK_NOFOLLOW) != 0 ||
+            !S_ISREG(st.st_mode)) {
+            free(task->paths[k]); // Gone since, or DT_UNKNOWN turned out not to be a file
+            continue;
+        }
+        add_result(worker, task->paths[k], st.st_mtime);
+    }
+}
+
+// Hands a full batch to the deque, where an idle worker can take it.
+static void submit_batch(Scan *scan, ScanWorker *worker, ScanTask *batch) {
+    __atomic_add_fetch(&batch->dir->refs, 1, __ATOMIC_RELAXED);
+    __atomic_add_fetch(&scan->pending, 1, __ATOMIC_RELAXED);
+    if (deque_push(worker, batch) != 0) {
+        __atomic_sub_fetch(&scan->pending, 1, __ATOMIC_RELAXED);
+        stat_batch(worker, batch);
+        release_dir(batch->dir);
+        free(batch);
+    }
+}
+
+static void read_directory(Scan *scan, ScanWorker *worker, ScanDir *dir) {
+    dir->fd = open(dir->path, O_RDONLY | O_DIRECTORY | O_CLOEXEC);
+    if (dir->fd < 0) {
+        return;
+    }
+
+    ScanTask *batch = NULL;
+    long n;
+    while ((n = sys_getdents64_asm(dir->fd, worker->buffer, DENTS_BUFFER_SIZE)) > 0) {
+        for (long offset = 0; offset < n;) {
+            struct linux_dirent64 *entry = (struct linux_dirent64 *)(worker->buffer + offset);
+            offset += entry->d_reclen;
+            worker->entries++;
+
+            // d_type rules out directories, links and the rest without a stat
+            if (entry->d_type != DT_REG && entry->d_type != DT_UNKNOWN) {
+                continue;
+            }
+            if (strcmp(entry->d_name, ".") == 0 || strcmp(entry->d_name, "..") == 0) {
+                continue;
+            }
+
+            size_t name_len = strlen(entry->d_name);
+            char *path = malloc(dir->len + name_len + 2);
+            if (!path) {
+                continue;
+            }
+            memcpy(path, dir->path, dir->len);
+            path[dir->len] = '/';
+            memcpy(path + dir->len + 1, entry->d_name, name_len + 1);
+
+            if (!batch) {
+                batch = malloc(sizeof(ScanTask));
+                if (!batch) {
+                    free(path);
+                    continue;
+                }
+                batch->dir = dir;
+                batch->count = 0;
+            }
+            batch->paths[batch->count++] = path;
+            if (batch->count == SCAN_BATCH) {
+                submit_batch(scan, worker, batch);
+                batch = NULL;
+            }
+        }
+    }
+
+    // The tail is cheaper to stat here than to queue
+    if (batch) {
+        stat_batch(worker, batch);
+        free(batch);
+    }
+}
+
+static ScanTask *find_task(Scan *scan, int self) {
+    ScanWorker *worker = &scan->workers[self];
+    ScanTask *task = deque_pop(worker);
+    for (int k = 1; !task && k < scan->worker_count; ++k) {
+        task = deque_steal(&scan->workers[(self + k) % scan->worker_count]);
+        if (task) {
+            worker->steals++;
+        }
+    }
+    return task;
+}
+
+static void run_worker(Scan *scan, int self) {
+    ScanWorker *worker = &scan->workers[self];
+    for (;;) {
+        ScanTask *task = find_task(scan, self);
+        if (!task) {
+            // Someone may still be reading a directory and about to queue batches
+            if (__atomic_load_n(&scan->pending, __ATOMIC_ACQUIRE) == 0) {
+                return;
+            }
+            sched_yield();
+            continue;
+        }
+
+        ScanDir *dir = task->dir;
+        if (task->count == 0) {
+            read_directory(scan, worker, dir);
+        } else {
+            stat_batch(worker, task);
+        }
+        free(task);
+        release_dir(dir);
+        __atomic_sub_fetch(&scan->pending, 1, __ATOMIC_ACQ_REL);
+    }
+}
+
+static void *scan_thread(void *arg) {
+    ScanThread *thread = arg;
+    run_worker(thread->scan, thread->self);
+    return NULL;
+}
+
+int watcher_scan_parallel(Watcher *watcher, int workers, ScanStats *stats) {
+    memset(stats, 0, sizeof(*stats));
+    if (watcher->dir_count == 0) {
+        return 0;
+    }
+    if (workers <= 0) {
+        long cpus = sysconf(_SC_NPROCESSORS_ONLN);
+        workers = cpus < 1 ? 1 : cpus > SCAN_AUTO_WORKERS_MAX ? SCAN_AUTO_WORKERS_MAX : (int)cpus;
+    }
+    uint64_t start = clock_us();
+
+    Scan scan = { NULL, 0, 0 };
+    ScanDir *dirs = calloc((size_t)watcher->dir_count, sizeof(ScanDir));
+    scan.workers = calloc((size_t)workers, sizeof(ScanWorker));
+    ScanThread *threads = calloc((size_t)workers, sizeof(ScanThread));
+    pthread_t *handles = calloc((size_t)workers, sizeof(pthread_t));
+    if (!dirs || !scan.workers || !threads || !handles) {
+        free(dirs);
+        free(scan.workers);
+        free(threads);
+        free(handles);
+        return -1;
+    }
+
+    for (int i = 0; i < workers; ++i) {
+        scan.workers[i].buffer = malloc(DENTS_BUFFER_SIZE);
+        if (!scan.workers[i].buffer) {
+            break;
+        }
+        pthread_mutex_init(&scan.workers[i].lock, NULL);
+        scan.worker_count++;
+    }
+    if (scan.worker_count == 0) {
+        free(dirs);
+        free(scan.workers);
+        free(threads);
+        free(handles);
+        return -1;
+    }
+
+    // One read task per directory, dealt round-robin
+    for (int i = 0; i < watcher->dir_count; ++i) {
+        dirs[i].path = watcher->dirs_to_watch[i];
+        dirs[i].len = strlen(dirs[i].path);
+        dirs[i].fd = -1;
+        dirs[i].refs = 1;
+        ScanTask *task = malloc(sizeof(ScanTask));
+        if (!task) {
+            continue;
+        }
+        task->dir = &dirs[i];
+        task->count = 0;
+        if (deque_push(&scan.workers[i % scan.worker_count], task) != 0) {
+            free(task);
+            continue;
+        }
+        scan.pending++;
+    }
+
+    // The calling thread is worker 0; a thread that fails to start just leaves its deque to thieves
+    int started = 1;
+    for (int i = 1; i < scan.worker_count; ++i) {
+        threads[i].scan = &scan;
+        threads[i].self = i;
+        if (pthread_create(&handles[i], NULL, scan_thread, &threads[i]) != 0) {
+            threads[i].scan = NULL;
+            continue;
+        }
+        started++;
+    }
+    run_worker(&scan, 0);
+    for (int i = 1; i < scan.worker_count; ++i) {
+        if (threads[i].scan) {
+            pthread_join(handles[i], NULL);
+        }
+    }
+
+    // One grow of the table per worker; the strings move over as they are
+    for (int i = 0; i < scan.worker_count; ++i) {
+        ScanWorker *worker = &scan.workers[i];
+        stats->files += watcher_add_files(watcher, worker->paths, worker->mtimes, worker->count);
+        stats->entries += worker->entries;
+        stats->stats += worker->stats;
+        stats->steals += worker->steals;
+        free(worker->paths);
+        free(worker->mtimes);
+        free(worker->tasks);
+        free(worker->buffer);
+        pthread_mutex_destroy(&worker->lock);
+    }
+    stats->workers = started;
+    stats->elapsed_us = clock_us() - start;
+
+    free(dirs);
+    free(scan.workers);
+    free(threads);
+    free(handles);
+    return 0;
+}
+
+#else
+
+int watcher_scan_parallel(Watcher *watcher, int workers, ScanStats *stats) {
+    (void)watcher; (void)workers;
+    memset(stats, 0, sizeof(*stats));
+    return -1;
+}
+
+#endif
@@ -0,0 +1,39 @@
+/*
+    Copyright © 2025 Mint teams
+    watcher_scan.h
+    The generic Node.js process watcher
+*/
+
+#ifndef WATCHER_SCAN_H
+#define WATCHER_SCAN_H
+
+#include <stdint.h>
+
+#include <watcher/watcher.h>
+
+/*
+    Parallel initial scan of the watched directories (Linux). Each worker
+    owns a deque of tasks: reading a directory with getdents64 into a
+    large buffer, or stat'ing a batch of the names it returned. A worker
+    with an empty deque steals the oldest task of another, so one huge
+    directory is still stat'ed by every thread. d_type settles which
+    entries are regular files; only those (and DT_UNKNOWN ones) cost an
+    fstatat(), relative to the open directory.
+*/
+typedef struct {
+    unsigned long entries;  // Directory entries read
+    unsigned long stats;    // fstatat() calls
+    unsigned long steals;
+    int files;              // Added to the table
+    int workers;
+    uint64_t elapsed_us;
+} ScanStats;
+
+/*
+    Scans every watched directory into the table with `workers` threads
+    (0 = one per CPU, up to 8). Returns -1 when unsupported here, so the
+    caller falls back to watcher_rescan_directories().
+*/
+int watcher_scan_parallel(Watcher *watcher, int workers, ScanStats *stats);
+
+#endif // WATCHER_SCAN_H
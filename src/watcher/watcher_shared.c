@@ -0,0 +1,339 @@
+/*
+    Copyright © 2025 Mint teams
+    watcher_shared.c
+    The generic Node.js process watcher
+*/
+
+#include <errno.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+
+#include <watcher/watcher_shared.h>
+#include <daemon/kavind.h>
+
+#if defined(__linux__)
+#include <fcntl.h>
+#include <limits.h>
+#include <poll.h>
+#include <unistd.h>
+#include <sys/socket.h>
+#include <sys/un.h>
+#include <sys/wait.h>
+
+#define SHARED_CONNECT_TRIES 50
+#define SHARED_CONNECT_WAIT_US 20000
+#define SHARED_SYNC_TIMEOUT_MS 2000
+
+typedef struct {
+    char *real;     // Absolute directory registered with kavind
+    char *prefix;   // The same directory as spelled in the watch table ("" = cwd)
+    int enumerate;  // Watched directory (1) or parent of an explicit file (0)
+} SharedRoot;
+
+struct SharedBackend {
+    int fd;
+    SharedRoot *roots;      // Index = registration id
+    int root_count;
+    int registered;
+    char in[KAVIND_LINE_MAX];
+    size_t in_len;
+};
+
+static int add_root(SharedBackend *backend, const char *dir, int enumerate) {
+    char real[PATH_MAX];
+    if (!realpath(*dir ? dir : ".", real) || strchr(real, '\n')) {
+        return 0;
+    }
+
+    for (int i = 0; i < backend->root_count; ++i) {
+        SharedRoot *root = &backend->roots[i];
+        if (strcmp(root->real, real) == 0 && strcmp(root->prefix, dir) == 0) {
+            root->enumerate |= enumerate;
+            return 0;
+        }
+    }
+
+    SharedRoot *roots = realloc(backend->roots, sizeof(SharedRoot) * (backend->root_count + 1));
+    if (!roots) {
+        return -1;
+    }
+    backend->roots = roots;
+    roots[backend->root_count].real = strdup(real);
+    roots[backend->root_count].prefix = strdup(dir);
+    roots[backend->root_count].enumerate = enumerate;
+    if (!roots[backend->root_count].real || !roots[backend->root_count].prefix) {
+        free(roots[backend->root_count].real);
+        free(roots[backend->root_count].prefix);
+        return -1;
+    }
+    backend->root_count++;
+    return 0;
+}
+
+static int connect_daemon(const char *path) {
+    struct sockaddr_un addr;
+    memset(&addr, 0, sizeof(addr));
+    addr.sun_family = AF_UNIX;
+    snprintf(addr.sun_path, sizeof(addr.sun_path), "%s", path);
+
+    int fd = socket(AF_UNIX, SOCK_STREAM | SOCK_CLOEXEC, 0);
+    if (fd < 0) {
+        return -1;
+    }
+    if (connect(fd, (struct sockaddr *)&addr, sizeof(addr)) != 0) {
+        int saved = errno;
+        close(fd);
+        errno = saved;
+        return -1;
+    }
+    if (!kavind_peer_is_self(fd)) {
+        close(fd);
+        errno = EACCES;
+        return -1;
+    }
+    return fd;
+}
+
+// Starts "kavin --daemon" detached from our session and process tree.
+static void spawn_daemon(void) {
+    char self[PATH_MAX];
+    ssize_t len = readlink("/proc/self/exe", self, sizeof(self) - 1);
+    if (len <= 0) {
+        return;
+    }
+    self[len] = '\0';
+
+    pid_t pid = fork();
+    if (pid == 0) {
+        // Double fork: the daemon is reparented and we reap the middle child at once
+        if (fork() == 0) {
+            setsid();
+            int null_fd = open("/dev/null", O_RDWR);
+            if (null_fd >= 0) {
+                dup2(null_fd, STDIN_FILENO);
+                dup2(null_fd, STDOUT_FILENO);
+                dup2(null_fd, STDERR_FILENO);
+            }
+            execl(self, self, "--daemon", (char *)NULL);
+        }
+        _exit(0);
+    }
+    if (pid > 0) {
+        waitpid(pid, NULL, 0);
+    }
+}
+
+static int send_all(int fd, const char *data, size_t len) {
+    while (len > 0) {
+        ssize_t n = send(fd, data, len, MSG_NOSIGNAL);
+        if (n <= 0) {
+            return -1;
+        }
+        data += n;
+        len -= (size_t)n;
+    }
+    return 0;
+}
+
+// Reads one line, waiting up to the sync deadline. Returns -1 on EOF or timeout.
+static int read_line(SharedBackend *backend, char *line, size_t size, int timeout_ms) {
+    for (;;) {
+        char *newline = memchr(backend->in, '\n', backend->in_len);
+        if (newline) {
+            size_t len = (size_t)(newline - backend->in);
+            snprintf(line, size, "%.*s", (int)len, backend->in);
+            backend->in_len -= len + 1;
+            memmove(backend->in, newline + 1, backend->in_len);
+            return 0;
+        }
+
+        struct pollfd pfd = { backend->fd, POLLIN, 0 };
+        int ready = poll(&pfd, 1, timeout_ms);
+        if (ready < 0 && errno == EINTR) {
+            continue; // SIGCHLD from the daemon's launcher
+        }
+        if (ready <= 0) {
+            return -1;
+        }
+        ssize_t n = recv(backend->fd, backend->in + backend->in_len, sizeof(backend->in) - backend->in_len, 0);
+        if (n <= 0) {
+            return -1;
+        }
+        backend->in_len += (size_t)n;
+    }
+}
+
+SharedBackend *shared_backend_open(char **files, int file_count, char **dirs, int dir_count) {
+    char path[PATH_MAX];
+    if (kavind_socket_path(path, sizeof(path)) != 0) {
+        errno = ENAMETOOLONG;
+        return NULL;
+    }
+
+    SharedBackend *backend = calloc(1, sizeof(SharedBackend));
+    if (!backend) {
+        return NULL;
+    }
+    backend->fd = connect_daemon(path);
+    if (backend->fd < 0 && errno != EACCES) { // Another user's socket stays theirs: our daemon could not bind it
+        spawn_daemon();
+        for (int i = 0; i < SHARED_CONNECT_TRIES && backend->fd < 0; ++i) {
+            usleep(SHARED_CONNECT_WAIT_US);
+            backend->fd = connect_daemon(path);
+        }
+    }
+    if (backend->fd < 0) {
+        int saved = errno;
+        free(backend);
+        errno = saved;
+        return NULL;
+    }
+
+    int failed = 0;
+    for (int i = 0; i < dir_count && !failed; ++i) {
+        failed = add_root(backend, dirs[i], 1) != 0;
+    }
+    for (int i = 0; i < file_count && !failed; ++i) {
+        char parent[PATH_MAX] = "";
+        const char *slash = strrchr(files[i], '/');
+        if (slash == files[i]) {
+            strcpy(parent, "/");
+        } else if (slash) {
+            size_t len = (size_t)(slash - files[i]);
+            if (len >= sizeof(parent)) {
+                continue;
+            }
+            memcpy(parent, files[i], len);
+            parent[len] = '\0';
+        }
+        failed = add_root(backend, parent, 0) != 0;
+    }
+
+    char line[KAVIND_LINE_MAX];
+    for (int i = 0; i < backend->root_count && !failed; ++i) {
+        int n = snprintf(line, sizeof(line), "WATCH %d %s\n", i, backend->roots[i].real);
+        failed = n >= (int)sizeof(line) || send_all(backend->fd, line, (size_t)n) != 0;
+    }
+    failed = failed || send_all(backend->fd, "SYNC\n", 5) != 0;
+
+    // ERR lines for refused directories come before SYNCED
+    while (!failed) {
+        if (read_line(backend, line, sizeof(line), SHARED_SYNC_TIMEOUT_MS) != 0) {
+            failed = 1;
+            errno = ETIMEDOUT;
+        } else if (strncmp(line, "SYNCED ", 7) == 0) {
+            backend->registered = atoi(line + 7);
+            break;
+        } else if (strncmp(line, "ERR ", 4) == 0) {
+            int id = atoi(line + 4);
+            if (id >= 0 && id < backend->root_count) {
+                fprintf(stderr, "[Watcher warning] kavind could not watch %s\n", backend->roots[id].real);
+            }
+        }
+    }
+
+    if (failed || backend->registered == 0) {
+        int saved = failed ? errno : ENOENT;
+        shared_backend_close(backend);
+        errno = saved;
+        return NULL;
+    }
+    fcntl(backend->fd, F_SETFL, fcntl(backend->fd, F_GETFL) | O_NONBLOCK);
+    return backend;
+}
+
+void shared_backend_close(SharedBackend *backend) {
+    if (!backend) {
+        return;
+    }
+    for (int i = 0; i < backend->root_count; ++i) {
+        free(backend->roots[i].real);
+        free(backend->roots[i].prefix);
+    }
+    free(backend->roots);
+    if (backend->fd >= 0) {
+        close(backend->fd); // kavind drops our registrations
+    }
+    free(backend);
+}
+
+int shared_backend_dirs(const SharedBackend *backend) {
+    return backend->registered;
+}
+
+static int deliver(SharedBackend *backend, const char *message, WatchEventFn on_event, void *ctx) {
+    char *name;
+    long id = strtol(message, &name, 10);
+    if (*name != ' ' || id < 0 || id >= backend->root_count) {
+        return 0;
+    }
+    name++;
+
+    const SharedRoot *root = &backend->roots[id];
+    char path[PATH_MAX];
+    if (root->prefix[0] == '\0') {
+        snprintf(path, sizeof(path), "%s", name);
+    } else if (strcmp(root->prefix, "/") == 0) {
+        snprintf(path, sizeof(path), "/%s", name);
+    } else {
+        snprintf(path, sizeof(path), "%s/%s", root->prefix, name);
+    }
+    return on_event(ctx, path, root->enumerate);
+}
+
+int shared_backend_collect(SharedBackend *backend, WatchEventFn on_event, void *ctx) {
+    int hits = 0;
+    int overflow = 0;
+
+    for (;;) {
+        ssize_t n = recv(backend->fd, backend->in + backend->in_len, sizeof(backend->in) - backend->in_len, 0);
+        if (n == 0 || (n < 0 && errno != EAGAIN && errno != EINTR)) {
+            return -2;
+        }
+        if (n > 0) {
+            backend->in_len += (size_t)n;
+        }
+
+        size_t start = 0;
+        char *newline;
+        while ((newline = memchr(backend->in + start, '\n', backend->in_len - start)) != NULL) {
+            *newline = '\0';
+            const char *message = backend->in + start;
+            if (strncmp(message, "EVENT ", 6) == 0) {
+                hits += deliver(backend, message + 6, on_event, ctx);
+            } else if (strcmp(message, "OVERFLOW") == 0) {
+                overflow = 1;
+            }
+            start = (size_t)(newline - backend->in) + 1;
+        }
+        backend->in_len -= start;
+        memmove(backend->in, backend->in + start, backend->in_len);
+
+        if (n < 0) {
+            break; // EAGAIN: drained
+        }
+    }
+    return overflow ? -1 : hits;
+}
+
+#else // kavind is Linux only
+
+SharedBackend *shared_backend_open(char **files, int file_count, char **dirs, int dir_count) {
+    (void)files; (void)file_count; (void)dirs; (void)dir_count;
+    errno = ENOSYS;
+    return NULL;
+}
+
+void shared_backend_close(SharedBackend *backend) { (void)backend; }
+
+int shared_backend_collect(SharedBackend *backend, WatchEventFn on_event, void *ctx) {
+    (void)backend; (void)on_event; (void)ctx;
+    return 0;
+}
+
+int shared_backend_dirs(const SharedBackend *backend) {
+    (void)backend;
+    return 0;
+}
+#endif
@@ -0,0 +1,33 @@
+/*
+    Copyright © 2025 Mint teams
+    watcher_shared.h
+    The generic Node.js process watcher
+*/
+
+#ifndef WATCHER_SHARED_H
+#define WATCHER_SHARED_H
+
+#include <watcher/watcher.h>
+
+/*
+    Client side of kavind (--backend shared). The watched directories,
+    and the parents of explicitly listed files, are registered with the
+    per-user daemon, which starts on demand. Events come back over the
+    socket instead of from a watch of our own.
+*/
+typedef struct SharedBackend SharedBackend;
+
+// Returns NULL (with errno set) when kavind can't be reached or started.
+SharedBackend *shared_backend_open(char **files, int file_count, char **dirs, int dir_count);
+void shared_backend_close(SharedBackend *backend);
+
+/*
+    Drains pending events without blocking and calls `on_event` for each
+    one. Returns the number of hits, -1 when kavind dropped events and
+    the caller must rescan, or -2 once kavind has gone away.
+*/
+int shared_backend_collect(SharedBackend *backend, WatchEventFn on_event, void *ctx);
+
+int shared_backend_dirs(const SharedBackend *backend);
+
+#endif // WATCHER_SHARED_H
@@ -0,0 +1,265 @@
+/*
+    Copyright © 2025 Mint teams
+    watcher_thread.c
+    The generic Node.js process watcher
+*/
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+
+#include <watcher/watcher_thread.h>
+
+#ifdef _WIN32
+
+WatchThread *watch_thread_start(Watcher *watcher) {
+    (void)watcher;
+    return NULL;
+}
+
+void watch_thread_stop(WatchThread *thread) { (void)thread; }
+
+int watch_thread_take(WatchThread *thread, ChangeBatch *batch) {
+    (void)thread;
+    memset(batch, 0, sizeof(*batch));
+    return 0;
+}
+
+void watch_thread_discard(WatchThread *thread) { (void)thread; }
+
+int watch_thread_holding(const WatchThread *thread) {
+    (void)thread;
+    return 0;
+}
+
+void watch_thread_wait(WatchThread *thread, int ms) {
+    (void)thread;
+    Sleep(ms);
+}
+
+void watch_thread_lock(WatchThread *thread) { (void)thread; }
+void watch_thread_unlock(WatchThread *thread) { (void)thread; }
+void watch_thread_print_stats(const WatchThread *thread) { (void)thread; }
+
+#else // POSIX implementation
+#include <pthread.h>
+#include <signal.h>
+#include <poll.h>
+#include <fcntl.h>
+#include <unistd.h>
+
+#include <watcher/watcher_actions.h>
+#include <watcher/watcher_git.h>
+#include <replay/event_log.h>
+
+// Power of two. A batch is a whole change set, so even a flood of saves fills few slots.
+#define WATCH_RING_SIZE 64
+
+struct WatchThread {
+    Watcher *watcher;
+    pthread_t thread;
+    pthread_mutex_t table_lock;     // Held by the thread for a pass, by the supervisor to read the table
+
+    // Written by the thread only (tail) / the supervisor only (head).
+    ChangeBatch ring[WATCH_RING_SIZE];
+    unsigned int head;
+    unsigned int tail;
+    ChangeBatch pending;            // Thread side: merged batches waiting for a free slot
+
+    int wake_pipe[2];               // Thread -> supervisor: a batch was published
+    int stop_pipe[2];               // Supervisor -> thread: leave the loop
+    int holding;
+
+    // Stats, read without the lock: a torn read only skews a printout.
+    unsigned long passes;
+    unsigned long published;
+    unsigned long merged;           // Published while the ring was full
+    uint64_t slowest_pass_ms;
+    uint64_t total_pass_ms;
+};
+
+// Thread side: moves the pending batch into the ring if there is room.
+static int push_pending(WatchThread *thread) {
+    unsigned int tail = thread->tail;
+    unsigned int head = __atomic_load_n(&thread->head, __ATOMIC_ACQUIRE);
+    if (tail - head == WATCH_RING_SIZE) {
+        return 0;
+    }
+    thread->ring[tail & (WATCH_RING_SIZE - 1)] = thread->pending;
+    memset(&thread->pending, 0, sizeof(thread->pending));
+    __atomic_store_n(&thread->tail, tail + 1, __ATOMIC_RELEASE); // The slot is complete before it is visible
+    return 1;
+}
+
+static void publish(WatchThread *thread, ChangeBatch *batch) {
+    int want_lines = thread->watcher->options->soft_reload_ms > 0;
+    if (thread->pending.changed > 0) {
+        thread->merged++;
+    }
+    change_batch_merge(&thread->pending, batch, want_lines);
+    if (push_pending(thread)) {
+        thread->published++;
+        char byte = 1;
+        ssize_t ignored = write(thread->wake_pipe[1], &byte, 1); // Full pipe: a wakeup is pending anyway
+        (void)ignored;
+    }
+}
+
+static void *watch_loop(void *arg) {
+    WatchThread *thread = arg;
+    Watcher *watcher = thread->watcher;
+    int want_lines = watcher->options->soft_reload_ms > 0;
+
+    for (;;) {
+        uint64_t start = watcher_clock_ms();
+        pthread_mutex_lock(&thread->table_lock);
+        ChangeBatch batch = { 0 };
+        if (check_for_file_changes(watcher)) {
+            batch.changed = 1;
+            if (want_lines) {
+                batch.files = watcher_reload_lines(watcher, &batch.lines, &batch.len);
+            }
+        }
+        int holding = watcher->git && git_guard_holding(watcher->git);
+        int sleep_ms = watcher_watch_sleep_ms(watcher);
+        event_log_flush(watcher->record);
+        pthread_mutex_unlock(&thread->table_lock);
+
+        __atomic_store_n(&thread->holding, holding, __ATOMIC_RELEASE);
+        uint64_t elapsed = watcher_clock_ms() - start;
+        thread->passes++;
+        thread->total_pass_ms += elapsed;
+        if (elapsed > thread->slowest_pass_ms) {
+            thread->slowest_pass_ms = elapsed;
+        }
+
+        if (batch.changed) {
+            publish(thread, &batch);
+        } else if (thread->pending.changed > 0 && push_pending(thread)) {
+            thread->published++;
+            char byte = 1;
+            ssize_t ignored = write(thread->wake_pipe[1], &byte, 1);
+            (void)ignored;
+        }
+
+        struct pollfd stop = { thread->stop_pipe[0], POLLIN, 0 };
+        if (poll(&stop, 1, sleep_ms) > 0) {
+            break;
+        }
+    }
+    return NULL;
+}
+
+static int open_pipe(int fds[2]) {
+    if (pipe(fds) != 0) {
+        return -1;
+    }
+    for (int i = 0; i < 2; ++i) {
+        fcntl(fds[i], F_SETFD, FD_CLOEXEC);
+        fcntl(fds[i], F_SETFL, fcntl(fds[i], F_GETFL) | O_NONBLOCK);
+    }
+    return 0;
+}
+
+WatchThread *watch_thread_start(Watcher *watcher) {
+    WatchThread *thread = calloc(1, sizeof(WatchThread));
+    if (!thread) {
+        return NULL;
+    }
+    thread->watcher = watcher;
+    if (open_pipe(thread->wake_pipe) != 0) {
+        free(thread);
+        return NULL;
+    }
+    if (open_pipe(thread->stop_pipe) != 0) {
+        close(thread->wake_pipe[0]);
+        close(thread->wake_pipe[1]);
+        free(thread);
+        return NULL;
+    }
+    pthread_mutex_init(&thread->table_lock, NULL);
+
+    // Signals stay with the supervisor: SIGCHLD has to cut its sleep short, not ours
+    sigset_t all, old;
+    sigfillset(&all);
+    pthread_sigmask(SIG_SETMASK, &all, &old);
+    int started = pthread_create(&thread->thread, NULL, watch_loop, thread) == 0;
+    pthread_sigmask(SIG_SETMASK, &old, NULL);
+    if (!started) {
+        pthread_mutex_destroy(&thread->table_lock);
+        for (int i = 0; i < 2; ++i) {
+            close(thread->wake_pipe[i]);
+            close(thread->stop_pipe[i]);
+        }
+        free(thread);
+        return NULL;
+    }
+    return thread;
+}
+
+void watch_thread_stop(WatchThread *thread) {
+    if (!thread) {
+        return;
+    }
+    char byte = 1;
+    ssize_t ignored = write(thread->stop_pipe[1], &byte, 1);
+    (void)ignored;
+    pthread_join(thread->thread, NULL);
+
+    watch_thread_discard(thread);
+    free(thread->pending.lines);
+    pthread_mutex_destroy(&thread->table_lock);
+    for (int i = 0; i < 2; ++i) {
+        close(thread->wake_pipe[i]);
+        close(thread->stop_pipe[i]);
+    }
+    free(thread);
+}
+
+int watch_thread_take(WatchThread *thread, ChangeBatch *batch) {
+    memset(batch, 0, sizeof(*batch));
+    char drain[64];
+    while (read(thread->wake_pipe[0], drain, sizeof(drain)) > 0) {
+    }
+
+    // Drain after reading the pipe: a batch published in between wakes the next wait
+    int want_lines = thread->watcher->options->soft_reload_ms > 0;
+    unsigned int head = thread->head;
+    unsigned int tail = __atomic_load_n(&thread->tail, __ATOMIC_ACQUIRE);
+    for (; head != tail; ++head) {
+        change_batch_merge(batch, &thread->ring[head & (WATCH_RING_SIZE - 1)], want_lines);
+    }
+    __atomic_store_n(&thread->head, head, __ATOMIC_RELEASE); // The slots are free once read
+    return batch->changed > 0;
+}
+
+void watch_thread_discard(WatchThread *thread) {
+    ChangeBatch batch;
+    watch_thread_take(thread, &batch);
+    free(batch.lines);
+}
+
+int watch_thread_holding(const WatchThread *thread) {
+    return __atomic_load_n(&thread->holding, __ATOMIC_ACQUIRE);
+}
+
+void watch_thread_wait(WatchThread *thread, int ms) {
+    struct pollfd wake = { thread->wake_pipe[0], POLLIN, 0 };
+    poll(&wake, 1, ms); // EINTR on SIGCHLD is a wakeup too
+}
+
+void watch_thread_lock(WatchThread *thread) {
+    pthread_mutex_lock(&thread->table_lock);
+}
+
+void watch_thread_unlock(WatchThread *thread) {
+    pthread_mutex_unlock(&thread->table_lock);
+}
+
+void watch_thread_print_stats(const WatchThread *thread) {
+    printf("[Watcher stats] watch thread: %lu passes, avg %.1f ms, slowest %llu ms, %lu change sets published (%lu merged while the queue was full)\n",
+           thread->passes, thread->passes ? (double)thread->total_pass_ms / thread->passes : 0.0,
+           (unsigned long long)thread->slowest_pass_ms, thread->published, thread->merged);
+}
+
+#endif
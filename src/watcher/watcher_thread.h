@@ -0,0 +1,56 @@
+/*
+    Copyright © 2025 Mint teams
+    watcher_thread.h
+    The generic Node.js process watcher
+*/
+
+#ifndef WATCHER_THREAD_H
+#define WATCHER_THREAD_H
+
+#include <stddef.h>
+#include <stdint.h>
+
+#include <watcher/watcher.h>
+
+/*
+    Watch thread (--watch-thread on). Stats, rescans, event backends and
+    git holds run on a thread of their own, which owns the watch table.
+    Each change set it finds is published to the supervisor (the thread
+    calling watcher_run) through a single-producer single-consumer ring,
+    and a byte on a pipe wakes the supervisor up.
+
+    The supervisor never waits for a pass: a dead child or a SIGKILL
+    deadline is seen within one --poll-interval however long a scan of
+    a slow file system takes. When the ring is full the thread keeps
+    merging into one pending batch, so nothing is dropped and neither
+    side blocks.
+
+    POSIX only; NULL (watch on the supervisor's own ticks) elsewhere.
+*/
+typedef struct WatchThread WatchThread;
+
+WatchThread *watch_thread_start(Watcher *watcher);
+void watch_thread_stop(WatchThread *thread); // Joins; the table is the caller's again
+
+// Takes every batch published so far, merged into one. Returns 1 when there was one.
+int watch_thread_take(WatchThread *thread, ChangeBatch *batch);
+
+// Frees what is queued: the process about to start sees all of it on disk.
+void watch_thread_discard(WatchThread *thread);
+
+// A git operation held the tree at the end of the last pass.
+int watch_thread_holding(const WatchThread *thread);
+
+/*
+    Sleeps up to `ms`, less when a batch is published or a signal
+    arrives. The supervisor's tick sleep.
+*/
+void watch_thread_wait(WatchThread *thread, int ms);
+
+// Keeps the thread off the table, for reading it from the supervisor (stats).
+void watch_thread_lock(WatchThread *thread);
+void watch_thread_unlock(WatchThread *thread);
+
+void watch_thread_print_stats(const WatchThread *thread);
+
+#endif // WATCHER_THREAD_H